@@ -0,0 +1,41 @@
+/////////////////////////////////////////////////////////////////////
+// Filename:     BinaryDataHelpers.h
+// Description:  helpers for the binary input formats converters:
+//               byte order conversion of the read data (the files are
+//               read into memory with Platform::ReadWholeFile)
+//
+// Created:      19.10.26
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+
+// returns true if the current machine stores numbers in the little endian byte order
+inline bool IsLittleEndianHost()
+{
+	const uint16_t value = 1;
+	uint8_t firstByte = 0;
+
+	memcpy(&firstByte, &value, 1);
+	return firstByte == 1;
+}
+
+
+// reverse the order of bytes in each of the elements of the array
+inline void ByteSwapArray(void* pData, const size_t elemSize, const size_t elemsCount)
+{
+	uint8_t* pBytes = static_cast<uint8_t*>(pData);
+
+	for (size_t i = 0; i < elemsCount; i++, pBytes += elemSize)
+	{
+		for (size_t lo = 0, hi = elemSize - 1; lo < hi; lo++, hi--)
+		{
+			const uint8_t tmp = pBytes[lo];
+			pBytes[lo] = pBytes[hi];
+			pBytes[hi] = tmp;
+		}
+	}
+}
+
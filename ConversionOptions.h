@@ -0,0 +1,80 @@
+/////////////////////////////////////////////////////////////////////
+// Filename:     ConversionOptions.h
+// Description:  options of the model conversion process; the structure
+//               is plain so it can be passed through the DLL's interface
+//
+// Created:      19.10.26
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+// a layout of the vertex buffers in the binary vertex buffers file
+enum VERTEX_LAYOUT
+{
+	VERTEX_LAYOUT_NONE = 0,                     // don't write the vertex buffers file
+	VERTEX_LAYOUT_INTERLEAVED = 1,              // a single stream with all the attributes of the vertex
+	VERTEX_LAYOUT_SOA = 2,                      // a separate stream for each attribute
+	VERTEX_LAYOUT_POSITION_STREAM = 3,          // a positions stream + a stream with all the other attributes interleaved
+};
+
+// what the validation stage does with faces which have invalid indices and with non-finite values
+enum VALIDATION_ACTION
+{
+	VALIDATION_ACTION_KEEP = 0,                 // only report them
+	VALIDATION_ACTION_CLAMP = 1,                // clamp indices into the valid range, replace NaN with 0 and Inf with +-FLT_MAX
+	VALIDATION_ACTION_DROP = 2,                 // remove faces with invalid indices or non-finite attributes
+};
+
+// a way of the spatial partitioning of the mesh into tiles
+enum TILING_MODE
+{
+	TILING_MODE_NONE = 0,                       // don't write the tiles files
+	TILING_MODE_GRID = 1,                       // a uniform grid over the mesh's bounding box
+	TILING_MODE_OCTREE = 2,                     // an octree over the mesh's bounding box
+};
+
+
+struct ConversionOptions
+{
+	// VALIDATION
+	bool  validateMesh = true;                  // check indices against the attributes counts and attributes for NaN/Inf
+	VALIDATION_ACTION invalidDataAction = VALIDATION_ACTION_KEEP;
+	unsigned int  maxReportedProblems = 8;      // how many invalid faces/values are printed into the log
+
+	// MESH CLEANUP
+	bool  weldVertices = true;                  // merge vertices which have (almost) the same position
+	float weldTolerance = 0.0f;                 // max distance between merged vertices (0 -- merge only equal positions)
+	bool  removeDegenerateTriangles = true;     // remove triangles which have repeated vertices or zero area
+	float degenerateAreaTolerance = 0.0f;       // triangles with area <= this value are degenerate
+	bool  removeDuplicateTriangles = true;      // remove triangles which use the same 3 vertices as some previous triangle
+
+	// OPTIONAL SECTIONS
+	bool  computeAdjacency = false;             // write triangles with adjacency (6 indices per triangle)
+	bool  computeEdges = false;                 // write unique edges with their faces (for silhouette detection)
+
+	// OUTPUT FORMAT
+	bool  allow16BitIndices = true;             // write 16-bit indices (or 16-bit indices + base vertex per submesh) when it is possible
+
+	// VERTEX LAYOUT (of the binary vertex buffers file "<output file>.vbuf")
+	VERTEX_LAYOUT vertexLayout = VERTEX_LAYOUT_NONE;
+	unsigned int  vertexAttributeAlignment = 4; // offsets of attributes and strides of streams are aligned to this value (a power of 2)
+	unsigned int  vertexStride = 0;             // a stride of the interleaved stream (0 -- the aligned size of its attributes)
+
+	// SPATIAL TILING (of the files "<output file>.tiles" and "<output file>.tiledata")
+	TILING_MODE   tilingMode = TILING_MODE_NONE;
+	unsigned int  tileGridCells[3] = { 8, 1, 8 };   // grid: the number of cells along x, y, z
+	unsigned int  tileMaxTriangles = 65536;     // octree: a node is split while it has more triangles than this
+	unsigned int  tileMaxDepth = 8;             // octree: the max depth of nodes
+
+	// INSTANCING (of the files "<output file>.instances" and "<output file>.instdata")
+	bool  detectInstances = false;              // find congruent copies of groups/objects and write each unique one once
+	float instanceTolerance = 0.0001f;          // max distance between matched vertices (relative to the size of the group/object)
+
+	// AMBIENT OCCLUSION (a per-vertex attribute which is baked by casting rays against the mesh itself)
+	bool  bakeAmbientOcclusion = false;         // write a value per vertex into the output file (and an attribute into the vertex buffers)
+	unsigned int  ambientOcclusionRaysCount = 64;   // hemisphere rays per vertex (is rounded up to a multiple of 4)
+	float ambientOcclusionMaxDistance = 0.0f;   // farther faces don't occlude (0 -- a quarter of the mesh bounding box diagonal)
+
+	// COMPRESSION
+	bool  compressStreams = false;              // write compressed vertex/index streams into "<output file>.mcmp"
+};
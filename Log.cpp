@@ -4,9 +4,10 @@
 ///////////////////////////////////////////////////////////////////////////////
 #include "Log.h"
 
+#include <cstdarg>
+
 
 Log* Log::m_instance = nullptr;
-HANDLE Log::handle = GetStdHandle(STD_OUTPUT_HANDLE);
 FILE* Log::m_file = nullptr;
 
 
@@ -46,15 +47,17 @@ Log* Log::Get() { return m_instance; }
 // make and open a logger text file
 void Log::m_init(void)
 {
-	if (fopen_s(&m_file, "log_model_converter.txt", "w") == 0)
+	m_file = Platform::OpenFile("log_model_converter.txt", "w");
+
+	if (m_file)
 	{
 		printf("Log::m_init(): the log file is created successfully\n");
 
 		char time[9];
 		char date[9];
 
-		_strtime_s(time, 9);
-		_strdate_s(date, 9);
+		Platform::GetTimeString(time, 9);
+		Platform::GetDateString(date, 9);
 
 		fprintf(m_file, "%s : %s| the log file is created\n", time, date);
 		fprintf(m_file, "-------------------------------------------\n\n");
@@ -72,8 +75,8 @@ void Log::m_close(void)
 	char time[9];
 	char date[9];
 
-	_strtime_s(time, 9);
-	_strdate_s(date, 9);
+	Platform::GetTimeString(time, 9);
+	Platform::GetDateString(date, 9);
 
 	fprintf(m_file, "\n-------------------------------------------\n");
 	fprintf(m_file, "%s : %s| the end of the log file\n", time, date);
@@ -81,25 +84,29 @@ void Log::m_close(void)
 
 
 // prints a usual message
-void Log::Print(char* message, ...)
+void Log::Print(const char* message, ...)
 {
 	va_list args;
+	va_list argsCopy;
 	int len = 0;
 	char* buffer = nullptr;
 
 	va_start(args, message);
+	va_copy(argsCopy, args);
+
+	len = vsnprintf(nullptr, 0, message, argsCopy) + 1;	// +1 together with '\0'
+	va_end(argsCopy);
 
-	len = _vscprintf(message, args) + 1;	// +1 together with '\0'
 	try
 	{
 		buffer = new char[len];
 
-		vsprintf_s(buffer, len, message, args);
+		vsnprintf(buffer, len, message, args);
 
 
-		SetConsoleTextAttribute(Log::handle, 0x000A);
+		Platform::SetConsoleColor(Platform::CONSOLE_COLOR_GREEN);
 		Log::m_print("", buffer);
-		SetConsoleTextAttribute(Log::handle, 0x0007);
+		Platform::SetConsoleColor(Platform::CONSOLE_COLOR_DEFAULT);
 	}
 	catch (std::bad_alloc & e)
 	{
@@ -144,17 +151,38 @@ void Log::Debug(const char* funcName, int codeLine, const char* message)
 
 
 
+void Log::Error(const char* funcName, int codeLine, const std::string & message)
+{
+	Log::Error(funcName, codeLine, message.c_str());
+}
+
+// prints an error message with the function name and the code line (for Log::Error(LOG_MACRO, "..."))
+void Log::Error(const char* funcName, int codeLine, const char* message)
+{
+	std::stringstream ss;
+	ss << funcName << "() (line: " << codeLine << "): " << message;
+
+	Platform::SetConsoleColor(Platform::CONSOLE_COLOR_RED);
+	m_print("ERROR: ", ss.str().c_str());
+	Platform::SetConsoleColor(Platform::CONSOLE_COLOR_DEFAULT);
+
+	return;
+}
+
 // prints an error message
-void Log::Error(char* message, ...)
+void Log::Error(const char* message, ...)
 {
 	va_list args;
+	va_list argsCopy;
 	int len = 0;
 	char* buffer = nullptr;
-	SetConsoleTextAttribute(Log::handle, 0x0004);  // set console text color to red
+	Platform::SetConsoleColor(Platform::CONSOLE_COLOR_RED);  // set console text color to red
 
 	va_start(args, message);
+	va_copy(argsCopy, args);
 
-	len = _vscprintf(message, args) + 1;	// +1 together with '\0'
+	len = vsnprintf(nullptr, 0, message, argsCopy) + 1;	// +1 together with '\0'
+	va_end(argsCopy);
 
 	// try to allocate memory for the symbols buffer
 	try
@@ -163,18 +191,19 @@ void Log::Error(char* message, ...)
 	}
 	catch (std::bad_alloc & e)
 	{
-		printf("Log::Error(char* message, ...): ERROR: %s", e.what());
-		printf("Log::Error(char* message, ...): can't allocate memory for the buffer");
+		printf("Log::Error(const char* message, ...): ERROR: %s", e.what());
+		printf("Log::Error(const char* message, ...): can't allocate memory for the buffer");
+		Platform::SetConsoleColor(Platform::CONSOLE_COLOR_DEFAULT);
 		va_end(args);
 		return;
 	}
 
 	// fill in the buffer with data
-	vsprintf_s(buffer, len, message, args);
+	vsnprintf(buffer, len, message, args);
 
 	// print the error message into the console and write it into the log file
 	Log::m_print("ERROR: ", buffer);
-	SetConsoleTextAttribute(Log::handle, 0x0007);
+	Platform::SetConsoleColor(Platform::CONSOLE_COLOR_DEFAULT);
 
 	// free memory
 	delete[] buffer;
@@ -189,16 +218,16 @@ void Log::Error(char* message, ...)
 
 
 // a helper for printing messages into the command prompt and into the logger text file
-void Log::m_print(char* levtext, const char* text)
+void Log::m_print(const char* levtext, const char* text)
 {
 	clock_t cl = clock();
 	char time[9];
 
-	_strtime_s(time, 9);
-	printf("%s::%d|\t%s%s\n", time, cl, levtext, text);
+	Platform::GetTimeString(time, 9);
+	printf("%s::%ld|\t%s%s\n", time, (long)cl, levtext, text);
 
 	if (m_file)
 	{
-		fprintf(m_file, "%s::%d|\t%s %s\n", time, cl, levtext, text);
+		fprintf(m_file, "%s::%ld|\t%s %s\n", time, (long)cl, levtext, text);
 	}
 }
\ No newline at end of file
@@ -4,8 +4,7 @@
 ///////////////////////////////////////////////////////////////////////////////
 #pragma once
 
-#define WIN32_LEAN_AND_MEAN
-#include <windows.h>
+#include "Platform.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <ctime>
@@ -27,14 +26,15 @@ public:
 	static Log* Get(); // to get a static pointer to this class instance
 
 	
-	static void Print(char* message, ...); // print a usual message
+	static void Print(const char* message, ...); // print a usual message
 	static void Debug(const char*, int, const std::string & message);
 	static void Debug(const char*, int, const char* message); // pring a debug message
-	static void Error(char* message, ...); // print a message about some error
+	static void Error(const char*, int, const std::string & message);
+	static void Error(const char*, int, const char* message); // print a message about some error (with the function name and the line)
+	static void Error(const char* message, ...); // print a message about some error
 	//static void Error(COMException* exception, bool showMessageBox = false);
 	//static void Error(COMException& exception, bool showMessageBox = false);
 
-	static HANDLE handle;  // we need it for changing the text colour in the command prompt
 	static FILE* m_file;   // a pointer to the logger file handler
 
 private:
@@ -42,7 +42,7 @@ private:
 
 	void m_init();  // make and open a logger text file
 	void m_close(); // print message about closing of the logger file
-	static void m_print(char* levtext, const char* text);  // a helper for printing messages into the command prompt and into the logger text file
+	static void m_print(const char* levtext, const char* text);  // a helper for printing messages into the command prompt and into the logger text file
 
 private:
 	static Log* m_instance;
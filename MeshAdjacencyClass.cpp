@@ -0,0 +1,179 @@
+#include "MeshAdjacencyClass.h"
+#include "ParallelFor.h"
+#include "TraceRecorderClass.h"
+
+
+// ----------------------------------------------------------------------------------- //
+//
+//                          PUBLIC METHODS
+//
+// ----------------------------------------------------------------------------------- //
+
+// compute the adjacency and/or edges (according to the options) by the final indices of the mesh
+bool MeshAdjacencyClass::Run(MeshData & mesh, const ConversionOptions & options)
+{
+	mesh.adjacencyIndices.clear();
+	mesh.edges.clear();
+
+	if (!options.computeAdjacency && !options.computeEdges)
+		return true;
+
+	TRACE_SCOPE("ComputeAdjacency");
+
+	// sort all the half edges so the half edges of the same edge go one after another
+	std::vector<HALF_EDGE> halfEdges;
+	this->BuildSortedHalfEdges(mesh, halfEdges);
+
+	if (options.computeAdjacency)
+	{
+		this->ComputeAdjacency(mesh, halfEdges);
+		Log::Debug(LOG_MACRO, "ADJACENCY WAS COMPUTED");
+	}
+
+	// we always go through the edges to report about the non-manifold ones
+	this->ComputeEdges(mesh, halfEdges);
+
+	if (!options.computeEdges)
+		mesh.edges.clear();
+
+	return true;
+}
+
+
+
+// ----------------------------------------------------------------------------------- //
+//
+//                          PRIVATE METHODS / HELPERS
+//
+// ----------------------------------------------------------------------------------- //
+
+void MeshAdjacencyClass::BuildSortedHalfEdges(const MeshData & mesh, std::vector<HALF_EDGE> & halfEdges)
+{
+	const size_t halfEdgesCount = mesh.GetFacesCount() * 3;
+
+	halfEdges.resize(halfEdgesCount);
+
+	ParallelFor(halfEdgesCount, MIN_ELEMENTS_PER_THREAD_, [&](size_t begin, size_t end, size_t)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			const size_t face = i / 3;
+			const UINT v0 = mesh.vertexIndices[i];
+			const UINT v1 = mesh.vertexIndices[face * 3 + (i + 1) % 3];
+
+			halfEdges[i].key = ((uint64_t)(std::min)(v0, v1) << 32) | (std::max)(v0, v1);
+			halfEdges[i].halfEdgeIdx = i;
+		}
+	});
+
+	ParallelSort(halfEdges, MIN_ELEMENTS_PER_THREAD_);
+
+	return;
+}
+
+
+// for each edge of each face find the opposite vertex of the neighbouring face;
+// if the edge is a boundary one (or it is shared by more than 2 faces) we use
+// the opposite vertex of the face itself
+void MeshAdjacencyClass::ComputeAdjacency(MeshData & mesh, const std::vector<HALF_EDGE> & halfEdges)
+{
+	const size_t halfEdgesCount = halfEdges.size();
+	const std::vector<UINT> & indices = mesh.vertexIndices;
+
+	// returns a vertex of the face which is opposite to the half edge
+	auto GetOppositeVertex = [&indices](const size_t halfEdgeIdx) -> UINT
+	{
+		const size_t face = halfEdgeIdx / 3;
+		return indices[face * 3 + (halfEdgeIdx + 2) % 3];
+	};
+
+	mesh.adjacencyIndices.resize(halfEdgesCount * 2);
+
+	// each thread handles edges which start in its part of the sorted half edges
+	ParallelFor(halfEdgesCount, MIN_ELEMENTS_PER_THREAD_, [&](size_t begin, size_t end, size_t)
+	{
+		for (size_t first = begin; first < end; first++)
+		{
+			if ((first > 0) && (halfEdges[first].key == halfEdges[first - 1].key))
+				continue;
+
+			size_t last = first + 1;
+
+			while ((last < halfEdgesCount) && (halfEdges[last].key == halfEdges[first].key))
+				last++;
+
+			for (size_t i = first; i < last; i++)
+			{
+				const size_t halfEdgeIdx = (size_t)halfEdges[i].halfEdgeIdx;
+				UINT adjacentVertex = GetOppositeVertex(halfEdgeIdx);
+
+				if (last - first == 2)
+				{
+					const size_t otherHalfEdgeIdx = (size_t)halfEdges[(i == first) ? first + 1 : first].halfEdgeIdx;
+					adjacentVertex = GetOppositeVertex(otherHalfEdgeIdx);
+				}
+
+				mesh.adjacencyIndices[halfEdgeIdx * 2 + 0] = indices[halfEdgeIdx];
+				mesh.adjacencyIndices[halfEdgeIdx * 2 + 1] = adjacentVertex;
+			}
+		}
+	});
+
+	return;
+}
+
+
+// make a list of unique edges and report about boundary/non-manifold edges
+void MeshAdjacencyClass::ComputeEdges(MeshData & mesh, const std::vector<HALF_EDGE> & halfEdges)
+{
+	const size_t halfEdgesCount = halfEdges.size();
+	const size_t MAX_REPORTED_EDGES = 10;
+	size_t boundaryEdgesCount = 0;
+	size_t nonManifoldEdgesCount = 0;
+
+	mesh.edges.reserve(halfEdgesCount / 2);
+
+	for (size_t first = 0; first < halfEdgesCount; )
+	{
+		size_t last = first + 1;
+
+		while ((last < halfEdgesCount) && (halfEdges[last].key == halfEdges[first].key))
+			last++;
+
+		EDGE edge;
+		edge.vertex0 = (UINT)(halfEdges[first].key >> 32);
+		edge.vertex1 = (UINT)(halfEdges[first].key & 0xFFFFFFFF);
+		edge.face0 = (UINT)(halfEdges[first].halfEdgeIdx / 3);
+
+		if (last - first == 1)
+		{
+			edge.type = EDGE::EDGE_TYPE_BOUNDARY;
+			boundaryEdgesCount++;
+		}
+		else
+		{
+			edge.face1 = (UINT)(halfEdges[first + 1].halfEdgeIdx / 3);
+			edge.type = (last - first == 2) ? EDGE::EDGE_TYPE_MANIFOLD : EDGE::EDGE_TYPE_NON_MANIFOLD;
+		}
+
+		if (edge.type == EDGE::EDGE_TYPE_NON_MANIFOLD)
+		{
+			if (nonManifoldEdgesCount < MAX_REPORTED_EDGES)
+			{
+				Log::Print("non-manifold edge: vertices %u %u are shared by %u faces",
+					edge.vertex0, edge.vertex1, (UINT)(last - first));
+			}
+			nonManifoldEdgesCount++;
+		}
+
+		mesh.edges.push_back(edge);
+		first = last;
+	}
+
+	Log::Print("edges: %u; boundary edges: %u; non-manifold edges: %u",
+		(UINT)mesh.edges.size(),
+		(UINT)boundaryEdgesCount,
+		(UINT)nonManifoldEdgesCount);
+
+	return;
+}
@@ -0,0 +1,49 @@
+/////////////////////////////////////////////////////////////////////
+// Filename:     MeshAdjacencyClass.h
+// Description:  computes triangles adjacency and a list of unique
+//               edges of the mesh (for the shadow volumes and
+//               outlines rendering)
+//
+// Created:      19.10.26
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////////////////////////
+// INCLUDES
+//////////////////////////////////
+#include "MeshData.h"
+#include "ConversionOptions.h"
+#include "Log.h"       // for using the log system
+
+#include <cstdint>
+
+
+//////////////////////////////////
+// Class name: MeshAdjacencyClass
+//////////////////////////////////
+class MeshAdjacencyClass
+{
+public:
+	// compute the adjacency and/or edges (according to the options) by the final indices of the mesh
+	bool Run(MeshData & mesh, const ConversionOptions & options);
+
+private:
+	// an edge of some face; half edges of the same edge have the same key
+	struct HALF_EDGE
+	{
+		uint64_t key = 0;        // (min vertex index << 32) | max vertex index
+		uint64_t halfEdgeIdx = 0;    // face * 3 + the edge number inside of the face
+
+		bool operator<(const HALF_EDGE & other) const
+		{
+			return (key < other.key) || ((key == other.key) && (halfEdgeIdx < other.halfEdgeIdx));
+		}
+	};
+
+	void BuildSortedHalfEdges(const MeshData & mesh, std::vector<HALF_EDGE> & halfEdges);
+	void ComputeAdjacency(MeshData & mesh, const std::vector<HALF_EDGE> & halfEdges);
+	void ComputeEdges(MeshData & mesh, const std::vector<HALF_EDGE> & halfEdges);
+
+	// constants
+	static const size_t MIN_ELEMENTS_PER_THREAD_ = 1 << 16;   // smaller meshes are handled on a single thread
+};
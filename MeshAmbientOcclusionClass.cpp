@@ -0,0 +1,741 @@
+#include "MeshAmbientOcclusionClass.h"
+#include "ParallelFor.h"
+#include "TraceRecorderClass.h"
+
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+
+// use SSE2 where it is available (it is always available on x64)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+	#define MESH_AO_SSE2
+	#include <emmintrin.h>
+#endif
+
+static constexpr float PI = 3.14159265358979f;
+
+// the coordinates of the vertices are accessed by the axis index
+static_assert(sizeof(VERTEX3D) == 3 * sizeof(float), "VERTEX3D must be 3 packed floats");
+
+static inline float GetAxis(const VERTEX3D & v, const int axis)
+{
+	return (&v.x)[axis];
+}
+
+static inline float GetSurfaceArea(const float aabbMin[3], const float aabbMax[3])
+{
+	const float dx = aabbMax[0] - aabbMin[0];
+	const float dy = aabbMax[1] - aabbMin[1];
+	const float dz = aabbMax[2] - aabbMin[2];
+
+	return 2.0f * (dx * dy + dy * dz + dz * dx);
+}
+
+// the bits of the value in the reversed order as a fraction in [0, 1) (the van der Corput sequence)
+static inline float GetRadicalInverse(UINT value)
+{
+	value = (value << 16) | (value >> 16);
+	value = ((value & 0x00ff00ff) << 8) | ((value & 0xff00ff00) >> 8);
+	value = ((value & 0x0f0f0f0f) << 4) | ((value & 0xf0f0f0f0) >> 4);
+	value = ((value & 0x33333333) << 2) | ((value & 0xcccccccc) >> 2);
+	value = ((value & 0x55555555) << 1) | ((value & 0xaaaaaaaa) >> 1);
+
+	return (float)(value >> 8) / (float)(1u << 24);
+}
+
+// a hash of the value as a fraction in [0, 1) (the finalizer of MurmurHash3)
+static inline float GetHashFraction(UINT value)
+{
+	value ^= value >> 16;
+	value *= 0x85ebca6b;
+	value ^= value >> 13;
+	value *= 0xc2b2ae35;
+	value ^= value >> 16;
+
+	return (float)(value >> 8) / (float)(1u << 24);
+}
+
+// the slab test divides by the direction components so they mustn't be zeros
+static inline float GetNonZero(const float value)
+{
+	return (std::fabs(value) < 1e-20f) ? 1e-20f : value;
+}
+
+
+// ----------------------------------------------------------------------------------- //
+//
+//                          PUBLIC METHODS
+//
+// ----------------------------------------------------------------------------------- //
+
+// compute mesh.ambientOcclusion by the final positions and faces of the mesh
+bool MeshAmbientOcclusionClass::Run(MeshData & mesh, const ConversionOptions & options)
+{
+	TRACE_SCOPE("BakeAmbientOcclusion");
+	TRACE_ARG("vertices", mesh.vertices.size());
+
+	if (!(options.ambientOcclusionMaxDistance >= 0.0f))
+	{
+		Log::Error(LOG_MACRO, ("invalid max distance of the ambient occlusion: " + std::to_string(options.ambientOcclusionMaxDistance)).c_str());
+		return false;
+	}
+
+	const size_t verticesCount = mesh.vertices.size();
+	const UINT raysCount = ((std::max)(1u, options.ambientOcclusionRaysCount) + RAYS_PER_PACKET_ - 1) / RAYS_PER_PACKET_ * RAYS_PER_PACKET_;
+
+	// the vertices which aren't used by any face are fully open
+	mesh.ambientOcclusion.assign(verticesCount, 1.0f);
+
+	std::vector<NORMAL> normals;
+
+	this->ComputeVertexNormals(mesh, normals);
+	this->BuildBvh(mesh);
+	this->GenerateDirections(raysCount);
+
+	if (nodes_.empty())
+	{
+		Log::Print("ambient occlusion: there are no valid faces");
+		return true;
+	}
+
+	// the distances are relative to the size of the mesh
+	const BVH_NODE & root = nodes_[0];
+	const float sizeX = root.aabbMax[0] - root.aabbMin[0];
+	const float sizeY = root.aabbMax[1] - root.aabbMin[1];
+	const float sizeZ = root.aabbMax[2] - root.aabbMin[2];
+	const float diagonal = std::sqrt(sizeX * sizeX + sizeY * sizeY + sizeZ * sizeZ);
+
+	const float maxDistance = (options.ambientOcclusionMaxDistance > 0.0f) ? options.ambientOcclusionMaxDistance : diagonal * DEFAULT_MAX_DISTANCE_FACTOR_;
+	const float bias = diagonal * RAY_BIAS_FACTOR_;
+
+	{
+		TRACE_SCOPE("TraceOcclusionRays");
+		TRACE_ARG("rays", (uint64_t)verticesCount * raysCount);
+
+		// each vertex is computed independently of the others so the split between the threads doesn't change the results
+		ParallelFor(verticesCount, MIN_VERTICES_PER_THREAD_, [&](size_t begin, size_t end, size_t)
+		{
+			for (size_t i = begin; i < end; i++)
+				mesh.ambientOcclusion[i] = this->ComputeVertexOcclusion((UINT)i, mesh.vertices[i], normals[i], maxDistance, bias);
+		});
+	}
+
+	double sum = 0.0;
+
+	for (const float value : mesh.ambientOcclusion)
+		sum += value;
+
+	Log::Print("ambient occlusion: %u vertices; %u rays per vertex; max distance: %f; BVH nodes: %u; average: %f",
+		(UINT)verticesCount,
+		raysCount,
+		maxDistance,
+		(UINT)nodes_.size(),
+		(verticesCount > 0) ? (float)(sum / verticesCount) : 1.0f);
+
+	return true;
+}
+
+
+
+// ----------------------------------------------------------------------------------- //
+//
+//                          PRIVATE METHODS / HELPERS
+//
+// ----------------------------------------------------------------------------------- //
+
+// compute a normal of each vertex as a sum of normals of its faces weighted by their areas;
+// the positions are already in the left handed system but the faces still have the winding
+// order of the input file so the outward normal of a face is edge2 x edge1
+void MeshAmbientOcclusionClass::ComputeVertexNormals(const MeshData & mesh, std::vector<NORMAL> & normals) const
+{
+	TRACE_SCOPE("ComputeVertexNormals");
+
+	const size_t verticesCount = mesh.vertices.size();
+	const size_t facesCount = mesh.GetFacesCount();
+
+	normals.assign(verticesCount, NORMAL());
+
+	for (size_t face = 0; face < facesCount; face++)
+	{
+		const UINT* idx = &mesh.vertexIndices[face * 3];
+
+		if ((idx[0] >= verticesCount) || (idx[1] >= verticesCount) || (idx[2] >= verticesCount))
+			continue;
+
+		const VERTEX3D & v0 = mesh.vertices[idx[0]];
+		const VERTEX3D & v1 = mesh.vertices[idx[1]];
+		const VERTEX3D & v2 = mesh.vertices[idx[2]];
+
+		const VERTEX3D edge1 = { v1.x - v0.x, v1.y - v0.y, v1.z - v0.z };
+		const VERTEX3D edge2 = { v2.x - v0.x, v2.y - v0.y, v2.z - v0.z };
+
+		// its length is twice the area of the face
+		const NORMAL faceNormal =
+		{
+			edge2.y * edge1.z - edge2.z * edge1.y,
+			edge2.z * edge1.x - edge2.x * edge1.z,
+			edge2.x * edge1.y - edge2.y * edge1.x
+		};
+
+		for (size_t vertex = 0; vertex < 3; vertex++)
+		{
+			NORMAL & normal = normals[idx[vertex]];
+
+			normal.nx += faceNormal.nx;
+			normal.ny += faceNormal.ny;
+			normal.nz += faceNormal.nz;
+		}
+	}
+
+	// the vertices which have no faces (or only degenerate ones) keep zero normals
+	for (NORMAL & normal : normals)
+	{
+		const float length = std::sqrt(normal.nx * normal.nx + normal.ny * normal.ny + normal.nz * normal.nz);
+
+		if ((length > 0.0f) && std::isfinite(length))
+		{
+			normal.nx /= length;
+			normal.ny /= length;
+			normal.nz /= length;
+		}
+		else
+		{
+			normal = NORMAL();
+		}
+	}
+
+	return;
+}
+
+
+// build a BVH over the faces by binned SAH splits of the centroids; the faces
+// which have invalid indices or non-finite positions aren't put into the BVH
+void MeshAmbientOcclusionClass::BuildBvh(const MeshData & mesh)
+{
+	TRACE_SCOPE("BuildBvh");
+
+	const size_t verticesCount = mesh.vertices.size();
+	const size_t facesCount = mesh.GetFacesCount();
+
+	std::vector<UINT> faces;
+	std::vector<VERTEX3D> centroids(facesCount);
+	std::vector<VERTEX3D> facesMin(facesCount);
+	std::vector<VERTEX3D> facesMax(facesCount);
+
+	nodes_.clear();
+	triangles_.clear();
+	faces.reserve(facesCount);
+
+	for (size_t face = 0; face < facesCount; face++)
+	{
+		const UINT* idx = &mesh.vertexIndices[face * 3];
+
+		if ((idx[0] >= verticesCount) || (idx[1] >= verticesCount) || (idx[2] >= verticesCount))
+			continue;
+
+		const VERTEX3D & v0 = mesh.vertices[idx[0]];
+		const VERTEX3D & v1 = mesh.vertices[idx[1]];
+		const VERTEX3D & v2 = mesh.vertices[idx[2]];
+
+		facesMin[face] = { (std::min)({ v0.x, v1.x, v2.x }), (std::min)({ v0.y, v1.y, v2.y }), (std::min)({ v0.z, v1.z, v2.z }) };
+		facesMax[face] = { (std::max)({ v0.x, v1.x, v2.x }), (std::max)({ v0.y, v1.y, v2.y }), (std::max)({ v0.z, v1.z, v2.z }) };
+
+		if (!std::isfinite(facesMin[face].x + facesMin[face].y + facesMin[face].z + facesMax[face].x + facesMax[face].y + facesMax[face].z))
+			continue;
+
+		centroids[face] = { (v0.x + v1.x + v2.x) / 3.0f, (v0.y + v1.y + v2.y) / 3.0f, (v0.z + v1.z + v2.z) / 3.0f };
+		faces.push_back((UINT)face);
+	}
+
+	if (faces.empty())
+		return;
+
+	// a binary tree with a leaf per face at most (so the nodes are never reallocated during the build)
+	nodes_.reserve(faces.size() * 2);
+	nodes_.emplace_back();
+	nodes_[0].first = 0;
+	nodes_[0].trianglesCount = (UINT)faces.size();
+	this->ComputeNodeBounds(nodes_[0], faces, facesMin, facesMax);
+
+	std::vector<BUILD_TASK> tasks(1);
+
+	while (!tasks.empty())
+	{
+		const BUILD_TASK task = tasks.back();
+		tasks.pop_back();
+
+		// the depth is limited by the size of the traversal stack
+		if ((task.depth + 1 >= MAX_BVH_DEPTH_) || !this->SplitNode(task.nodeIdx, faces, centroids, facesMin, facesMax))
+			continue;
+
+		const UINT leftIdx = nodes_[task.nodeIdx].first;
+
+		tasks.push_back({ leftIdx, task.depth + 1 });
+		tasks.push_back({ leftIdx + 1, task.depth + 1 });
+	}
+
+	// the leaves refer to the ranges of the partitioned faces array
+	triangles_.resize(faces.size());
+
+	for (size_t i = 0; i < faces.size(); i++)
+	{
+		const UINT* idx = &mesh.vertexIndices[(size_t)faces[i] * 3];
+		const VERTEX3D & v0 = mesh.vertices[idx[0]];
+		const VERTEX3D & v1 = mesh.vertices[idx[1]];
+		const VERTEX3D & v2 = mesh.vertices[idx[2]];
+
+		triangles_[i].v0 = v0;
+		triangles_[i].edge1 = { v1.x - v0.x, v1.y - v0.y, v1.z - v0.z };
+		triangles_[i].edge2 = { v2.x - v0.x, v2.y - v0.y, v2.z - v0.z };
+	}
+
+	return;
+}
+
+
+// split the leaf into 2 children by the plane with the lowest SAH cost among the bins
+// borders of the centroids bounds; returns false if the node stays a leaf
+bool MeshAmbientOcclusionClass::SplitNode(const UINT nodeIdx, std::vector<UINT> & faces, const std::vector<VERTEX3D> & centroids,
+	const std::vector<VERTEX3D> & facesMin, const std::vector<VERTEX3D> & facesMax)
+{
+	struct BIN
+	{
+		float aabbMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+		float aabbMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+		UINT count = 0;
+	};
+
+	const UINT first = nodes_[nodeIdx].first;
+	const UINT count = nodes_[nodeIdx].trianglesCount;
+
+	if (count <= MAX_LEAF_TRIANGLES_)
+		return false;
+
+	// bounds of the centroids
+	float centroidsMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+	float centroidsMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+	for (UINT i = first; i < first + count; i++)
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			centroidsMin[axis] = (std::min)(centroidsMin[axis], GetAxis(centroids[faces[i]], axis));
+			centroidsMax[axis] = (std::max)(centroidsMax[axis], GetAxis(centroids[faces[i]], axis));
+		}
+	}
+
+	float bestCost = FLT_MAX;
+	int bestAxis = -1;
+	UINT bestSplit = 0;                      // the faces of the bins [0, bestSplit) go into the left child
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		const float extent = centroidsMax[axis] - centroidsMin[axis];
+
+		if (!(extent > 0.0f))
+			continue;
+
+		const float scale = SAH_BINS_COUNT_ / extent;
+		BIN bins[SAH_BINS_COUNT_];
+
+		for (UINT i = first; i < first + count; i++)
+		{
+			const UINT face = faces[i];
+			const UINT binIdx = (std::min)(SAH_BINS_COUNT_ - 1, (UINT)((GetAxis(centroids[face], axis) - centroidsMin[axis]) * scale));
+			BIN & bin = bins[binIdx];
+
+			for (int k = 0; k < 3; k++)
+			{
+				bin.aabbMin[k] = (std::min)(bin.aabbMin[k], GetAxis(facesMin[face], k));
+				bin.aabbMax[k] = (std::max)(bin.aabbMax[k], GetAxis(facesMax[face], k));
+			}
+
+			bin.count++;
+		}
+
+		// the areas and counts of the left sides of the planes (plane i is between the bins i-1 and i)
+		float leftAreas[SAH_BINS_COUNT_];
+		UINT leftCounts[SAH_BINS_COUNT_];
+		BIN left;
+
+		for (UINT plane = 1; plane < SAH_BINS_COUNT_; plane++)
+		{
+			const BIN & bin = bins[plane - 1];
+
+			for (int k = 0; k < 3; k++)
+			{
+				left.aabbMin[k] = (std::min)(left.aabbMin[k], bin.aabbMin[k]);
+				left.aabbMax[k] = (std::max)(left.aabbMax[k], bin.aabbMax[k]);
+			}
+
+			left.count += bin.count;
+			leftAreas[plane] = GetSurfaceArea(left.aabbMin, left.aabbMax);
+			leftCounts[plane] = left.count;
+		}
+
+		// sweep from the right side and evaluate each plane
+		BIN right;
+
+		for (UINT plane = SAH_BINS_COUNT_ - 1; plane > 0; plane--)
+		{
+			const BIN & bin = bins[plane];
+
+			for (int k = 0; k < 3; k++)
+			{
+				right.aabbMin[k] = (std::min)(right.aabbMin[k], bin.aabbMin[k]);
+				right.aabbMax[k] = (std::max)(right.aabbMax[k], bin.aabbMax[k]);
+			}
+
+			right.count += bin.count;
+
+			if ((leftCounts[plane] == 0) || (right.count == 0))
+				continue;
+
+			const float cost = leftAreas[plane] * leftCounts[plane] + GetSurfaceArea(right.aabbMin, right.aabbMax) * right.count;
+
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestAxis = axis;
+				bestSplit = plane;
+			}
+		}
+	}
+
+	// all the centroids are at the same point
+	if (bestAxis < 0)
+		return false;
+
+	const float scale = SAH_BINS_COUNT_ / (centroidsMax[bestAxis] - centroidsMin[bestAxis]);
+
+	const auto middle = std::partition(faces.begin() + first, faces.begin() + first + count, [&](const UINT face)
+	{
+		return (std::min)(SAH_BINS_COUNT_ - 1, (UINT)((GetAxis(centroids[face], bestAxis) - centroidsMin[bestAxis]) * scale)) < bestSplit;
+	});
+
+	const UINT leftCount = (UINT)(middle - (faces.begin() + first));
+
+	if ((leftCount == 0) || (leftCount == count))
+		return false;
+
+	// the children go one after another
+	const UINT leftIdx = (UINT)nodes_.size();
+
+	nodes_.emplace_back();
+	nodes_.emplace_back();
+
+	nodes_[leftIdx].first = first;
+	nodes_[leftIdx].trianglesCount = leftCount;
+	nodes_[leftIdx + 1].first = first + leftCount;
+	nodes_[leftIdx + 1].trianglesCount = count - leftCount;
+
+	this->ComputeNodeBounds(nodes_[leftIdx], faces, facesMin, facesMax);
+	this->ComputeNodeBounds(nodes_[leftIdx + 1], faces, facesMin, facesMax);
+
+	nodes_[nodeIdx].first = leftIdx;
+	nodes_[nodeIdx].trianglesCount = 0;
+
+	return true;
+}
+
+
+void MeshAmbientOcclusionClass::ComputeNodeBounds(BVH_NODE & node, const std::vector<UINT> & faces,
+	const std::vector<VERTEX3D> & facesMin, const std::vector<VERTEX3D> & facesMax) const
+{
+	for (int axis = 0; axis < 3; axis++)
+	{
+		node.aabbMin[axis] = FLT_MAX;
+		node.aabbMax[axis] = -FLT_MAX;
+	}
+
+	for (UINT i = node.first; i < node.first + node.trianglesCount; i++)
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			node.aabbMin[axis] = (std::min)(node.aabbMin[axis], GetAxis(facesMin[faces[i]], axis));
+			node.aabbMax[axis] = (std::max)(node.aabbMax[axis], GetAxis(facesMax[faces[i]], axis));
+		}
+	}
+
+	return;
+}
+
+
+// generate the cosine-weighted directions by the Hammersley points so each ray has
+// the same weight (the occlusion is just the part of the rays which hit something)
+void MeshAmbientOcclusionClass::GenerateDirections(const UINT raysCount)
+{
+	directions_.resize(raysCount);
+
+	for (UINT i = 0; i < raysCount; i++)
+	{
+		const float u = ((float)i + 0.5f) / (float)raysCount;
+		const float radius = std::sqrt(u);
+		const float angle = 2.0f * PI * GetRadicalInverse(i);
+
+		directions_[i] = { radius * std::cos(angle), radius * std::sin(angle), std::sqrt((std::max)(0.0f, 1.0f - u)) };
+	}
+
+	return;
+}
+
+
+// returns the unoccluded part of the hemisphere of the vertex (1 -- fully open, 0 -- fully occluded)
+float MeshAmbientOcclusionClass::ComputeVertexOcclusion(const UINT vertexIdx, const VERTEX3D & position, const NORMAL & normal,
+	const float maxDistance, const float bias) const
+{
+	if ((normal.nx == 0.0f) && (normal.ny == 0.0f) && (normal.nz == 0.0f))
+		return 1.0f;
+
+	// an orthonormal basis around the normal (Duff et al., "Building an Orthonormal Basis, Revisited")
+	const float sign = std::copysign(1.0f, normal.nz);
+	const float a = -1.0f / (sign + normal.nz);
+	const float b = normal.nx * normal.ny * a;
+	const float tangent[3] = { 1.0f + sign * normal.nx * normal.nx * a, sign * b, -sign * normal.nx };
+	const float bitangent[3] = { b, sign + normal.ny * normal.ny * a, -normal.ny };
+
+	// the directions are rotated around the normal by an angle which depends only on the vertex
+	// index (so the banding of the same directions at all the vertices turns into a noise)
+	const float angle = 2.0f * PI * GetHashFraction(vertexIdx);
+	const float cosAngle = std::cos(angle);
+	const float sinAngle = std::sin(angle);
+
+	// the rays start a bit above the surface so they don't hit the faces of the vertex
+	const float origin[3] =
+	{
+		position.x + normal.nx * bias,
+		position.y + normal.ny * bias,
+		position.z + normal.nz * bias
+	};
+
+	const UINT raysCount = (UINT)directions_.size();
+	UINT occludedCount = 0;
+
+	for (UINT first = 0; first < raysCount; first += RAYS_PER_PACKET_)
+	{
+		float dirX[RAYS_PER_PACKET_];
+		float dirY[RAYS_PER_PACKET_];
+		float dirZ[RAYS_PER_PACKET_];
+
+		for (UINT lane = 0; lane < RAYS_PER_PACKET_; lane++)
+		{
+			const VERTEX3D & dir = directions_[first + lane];
+			const float x = dir.x * cosAngle - dir.y * sinAngle;
+			const float y = dir.x * sinAngle + dir.y * cosAngle;
+
+			dirX[lane] = GetNonZero(x * tangent[0] + y * bitangent[0] + dir.z * normal.nx);
+			dirY[lane] = GetNonZero(x * tangent[1] + y * bitangent[1] + dir.z * normal.ny);
+			dirZ[lane] = GetNonZero(x * tangent[2] + y * bitangent[2] + dir.z * normal.nz);
+		}
+
+		occludedCount += this->CountOccludedRays(origin, dirX, dirY, dirZ, maxDistance);
+	}
+
+	return 1.0f - (float)occludedCount / (float)raysCount;
+}
+
+
+// trace a packet of rays which start at the same origin; returns how many of them hit something closer than maxDistance
+// (the triangles are two-sided and any hit is enough so the traversal of a ray stops at its first hit)
+UINT MeshAmbientOcclusionClass::CountOccludedRays(const float origin[3], const float dirX[4], const float dirY[4], const float dirZ[4], const float maxDistance) const
+{
+#ifdef MESH_AO_SSE2
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 tMax = _mm_set1_ps(maxDistance);
+
+	const __m128 ox = _mm_set1_ps(origin[0]);
+	const __m128 oy = _mm_set1_ps(origin[1]);
+	const __m128 oz = _mm_set1_ps(origin[2]);
+
+	const __m128 dx = _mm_loadu_ps(dirX);
+	const __m128 dy = _mm_loadu_ps(dirY);
+	const __m128 dz = _mm_loadu_ps(dirZ);
+
+	const __m128 invDx = _mm_div_ps(one, dx);
+	const __m128 invDy = _mm_div_ps(one, dy);
+	const __m128 invDz = _mm_div_ps(one, dz);
+
+	const int allRaysMask = (1 << RAYS_PER_PACKET_) - 1;
+	__m128 occluded = zero;                  // all the bits are set in the lanes of the rays which hit something
+
+	UINT stack[MAX_BVH_DEPTH_];
+	UINT stackSize = 0;
+
+	stack[stackSize++] = 0;
+
+	while (stackSize > 0)
+	{
+		const BVH_NODE & node = nodes_[stack[--stackSize]];
+
+		// the slab test of the node's box (the rays which are already occluded are skipped)
+		const __m128 tx0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.aabbMin[0]), ox), invDx);
+		const __m128 tx1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.aabbMax[0]), ox), invDx);
+		const __m128 ty0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.aabbMin[1]), oy), invDy);
+		const __m128 ty1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.aabbMax[1]), oy), invDy);
+		const __m128 tz0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.aabbMin[2]), oz), invDz);
+		const __m128 tz1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.aabbMax[2]), oz), invDz);
+
+		const __m128 tNear = _mm_max_ps(_mm_max_ps(_mm_min_ps(tx0, tx1), _mm_min_ps(ty0, ty1)), _mm_max_ps(_mm_min_ps(tz0, tz1), zero));
+		const __m128 tFar = _mm_min_ps(_mm_min_ps(_mm_max_ps(tx0, tx1), _mm_max_ps(ty0, ty1)), _mm_min_ps(_mm_max_ps(tz0, tz1), tMax));
+		const __m128 active = _mm_andnot_ps(occluded, _mm_cmple_ps(tNear, tFar));
+
+		if (_mm_movemask_ps(active) == 0)
+			continue;
+
+		if (node.trianglesCount == 0)
+		{
+			stack[stackSize++] = node.first + 1;
+			stack[stackSize++] = node.first;
+			continue;
+		}
+
+		// the Moller-Trumbore test of each triangle of the leaf
+		for (UINT i = node.first; i < node.first + node.trianglesCount; i++)
+		{
+			const BVH_TRIANGLE & tri = triangles_[i];
+
+			// the terms which depend only on the origin are the same for all the rays of the packet
+			const float tvec[3] = { origin[0] - tri.v0.x, origin[1] - tri.v0.y, origin[2] - tri.v0.z };
+			const float qvec[3] =
+			{
+				tvec[1] * tri.edge1.z - tvec[2] * tri.edge1.y,
+				tvec[2] * tri.edge1.x - tvec[0] * tri.edge1.z,
+				tvec[0] * tri.edge1.y - tvec[1] * tri.edge1.x
+			};
+
+			const __m128 e2x = _mm_set1_ps(tri.edge2.x);
+			const __m128 e2y = _mm_set1_ps(tri.edge2.y);
+			const __m128 e2z = _mm_set1_ps(tri.edge2.z);
+
+			// pvec = dir x edge2
+			const __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+			const __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+			const __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+
+			const __m128 det = _mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(_mm_set1_ps(tri.edge1.x), px),
+				_mm_mul_ps(_mm_set1_ps(tri.edge1.y), py)),
+				_mm_mul_ps(_mm_set1_ps(tri.edge1.z), pz));
+
+			// a ray which is parallel to the triangle gives infinite or NaN terms which fail the comparisons below
+			const __m128 invDet = _mm_div_ps(one, det);
+
+			const __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(_mm_set1_ps(tvec[0]), px),
+				_mm_mul_ps(_mm_set1_ps(tvec[1]), py)),
+				_mm_mul_ps(_mm_set1_ps(tvec[2]), pz)), invDet);
+
+			const __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(dx, _mm_set1_ps(qvec[0])),
+				_mm_mul_ps(dy, _mm_set1_ps(qvec[1]))),
+				_mm_mul_ps(dz, _mm_set1_ps(qvec[2]))), invDet);
+
+			const __m128 t = _mm_mul_ps(_mm_set1_ps(tri.edge2.x * qvec[0] + tri.edge2.y * qvec[1] + tri.edge2.z * qvec[2]), invDet);
+
+			__m128 hit = _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmpge_ps(v, zero));
+			hit = _mm_and_ps(hit, _mm_cmple_ps(_mm_add_ps(u, v), one));
+			hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmpgt_ps(t, zero), _mm_cmplt_ps(t, tMax)));
+
+			occluded = _mm_or_ps(occluded, _mm_and_ps(hit, active));
+		}
+
+		if (_mm_movemask_ps(occluded) == allRaysMask)
+			break;
+	}
+
+	const int mask = _mm_movemask_ps(occluded);
+
+	return (UINT)((mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1));
+#else
+	UINT occludedCount = 0;
+
+	for (UINT lane = 0; lane < RAYS_PER_PACKET_; lane++)
+	{
+		const float dir[3] = { dirX[lane], dirY[lane], dirZ[lane] };
+
+		if (this->IsRayOccluded(origin, dir, maxDistance))
+			occludedCount++;
+	}
+
+	return occludedCount;
+#endif
+}
+
+
+// the scalar version of the packet traversal for a single ray
+bool MeshAmbientOcclusionClass::IsRayOccluded(const float origin[3], const float dir[3], const float maxDistance) const
+{
+	const float invDir[3] = { 1.0f / dir[0], 1.0f / dir[1], 1.0f / dir[2] };
+
+	UINT stack[MAX_BVH_DEPTH_];
+	UINT stackSize = 0;
+
+	stack[stackSize++] = 0;
+
+	while (stackSize > 0)
+	{
+		const BVH_NODE & node = nodes_[stack[--stackSize]];
+
+		float tNear = 0.0f;
+		float tFar = maxDistance;
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			const float t0 = (node.aabbMin[axis] - origin[axis]) * invDir[axis];
+			const float t1 = (node.aabbMax[axis] - origin[axis]) * invDir[axis];
+
+			tNear = (std::max)(tNear, (std::min)(t0, t1));
+			tFar = (std::min)(tFar, (std::max)(t0, t1));
+		}
+
+		if (tNear > tFar)
+			continue;
+
+		if (node.trianglesCount == 0)
+		{
+			stack[stackSize++] = node.first + 1;
+			stack[stackSize++] = node.first;
+			continue;
+		}
+
+		for (UINT i = node.first; i < node.first + node.trianglesCount; i++)
+		{
+			const BVH_TRIANGLE & tri = triangles_[i];
+
+			const float pvec[3] =
+			{
+				dir[1] * tri.edge2.z - dir[2] * tri.edge2.y,
+				dir[2] * tri.edge2.x - dir[0] * tri.edge2.z,
+				dir[0] * tri.edge2.y - dir[1] * tri.edge2.x
+			};
+
+			const float det = tri.edge1.x * pvec[0] + tri.edge1.y * pvec[1] + tri.edge1.z * pvec[2];
+
+			if (det == 0.0f)
+				continue;
+
+			const float invDet = 1.0f / det;
+			const float tvec[3] = { origin[0] - tri.v0.x, origin[1] - tri.v0.y, origin[2] - tri.v0.z };
+			const float u = (tvec[0] * pvec[0] + tvec[1] * pvec[1] + tvec[2] * pvec[2]) * invDet;
+
+			if ((u < 0.0f) || (u > 1.0f))
+				continue;
+
+			const float qvec[3] =
+			{
+				tvec[1] * tri.edge1.z - tvec[2] * tri.edge1.y,
+				tvec[2] * tri.edge1.x - tvec[0] * tri.edge1.z,
+				tvec[0] * tri.edge1.y - tvec[1] * tri.edge1.x
+			};
+
+			const float v = (dir[0] * qvec[0] + dir[1] * qvec[1] + dir[2] * qvec[2]) * invDet;
+			const float t = (tri.edge2.x * qvec[0] + tri.edge2.y * qvec[1] + tri.edge2.z * qvec[2]) * invDet;
+
+			if ((v >= 0.0f) && (u + v <= 1.0f) && (t > 0.0f) && (t < maxDistance))
+				return true;
+		}
+	}
+
+	return false;
+}
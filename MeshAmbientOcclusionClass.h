@@ -0,0 +1,84 @@
+/////////////////////////////////////////////////////////////////////
+// Filename:     MeshAmbientOcclusionClass.h
+// Description:  bakes a per-vertex ambient occlusion of the mesh: casts
+//               cosine-weighted hemisphere rays from each vertex (along
+//               its area-weighted normal) against a BVH of the same
+//               mesh; rays of a vertex are traced by packets of 4 (with
+//               SSE2 where it is available) and the ray directions
+//               depend only on the vertex index so the results don't
+//               depend on the number of threads
+//
+// Created:      19.10.26
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////////////////////////
+// INCLUDES
+//////////////////////////////////
+#include "MeshData.h"
+#include "ConversionOptions.h"
+#include "Log.h"       // for using the log system
+
+
+//////////////////////////////////
+// Class name: MeshAmbientOcclusionClass
+//////////////////////////////////
+class MeshAmbientOcclusionClass
+{
+public:
+	// compute mesh.ambientOcclusion by the final positions and faces of the mesh
+	bool Run(MeshData & mesh, const ConversionOptions & options);
+
+private:
+	struct BVH_NODE
+	{
+		float aabbMin[3];
+		UINT  first = 0;                     // a leaf: the first triangle; an inner node: the left child (the right one goes next)
+		float aabbMax[3];
+		UINT  trianglesCount = 0;            // 0 for inner nodes
+	};
+
+	// a triangle in the form of the intersection test
+	struct BVH_TRIANGLE
+	{
+		VERTEX3D v0;
+		VERTEX3D edge1;                      // v1 - v0
+		VERTEX3D edge2;                      // v2 - v0
+	};
+
+	// a range of triangles which is waiting to be split during the build
+	struct BUILD_TASK
+	{
+		UINT nodeIdx = 0;
+		UINT depth = 0;
+	};
+
+	void ComputeVertexNormals(const MeshData & mesh, std::vector<NORMAL> & normals) const;
+	void BuildBvh(const MeshData & mesh);
+	bool SplitNode(const UINT nodeIdx, std::vector<UINT> & faces, const std::vector<VERTEX3D> & centroids,
+		const std::vector<VERTEX3D> & facesMin, const std::vector<VERTEX3D> & facesMax);
+	void ComputeNodeBounds(BVH_NODE & node, const std::vector<UINT> & faces,
+		const std::vector<VERTEX3D> & facesMin, const std::vector<VERTEX3D> & facesMax) const;
+	void GenerateDirections(const UINT raysCount);
+
+	// returns the unoccluded part of the hemisphere of the vertex (1 -- fully open, 0 -- fully occluded)
+	float ComputeVertexOcclusion(const UINT vertexIdx, const VERTEX3D & position, const NORMAL & normal, const float maxDistance, const float bias) const;
+
+	// trace a packet of rays which start at the same origin; returns how many of them hit something closer than maxDistance
+	UINT CountOccludedRays(const float origin[3], const float dirX[4], const float dirY[4], const float dirZ[4], const float maxDistance) const;
+	bool IsRayOccluded(const float origin[3], const float dir[3], const float maxDistance) const;
+
+private:
+	std::vector<BVH_NODE> nodes_;            // the root is the first one
+	std::vector<BVH_TRIANGLE> triangles_;    // in the order of the leaves
+	std::vector<VERTEX3D> directions_;       // cosine-weighted directions around +z (the tangent space of a vertex)
+
+	// constants
+	static constexpr UINT RAYS_PER_PACKET_ = 4;
+	static constexpr UINT MAX_LEAF_TRIANGLES_ = 4;
+	static constexpr UINT MAX_BVH_DEPTH_ = 64;                     // is also the size of the traversal stack
+	static constexpr UINT SAH_BINS_COUNT_ = 16;
+	static constexpr size_t MIN_VERTICES_PER_THREAD_ = 1 << 10;    // smaller meshes are handled on a single thread
+	static constexpr float DEFAULT_MAX_DISTANCE_FACTOR_ = 0.25f;   // of the bounding box diagonal (when the distance isn't set)
+	static constexpr float RAY_BIAS_FACTOR_ = 1e-4f;               // of the bounding box diagonal (the rays start above the surface)
+};
@@ -0,0 +1,434 @@
+#include "MeshCleanerClass.h"
+#include "ParallelFor.h"
+#include "TraceRecorderClass.h"
+
+#include <cmath>
+#include <cstring>
+#include <climits>
+#include <algorithm>
+
+
+// mix bits of the key so the close keys are spread over the hash table (splitmix64 finalizer)
+static uint64_t HashKey(uint64_t key)
+{
+	key ^= key >> 30;
+	key *= 0xbf58476d1ce4e5b9ULL;
+	key ^= key >> 27;
+	key *= 0x94d049bb133111ebULL;
+	key ^= key >> 31;
+
+	return key;
+}
+
+// returns bits of the float value (-0.0f and 0.0f have the same bits)
+static uint32_t GetFloatBits(float value)
+{
+	uint32_t bits = 0;
+
+	value += 0.0f;
+	memcpy(&bits, &value, sizeof(float));
+
+	return bits;
+}
+
+// pack coords of the grid cell into a single key; the coords are wrapped
+// so far cells may have the same key (it is resolved by the distance check)
+static uint64_t MakeCellKey(const int64_t cx, const int64_t cy, const int64_t cz)
+{
+	const uint64_t mask = (1ULL << 21) - 1;
+	return (((uint64_t)cx & mask) << 42) | (((uint64_t)cy & mask) << 21) | ((uint64_t)cz & mask);
+}
+
+
+
+// ----------------------------------------------------------------------------------- //
+//
+//                          PUBLIC METHODS
+//
+// ----------------------------------------------------------------------------------- //
+
+// execute the cleanup over the mesh data (it must be executed before sorting of faces by material)
+bool MeshCleanerClass::Run(MeshData & mesh, const ConversionOptions & options)
+{
+	stats_ = CLEANUP_STATS();
+
+	if (options.weldVertices)
+		this->WeldVertices(mesh, options.weldTolerance);
+
+	if (options.removeDegenerateTriangles)
+		this->RemoveDegenerateTriangles(mesh, options.degenerateAreaTolerance);
+
+	if (options.removeDuplicateTriangles)
+		this->RemoveDuplicateTriangles(mesh);
+
+	Log::Print("mesh cleanup: welded vertices: %u; degenerate triangles: %u (by index), %u (by area); duplicate triangles: %u",
+		(UINT)stats_.weldedVerticesCount,
+		(UINT)stats_.degenerateByIndexCount,
+		(UINT)stats_.degenerateByAreaCount,
+		(UINT)stats_.duplicateTrianglesCount);
+
+	return true;
+}
+
+
+
+// ----------------------------------------------------------------------------------- //
+//
+//                          PRIVATE METHODS / HELPERS
+//
+// ----------------------------------------------------------------------------------- //
+
+// merge vertices which are closer than the tolerance; we use a spatial hash with the cell
+// size equal to the tolerance so all the close vertices are in the 27 neighbouring cells;
+// each vertex is merged into the first (by index) close vertex so the result doesn't depend
+// on the number of threads; chains of close vertices are merged into a single vertex
+void MeshCleanerClass::WeldVertices(MeshData & mesh, const float tolerance)
+{
+	TRACE_SCOPE("WeldVertices");
+	TRACE_ARG("vertices", mesh.vertices.size());
+
+	const size_t verticesCount = mesh.vertices.size();
+	const std::vector<VERTEX3D> & vertices = mesh.vertices;
+
+	if (verticesCount == 0)
+		return;
+
+	const bool isExact = (tolerance <= 0.0f);
+	const double invCellSize = isExact ? 0.0 : 1.0 / (double)tolerance;
+	const float toleranceSqr = tolerance * tolerance;
+
+	// returns a coord of the grid cell which contains this coord
+	auto GetCellCoord = [invCellSize](const float value) -> int64_t
+	{
+		const double cell = std::floor((double)value * invCellSize);
+		return (int64_t)(std::max)(-1e15, (std::min)(1e15, cell));
+	};
+
+	// returns a key of the cell which contains the vertex (or a key of the exact position)
+	auto GetVertexKey = [&](const VERTEX3D & v) -> uint64_t
+	{
+		if (isExact)
+			return (((uint64_t)GetFloatBits(v.x) << 32) | GetFloatBits(v.y)) ^ HashKey(GetFloatBits(v.z));
+
+		return MakeCellKey(GetCellCoord(v.x), GetCellCoord(v.y), GetCellCoord(v.z));
+	};
+
+
+	// sort vertices by keys so the vertices of each cell go one after another
+	std::vector<std::pair<uint64_t, UINT>> sortedVertices(verticesCount);
+
+	ParallelFor(verticesCount, MIN_ELEMENTS_PER_THREAD_, [&](size_t begin, size_t end, size_t)
+	{
+		for (size_t i = begin; i < end; i++)
+			sortedVertices[i] = { GetVertexKey(vertices[i]), (UINT)i };
+	});
+
+	std::sort(sortedVertices.begin(), sortedVertices.end());
+
+
+	// build a hash table: cell key => the first vertex of this cell in the sorted array
+	size_t tableSize = 1;
+
+	while (tableSize < verticesCount * 2)
+		tableSize <<= 1;
+
+	const size_t tableMask = tableSize - 1;
+	std::vector<UINT> cellsStarts(tableSize, UINT_MAX);
+
+	for (size_t i = 0; i < verticesCount; i++)
+	{
+		if ((i > 0) && (sortedVertices[i].first == sortedVertices[i - 1].first))
+			continue;
+
+		size_t slot = HashKey(sortedVertices[i].first) & tableMask;
+
+		while (cellsStarts[slot] != UINT_MAX)
+			slot = (slot + 1) & tableMask;
+
+		cellsStarts[slot] = (UINT)i;
+	}
+
+	// returns a position of the first vertex of the cell in the sorted array (or verticesCount if there is no such cell)
+	auto FindCellStart = [&](const uint64_t key) -> size_t
+	{
+		for (size_t slot = HashKey(key) & tableMask; cellsStarts[slot] != UINT_MAX; slot = (slot + 1) & tableMask)
+		{
+			if (sortedVertices[cellsStarts[slot]].first == key)
+				return cellsStarts[slot];
+		}
+
+		return verticesCount;
+	};
+
+	// go through vertices of the cell and find the close vertex with the smallest index
+	auto FindRepresentativeInCell = [&](const uint64_t key, const VERTEX3D & v, UINT & representative)
+	{
+		for (size_t j = FindCellStart(key); (j < verticesCount) && (sortedVertices[j].first == key); j++)
+		{
+			const UINT otherIdx = sortedVertices[j].second;
+
+			// vertices of the cell are sorted by indices so there are no smaller indices further
+			if (otherIdx >= representative)
+				break;
+
+			const VERTEX3D & other = vertices[otherIdx];
+			const float dx = other.x - v.x;
+			const float dy = other.y - v.y;
+			const float dz = other.z - v.z;
+
+			const bool isClose = isExact ?
+				((other.x == v.x) && (other.y == v.y) && (other.z == v.z)) :
+				(dx * dx + dy * dy + dz * dz <= toleranceSqr);
+
+			if (isClose)
+				representative = otherIdx;
+		}
+	};
+
+
+	// find a representative for each vertex (a close vertex with the smallest index)
+	std::vector<UINT> representatives(verticesCount);
+
+	ParallelFor(verticesCount, MIN_ELEMENTS_PER_THREAD_, [&](size_t begin, size_t end, size_t)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			const VERTEX3D & v = vertices[i];
+			UINT representative = (UINT)i;
+
+			if (isExact)
+			{
+				FindRepresentativeInCell(GetVertexKey(v), v, representative);
+			}
+			else
+			{
+				const int64_t cx = GetCellCoord(v.x);
+				const int64_t cy = GetCellCoord(v.y);
+				const int64_t cz = GetCellCoord(v.z);
+
+				for (int64_t dx = -1; dx <= 1; dx++)
+					for (int64_t dy = -1; dy <= 1; dy++)
+						for (int64_t dz = -1; dz <= 1; dz++)
+							FindRepresentativeInCell(MakeCellKey(cx + dx, cy + dy, cz + dz), v, representative);
+			}
+
+			representatives[i] = representative;
+		}
+	});
+
+
+	// a representative always has a smaller index so in the order of indices
+	// we collapse the chains and compute new indices of the left vertices
+	std::vector<UINT> newIndices(verticesCount);
+	std::vector<VERTEX3D> weldedVertices;
+
+	weldedVertices.reserve(verticesCount);
+
+	for (size_t i = 0; i < verticesCount; i++)
+	{
+		representatives[i] = representatives[representatives[i]];
+
+		if (representatives[i] == i)
+		{
+			newIndices[i] = (UINT)weldedVertices.size();
+			weldedVertices.push_back(vertices[i]);
+		}
+		else
+		{
+			newIndices[i] = newIndices[representatives[i]];
+		}
+	}
+
+	stats_.weldedVerticesCount = verticesCount - weldedVertices.size();
+
+	if (stats_.weldedVerticesCount == 0)
+		return;
+
+	// remap the faces to the welded vertices (we leave invalid indices as is)
+	ParallelFor(mesh.vertexIndices.size(), MIN_ELEMENTS_PER_THREAD_, [&](size_t begin, size_t end, size_t)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			if (mesh.vertexIndices[i] < verticesCount)
+				mesh.vertexIndices[i] = newIndices[mesh.vertexIndices[i]];
+		}
+	});
+
+	mesh.vertices = std::move(weldedVertices);
+
+	return;
+}
+
+
+// remove triangles which have repeated vertices (by index) or area <= areaTolerance
+void MeshCleanerClass::RemoveDegenerateTriangles(MeshData & mesh, const float areaTolerance)
+{
+	TRACE_SCOPE("RemoveDegenerateTriangles");
+
+	const size_t facesCount = mesh.GetFacesCount();
+	const size_t verticesCount = mesh.vertices.size();
+	std::vector<uint8_t> keepFaces(facesCount, 1);
+
+	// per-thread counters of removed triangles
+	std::vector<size_t> byIndexCounts(GetWorkerThreadsCount(), 0);
+	std::vector<size_t> byAreaCounts(GetWorkerThreadsCount(), 0);
+
+	ParallelFor(facesCount, MIN_ELEMENTS_PER_THREAD_, [&](size_t begin, size_t end, size_t threadIdx)
+	{
+		for (size_t face = begin; face < end; face++)
+		{
+			const UINT i0 = mesh.vertexIndices[face * 3 + 0];
+			const UINT i1 = mesh.vertexIndices[face * 3 + 1];
+			const UINT i2 = mesh.vertexIndices[face * 3 + 2];
+
+			if ((i0 == i1) || (i1 == i2) || (i0 == i2))
+			{
+				keepFaces[face] = 0;
+				byIndexCounts[threadIdx]++;
+				continue;
+			}
+
+			// we can't compute the area if the face has invalid indices
+			if ((i0 >= verticesCount) || (i1 >= verticesCount) || (i2 >= verticesCount))
+				continue;
+
+			const VERTEX3D & v0 = mesh.vertices[i0];
+			const VERTEX3D & v1 = mesh.vertices[i1];
+			const VERTEX3D & v2 = mesh.vertices[i2];
+
+			// the area of the triangle is a half of the length of the cross product of its edges
+			const double e1x = v1.x - v0.x, e1y = v1.y - v0.y, e1z = v1.z - v0.z;
+			const double e2x = v2.x - v0.x, e2y = v2.y - v0.y, e2z = v2.z - v0.z;
+			const double cx = e1y * e2z - e1z * e2y;
+			const double cy = e1z * e2x - e1x * e2z;
+			const double cz = e1x * e2y - e1y * e2x;
+			const double area = 0.5 * std::sqrt(cx * cx + cy * cy + cz * cz);
+
+			if (area <= (double)areaTolerance)
+			{
+				keepFaces[face] = 0;
+				byAreaCounts[threadIdx]++;
+			}
+		}
+	});
+
+	for (size_t threadIdx = 0; threadIdx < byIndexCounts.size(); threadIdx++)
+	{
+		stats_.degenerateByIndexCount += byIndexCounts[threadIdx];
+		stats_.degenerateByAreaCount += byAreaCounts[threadIdx];
+	}
+
+	if (stats_.degenerateByIndexCount + stats_.degenerateByAreaCount > 0)
+		mesh.CompactFaces(keepFaces);
+
+	return;
+}
+
+
+// remove triangles which use the same 3 vertices with the same texture coords and the same winding
+// as some previous triangle of the same submesh (a triangle with the reversed winding faces the other
+// way so it isn't a duplicate)
+void MeshCleanerClass::RemoveDuplicateTriangles(MeshData & mesh)
+{
+	TRACE_SCOPE("RemoveDuplicateTriangles");
+
+	const size_t facesCount = mesh.GetFacesCount();
+	const bool hasSubmeshes = !mesh.faceSubmeshIndices.empty();
+
+	// returns the (vertex, texture) indices of the face rotated so the smallest pair goes first
+	// (the rotation keeps the winding) and the index of its submesh
+	auto GetFaceKey = [&mesh, hasSubmeshes](const size_t face, UINT key[FACE_KEY_SIZE_])
+	{
+		const UINT* v = &mesh.vertexIndices[face * 3];
+		const UINT* t = &mesh.textureIndices[face * 3];
+
+		auto IsLess = [v, t](const size_t a, const size_t b)
+		{
+			for (size_t k = 0; k < 3; k++)
+			{
+				const size_t i = (a + k) % 3;
+				const size_t j = (b + k) % 3;
+
+				if ((v[i] != v[j]) || (t[i] != t[j]))
+					return (v[i] != v[j]) ? (v[i] < v[j]) : (t[i] < t[j]);
+			}
+
+			return false;
+		};
+
+		size_t first = 0;
+
+		for (size_t rotation = 1; rotation < 3; rotation++)
+		{
+			if (IsLess(rotation, first))
+				first = rotation;
+		}
+
+		for (size_t k = 0; k < 3; k++)
+		{
+			key[k] = v[(first + k) % 3];
+			key[3 + k] = t[(first + k) % 3];
+		}
+
+		key[6] = hasSubmeshes ? mesh.faceSubmeshIndices[face] : 0;
+	};
+
+	// compute a hash of each face and sort faces by hashes so equal faces go one after another
+	std::vector<std::pair<uint64_t, UINT>> facesHashes(facesCount);
+
+	ParallelFor(facesCount, MIN_ELEMENTS_PER_THREAD_, [&](size_t begin, size_t end, size_t)
+	{
+		UINT key[FACE_KEY_SIZE_];
+
+		for (size_t face = begin; face < end; face++)
+		{
+			GetFaceKey(face, key);
+
+			uint64_t hash = 0;
+
+			for (size_t k = 0; k < FACE_KEY_SIZE_; k++)
+				hash = HashKey(hash + key[k] + 0x9e3779b97f4a7c15ULL);
+
+			facesHashes[face] = { hash, (UINT)face };
+		}
+	});
+
+	std::sort(facesHashes.begin(), facesHashes.end());
+
+	// in each group of faces with the same hash we keep the first face of each unique key
+	std::vector<uint8_t> keepFaces(facesCount, 1);
+	UINT key[FACE_KEY_SIZE_];
+	UINT otherKey[FACE_KEY_SIZE_];
+
+	for (size_t first = 0; first < facesCount; )
+	{
+		size_t last = first + 1;
+
+		while ((last < facesCount) && (facesHashes[last].first == facesHashes[first].first))
+			last++;
+
+		for (size_t i = first + 1; i < last; i++)
+		{
+			GetFaceKey(facesHashes[i].second, key);
+
+			for (size_t j = first; j < i; j++)
+			{
+				GetFaceKey(facesHashes[j].second, otherKey);
+
+				if (keepFaces[facesHashes[j].second] && (memcmp(key, otherKey, sizeof(key)) == 0))
+				{
+					keepFaces[facesHashes[i].second] = 0;
+					stats_.duplicateTrianglesCount++;
+					break;
+				}
+			}
+		}
+
+		first = last;
+	}
+
+	if (stats_.duplicateTrianglesCount > 0)
+		mesh.CompactFaces(keepFaces);
+
+	return;
+}
@@ -0,0 +1,53 @@
+/////////////////////////////////////////////////////////////////////
+// Filename:     MeshCleanerClass.h
+// Description:  a cleanup stage of the mesh data: welding of
+//               coincident vertices, removal of degenerate and
+//               duplicate triangles
+//
+// Created:      19.10.26
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////////////////////////
+// INCLUDES
+//////////////////////////////////
+#include "MeshData.h"
+#include "ConversionOptions.h"
+#include "Log.h"       // for using the log system
+
+#include <cstdint>
+
+
+//////////////////////////////////
+// Class name: MeshCleanerClass
+//////////////////////////////////
+class MeshCleanerClass
+{
+public:
+	// how many elements were removed by the cleanup stage
+	struct CLEANUP_STATS
+	{
+		size_t weldedVerticesCount = 0;
+		size_t degenerateByIndexCount = 0;     // triangles which have repeated vertices
+		size_t degenerateByAreaCount = 0;      // triangles which have (almost) zero area
+		size_t duplicateTrianglesCount = 0;
+	};
+
+public:
+	// execute the cleanup over the mesh data (it must be executed before sorting of faces by material)
+	bool Run(MeshData & mesh, const ConversionOptions & options);
+
+	const CLEANUP_STATS & GetStats() const { return stats_; }
+
+private:
+	void WeldVertices(MeshData & mesh, const float tolerance);
+	void RemoveDegenerateTriangles(MeshData & mesh, const float areaTolerance);
+	void RemoveDuplicateTriangles(MeshData & mesh);
+
+private:
+	CLEANUP_STATS stats_;
+
+	// constants
+	static const size_t MIN_ELEMENTS_PER_THREAD_ = 1 << 16;   // smaller meshes are handled on a single thread
+	static const size_t FACE_KEY_SIZE_ = 7;                   // vertex and texture indices of a face and its submesh
+};
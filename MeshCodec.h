@@ -0,0 +1,71 @@
+/////////////////////////////////////////////////////////////////////
+// Filename:     MeshCodec.h
+// Description:  constants of the compressed vertex/index streams
+//               format which are shared between the encoder (the
+//               model converter) and the standalone decoder (the engine)
+//
+//               the compressed file:
+//                 uint32 magic ("MCMP"), uint32 version, uint32 streams count,
+//                 for each stream:
+//                   uint32 type, uint32 elements count, uint32 stride,
+//                   uint32 size of the encoded data, the encoded data
+//
+//               the vertex stream (each 4-byte word of the vertex is a channel):
+//                 for each channel: the delta to the previous vertex is zigzag
+//                 encoded and split into 4 byte planes; each byte plane is
+//                 split into groups of 16 bytes and each group is stored as
+//                 zeros / 4-bit values / raw bytes (a 2-bit mode per group)
+//
+//               the index stream (triangles):
+//                 each triangle is coded with a single byte when it shares an edge
+//                 with one of the 15 recent triangles and its third vertex is
+//                 the next new vertex or one of the recent vertices
+//
+// Created:      19.10.26
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+
+const uint32_t MESH_CODEC_FILE_MAGIC = 0x504D434D;      // "MCMP"
+const uint32_t MESH_CODEC_FILE_VERSION = 1;
+const uint32_t MESH_CODEC_VERTEX_MAGIC = 0x3158564D;    // "MVX1"
+const uint32_t MESH_CODEC_INDEX_MAGIC = 0x3158494D;     // "MIX1"
+
+// types of the streams in the compressed file
+enum MESH_CODEC_STREAM_TYPE
+{
+	MESH_CODEC_STREAM_POSITIONS = 0,
+	MESH_CODEC_STREAM_TEXTURE_COORDS = 1,
+	MESH_CODEC_STREAM_VERTEX_INDICES = 2,
+	MESH_CODEC_STREAM_TEXTURE_INDICES = 3,
+};
+
+// the vertex stream: modes of the byte groups
+const size_t  MESH_CODEC_GROUP_SIZE = 16;
+const uint8_t MESH_CODEC_GROUP_ZERO = 0;                // all the bytes of the group are zeros (no data)
+const uint8_t MESH_CODEC_GROUP_NIBBLES = 1;             // all the bytes are < 16 (8 bytes of data)
+const uint8_t MESH_CODEC_GROUP_RAW = 2;                 // 16 bytes of data
+
+// the index stream: a triangle code is (edge << 4) | vertex code;
+// the edge 15 means that the triangle doesn't share an edge with
+// a recent triangle so 3 full vertex codes go after it
+const size_t  MESH_CODEC_FIFO_SIZE = 16;
+const uint8_t MESH_CODEC_NO_EDGE = 0xF0;
+const uint8_t MESH_CODEC_EDGES_IN_FIFO = 15;            // the edge code 15 is reserved for MESH_CODEC_NO_EDGE
+
+// a vertex code after the edge (4 bits): the next new vertex, 14 recent vertices or an explicit index
+const uint8_t MESH_CODEC_SHORT_NEXT = 0;
+const uint8_t MESH_CODEC_SHORT_FIFO_COUNT = 14;
+const uint8_t MESH_CODEC_SHORT_EXPLICIT = 15;
+
+// a full vertex code (a byte): the next new vertex, 16 recent vertices or an explicit index
+const uint8_t MESH_CODEC_FULL_NEXT = 0;
+const uint8_t MESH_CODEC_FULL_FIFO_COUNT = 16;
+const uint8_t MESH_CODEC_FULL_EXPLICIT = 17;
+
+// explicit indices are stored as LEB128 of zigzag(index - next new vertex)
+inline uint32_t MeshCodecZigZag(const int32_t value)   { return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31); }
+inline int32_t  MeshCodecUnZigZag(const uint32_t value) { return (int32_t)(value >> 1) ^ -(int32_t)(value & 1); }
@@ -0,0 +1,188 @@
+/////////////////////////////////////////////////////////////////////
+// Filename:     MeshData.h
+// Description:  an in-memory representation of the model's data;
+//               each input format converter fills in this structure,
+//               then it goes through the common processing stages
+//               and is written by the common output writer
+//
+// Created:      19.10.26
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "Platform.h"   // for UINT
+#include <vector>
+#include <string>
+#include <climits>
+#include <cstdint>
+
+
+struct VERTEX3D
+{
+	float x = 0.0f;
+	float y = 0.0f;
+	float z = 0.0f;
+};
+
+struct TEXTURE_COORDS
+{
+	float tu = 0.0f;
+	float tv = 0.0f;
+};
+
+struct NORMAL
+{
+	float nx = 0.0f;
+	float ny = 0.0f;
+	float nz = 0.0f;
+};
+
+// a range of faces which have the same material and the same group/object
+struct SUBMESH
+{
+	std::string materialName{ "" };
+	std::string groupName{ "" };
+	UINT materialIndex = 0;              // an index of the material in the materialsNames array
+	size_t indexOffset = 0;              // the first index of this submesh in the indices arrays
+	size_t indexCount = 0;               // how many indices this submesh has
+	UINT baseVertex = 0;                 // is added to the vertex indices of this submesh (INDEX_FORMAT_UINT16_BASE_VERTEX)
+	UINT baseTexCoord = 0;               // is added to the texture indices of this submesh (INDEX_FORMAT_UINT16_BASE_VERTEX)
+	VERTEX3D aabbMin;                    // the axis-aligned bounding box of this submesh
+	VERTEX3D aabbMax;
+};
+
+// a format of indices in the output file (the engine binds the matching index buffer format)
+enum INDEX_FORMAT
+{
+	INDEX_FORMAT_UINT32 = 0,                 // 32-bit indices
+	INDEX_FORMAT_UINT16 = 1,                 // 16-bit indices (all the vertices and texture coords are addressable with 16 bits)
+	INDEX_FORMAT_UINT16_BASE_VERTEX = 2,     // 16-bit indices relative to the base vertex/texture coord of each submesh
+};
+
+// a unique edge of the mesh and the faces which share it (the runtime can compare
+// orientations of these faces relative to the light/view to find silhouette edges)
+struct EDGE
+{
+	enum EDGE_TYPE
+	{
+		EDGE_TYPE_MANIFOLD = 0,              // the edge is shared by 2 faces
+		EDGE_TYPE_BOUNDARY = 1,              // the edge belongs to a single face (face1 is invalid)
+		EDGE_TYPE_NON_MANIFOLD = 2,          // the edge is shared by more than 2 faces (we store the first 2 of them)
+	};
+
+	UINT vertex0 = 0;                        // vertex0 < vertex1
+	UINT vertex1 = 0;
+	UINT face0 = 0;
+	UINT face1 = UINT_MAX;
+	UINT type = EDGE_TYPE_BOUNDARY;
+};
+
+
+struct MeshData
+{
+	// all the data is already in the left handed coordinate system
+	// (but the faces winding order is still the same as in the input file)
+	std::vector<VERTEX3D> vertices;
+	std::vector<TEXTURE_COORDS> texCoords;
+
+	std::vector<UINT> vertexIndices;                 // each face has 3 vertices
+	std::vector<UINT> textureIndices;                // each face has 3 texture coords
+
+	std::vector<UINT> faceSubmeshIndices;            // a submesh index for each face (is cleared after sorting of faces)
+	std::vector<UINT> faceSourceLines;               // a line of the input file for each face (if the format has lines; is cleared after sorting of faces)
+	std::vector<SUBMESH> submeshes;
+	std::vector<std::string> materialsNames;         // materials in the order of their first usage
+	std::string materialLibName{ "" };               // a name of the materials library file (if there is one)
+	INDEX_FORMAT indexFormat = INDEX_FORMAT_UINT32;  // is chosen after faces are sorted
+
+	// optional data (is computed after faces are sorted)
+	std::vector<UINT> adjacencyIndices;              // 6 per face: v0, adjacent(v0 v1), v1, adjacent(v1 v2), v2, adjacent(v2 v0)
+	std::vector<EDGE> edges;                         // unique edges of the mesh
+	std::vector<float> ambientOcclusion;             // a value per vertex: 1 -- fully open, 0 -- fully occluded
+
+	size_t GetFacesCount() const { return vertexIndices.size() / 3; }
+
+	// remove all the data but keep the allocated memory (a converter which is
+	// used for many conversions doesn't reallocate its arrays each time)
+	void Clear()
+	{
+		vertices.clear();
+		texCoords.clear();
+		vertexIndices.clear();
+		textureIndices.clear();
+		faceSubmeshIndices.clear();
+		faceSourceLines.clear();
+		submeshes.clear();
+		materialsNames.clear();
+		materialLibName.clear();
+		indexFormat = INDEX_FORMAT_UINT32;
+		adjacencyIndices.clear();
+		edges.clear();
+		ambientOcclusion.clear();
+	}
+
+	// remove faces with false keep flags (faces which are left stay in the same order)
+	void CompactFaces(const std::vector<uint8_t> & keepFaces)
+	{
+		const size_t facesCount = keepFaces.size();
+		const bool hasSubmeshes = !faceSubmeshIndices.empty();
+		const bool hasSourceLines = !faceSourceLines.empty();
+		size_t dstFace = 0;
+
+		for (size_t face = 0; face < facesCount; face++)
+		{
+			if (!keepFaces[face])
+				continue;
+
+			for (size_t vertex = 0; vertex < 3; vertex++)
+			{
+				vertexIndices[dstFace * 3 + vertex] = vertexIndices[face * 3 + vertex];
+				textureIndices[dstFace * 3 + vertex] = textureIndices[face * 3 + vertex];
+			}
+
+			if (hasSubmeshes)
+				faceSubmeshIndices[dstFace] = faceSubmeshIndices[face];
+
+			if (hasSourceLines)
+				faceSourceLines[dstFace] = faceSourceLines[face];
+
+			dstFace++;
+		}
+
+		vertexIndices.resize(dstFace * 3);
+		textureIndices.resize(dstFace * 3);
+
+		if (hasSubmeshes)
+			faceSubmeshIndices.resize(dstFace);
+
+		if (hasSourceLines)
+			faceSourceLines.resize(dstFace);
+	}
+
+	// when the input format has no separate texture coords indices (PLY, STL) the texture
+	// coords are stored per vertex; if there are no texture coords at all we put
+	// a single zero texture coord so each face still refers to a valid one
+	void SetTextureIndicesFromVertexIndices()
+	{
+		if (texCoords.empty())
+		{
+			texCoords.push_back(TEXTURE_COORDS());
+			textureIndices.assign(vertexIndices.size(), 0);
+		}
+		else
+		{
+			textureIndices = vertexIndices;
+		}
+	}
+
+	// when the input format has no materials we put all the faces into a single submesh
+	void SetSingleSubmesh()
+	{
+		SUBMESH submesh;
+		submesh.materialName = "default";
+		submesh.groupName = "default";
+
+		materialsNames.assign(1, submesh.materialName);
+		submeshes.assign(1, submesh);
+		faceSubmeshIndices.assign(GetFacesCount(), 0);
+	}
+};
@@ -0,0 +1,366 @@
+#include "MeshDecoderClass.h"
+
+#include <cstring>
+#include <vector>
+
+// use SSE2 where it is available (it is always available on x64)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+	#define MESH_DECODER_SSE2
+	#include <emmintrin.h>
+#endif
+
+
+// ----------------------------------------------------------------------------------- //
+//
+//                          PUBLIC METHODS
+//
+// ----------------------------------------------------------------------------------- //
+
+// find a stream of the input type in the compressed file's data
+bool MeshDecoderClass::FindStream(const uint8_t* pFileData, const size_t fileSize, const MESH_CODEC_STREAM_TYPE type, STREAM_INFO & stream)
+{
+	const size_t FILE_HEADER_SIZE = 3 * sizeof(uint32_t);
+	const size_t STREAM_HEADER_SIZE = 4 * sizeof(uint32_t);
+
+	if ((fileSize < FILE_HEADER_SIZE) ||
+		(ReadUInt32(pFileData) != MESH_CODEC_FILE_MAGIC) ||
+		(ReadUInt32(pFileData + 4) != MESH_CODEC_FILE_VERSION))
+	{
+		return false;
+	}
+
+	const uint32_t streamsCount = ReadUInt32(pFileData + 8);
+	size_t offset = FILE_HEADER_SIZE;
+
+	for (uint32_t i = 0; i < streamsCount; i++)
+	{
+		if (offset + STREAM_HEADER_SIZE > fileSize)
+			return false;
+
+		const uint32_t streamType = ReadUInt32(pFileData + offset);
+		const uint32_t dataSize = ReadUInt32(pFileData + offset + 12);
+
+		if (offset + STREAM_HEADER_SIZE + dataSize > fileSize)
+			return false;
+
+		if (streamType == (uint32_t)type)
+		{
+			stream.type = type;
+			stream.elementsCount = ReadUInt32(pFileData + offset + 4);
+			stream.stride = ReadUInt32(pFileData + offset + 8);
+			stream.pData = pFileData + offset + STREAM_HEADER_SIZE;
+			stream.dataSize = dataSize;
+			return true;
+		}
+
+		offset += STREAM_HEADER_SIZE + dataSize;
+	}
+
+	return false;
+}
+
+
+// decode vertices into the destination buffer (verticesCount * stride bytes)
+bool MeshDecoderClass::DecodeVertexStream(void* pDestination, const size_t verticesCount, const size_t stride, const uint8_t* pData, const size_t dataSize)
+{
+	const uint8_t* pDataEnd = pData + dataSize;
+	uint8_t* pVertexBytes = static_cast<uint8_t*>(pDestination);
+
+	if ((dataSize < 3 * sizeof(uint32_t)) ||
+		(ReadUInt32(pData) != MESH_CODEC_VERTEX_MAGIC) ||
+		(ReadUInt32(pData + 4) != verticesCount) ||
+		(ReadUInt32(pData + 8) != stride) ||
+		(stride % sizeof(uint32_t) != 0))
+	{
+		return false;
+	}
+
+	pData += 3 * sizeof(uint32_t);
+
+	const size_t channelsCount = stride / sizeof(uint32_t);
+	const size_t groupsCount = (verticesCount + MESH_CODEC_GROUP_SIZE - 1) / MESH_CODEC_GROUP_SIZE;
+	const size_t planeSize = groupsCount * MESH_CODEC_GROUP_SIZE;
+
+	std::vector<uint8_t> planes(4 * planeSize);
+	std::vector<uint32_t> words(planeSize);
+
+	for (size_t channel = 0; channel < channelsCount; channel++)
+	{
+		for (size_t plane = 0; plane < 4; plane++)
+		{
+			pData = DecodeBytePlane(pData, pDataEnd, groupsCount, &planes[plane * planeSize]);
+
+			if (pData == nullptr)
+				return false;
+		}
+
+		// get the words back from the byte planes and undo the zigzag encoding
+		CombineBytePlanes(planes.data(), planeSize, verticesCount, words.data());
+
+		// undo the delta encoding and put the words into their places in the vertices
+		uint32_t word = 0;
+		uint8_t* pWordDst = pVertexBytes + channel * sizeof(uint32_t);
+
+		for (size_t i = 0; i < verticesCount; i++, pWordDst += stride)
+		{
+			word += words[i];
+			memcpy(pWordDst, &word, sizeof(uint32_t));
+		}
+	}
+
+	return true;
+}
+
+
+// decode triangles into the destination buffer (indicesCount indices)
+bool MeshDecoderClass::DecodeIndexStream(uint32_t* pDestination, const size_t indicesCount, const uint8_t* pData, const size_t dataSize)
+{
+	const uint8_t* pDataEnd = pData + dataSize;
+
+	if ((dataSize < 2 * sizeof(uint32_t)) ||
+		(ReadUInt32(pData) != MESH_CODEC_INDEX_MAGIC) ||
+		(ReadUInt32(pData + 4) != indicesCount))
+	{
+		return false;
+	}
+
+	pData += 2 * sizeof(uint32_t);
+
+	uint32_t edgeFifo[MESH_CODEC_FIFO_SIZE][2];
+	uint32_t vertexFifo[MESH_CODEC_FIFO_SIZE];
+	size_t edgeFifoHead = 0;
+	size_t vertexFifoHead = 0;
+	uint32_t nextVertex = 0;
+	bool isValid = true;
+
+	memset(edgeFifo, 0xFF, sizeof(edgeFifo));
+	memset(vertexFifo, 0xFF, sizeof(vertexFifo));
+
+	auto PushEdge = [&](const uint32_t a, const uint32_t b)
+	{
+		edgeFifo[edgeFifoHead & (MESH_CODEC_FIFO_SIZE - 1)][0] = a;
+		edgeFifo[edgeFifoHead & (MESH_CODEC_FIFO_SIZE - 1)][1] = b;
+		edgeFifoHead++;
+	};
+
+	auto PushVertex = [&](const uint32_t v)
+	{
+		vertexFifo[vertexFifoHead & (MESH_CODEC_FIFO_SIZE - 1)] = v;
+		vertexFifoHead++;
+	};
+
+	// decode a vertex by its code: the next new vertex, a recent vertex or an explicit index
+	auto DecodeVertex = [&](const uint8_t code, const uint8_t explicitCode) -> uint32_t
+	{
+		if (code == 0)
+		{
+			PushVertex(nextVertex);
+			return nextVertex++;
+		}
+
+		if (code < explicitCode)
+			return vertexFifo[(vertexFifoHead - code) & (MESH_CODEC_FIFO_SIZE - 1)];
+
+		// read LEB128 of the zigzag encoded difference with the next new vertex
+		uint32_t value = 0;
+
+		for (uint32_t shift = 0; ; shift += 7)
+		{
+			if ((pData >= pDataEnd) || (shift > 28))
+			{
+				isValid = false;
+				return 0;
+			}
+
+			const uint8_t byte = *pData++;
+			value |= (uint32_t)(byte & 0x7F) << shift;
+
+			if (byte < 0x80)
+				break;
+		}
+
+		const uint32_t v = nextVertex + (uint32_t)MeshCodecUnZigZag(value);
+		PushVertex(v);
+		return v;
+	};
+
+	for (size_t it = 0; it + 2 < indicesCount; it += 3)
+	{
+		if (pData >= pDataEnd)
+			return false;
+
+		const uint8_t code = *pData++;
+
+		if (code < MESH_CODEC_NO_EDGE)
+		{
+			// the triangle shares an edge with a recent triangle
+			const uint32_t* pEdge = edgeFifo[(edgeFifoHead - 1 - (code >> 4)) & (MESH_CODEC_FIFO_SIZE - 1)];
+			const uint32_t x = pEdge[0];
+			const uint32_t y = pEdge[1];
+			const uint32_t z = DecodeVertex(code & 0x0F, MESH_CODEC_SHORT_EXPLICIT);
+
+			pDestination[it + 0] = x;
+			pDestination[it + 1] = y;
+			pDestination[it + 2] = z;
+
+			PushEdge(z, y);
+			PushEdge(x, z);
+		}
+		else
+		{
+			uint32_t v[3];
+
+			for (size_t i = 0; i < 3; i++)
+			{
+				if ((pData >= pDataEnd) || (*pData > MESH_CODEC_FULL_EXPLICIT))
+					return false;
+
+				v[i] = DecodeVertex(*pData++, MESH_CODEC_FULL_EXPLICIT);
+			}
+
+			pDestination[it + 0] = v[0];
+			pDestination[it + 1] = v[1];
+			pDestination[it + 2] = v[2];
+
+			PushEdge(v[1], v[0]);
+			PushEdge(v[2], v[1]);
+			PushEdge(v[0], v[2]);
+		}
+
+		if (!isValid)
+			return false;
+	}
+
+	return true;
+}
+
+
+
+// ----------------------------------------------------------------------------------- //
+//
+//                          PRIVATE METHODS / HELPERS
+//
+// ----------------------------------------------------------------------------------- //
+
+// decode groups of the byte plane; returns a pointer to the data after the plane (or nullptr if the data is broken)
+const uint8_t* MeshDecoderClass::DecodeBytePlane(const uint8_t* pData, const uint8_t* pDataEnd, const size_t groupsCount, uint8_t* pPlane)
+{
+	const uint8_t* pModes = pData;
+	const size_t modesSize = (groupsCount + 3) / 4;
+
+	if (pData + modesSize > pDataEnd)
+		return nullptr;
+
+	pData += modesSize;
+
+	for (size_t group = 0; group < groupsCount; group++, pPlane += MESH_CODEC_GROUP_SIZE)
+	{
+		const uint8_t mode = (pModes[group / 4] >> ((group % 4) * 2)) & 3;
+
+		if (mode == MESH_CODEC_GROUP_ZERO)
+		{
+			memset(pPlane, 0, MESH_CODEC_GROUP_SIZE);
+		}
+		else if (mode == MESH_CODEC_GROUP_NIBBLES)
+		{
+			if (pData + MESH_CODEC_GROUP_SIZE / 2 > pDataEnd)
+				return nullptr;
+
+#ifdef MESH_DECODER_SSE2
+			const __m128i packed = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(pData));
+			const __m128i mask = _mm_set1_epi8(0x0F);
+			const __m128i lo = _mm_and_si128(packed, mask);
+			const __m128i hi = _mm_and_si128(_mm_srli_epi16(packed, 4), mask);
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pPlane), _mm_unpacklo_epi8(lo, hi));
+#else
+			for (size_t i = 0; i < MESH_CODEC_GROUP_SIZE / 2; i++)
+			{
+				pPlane[i * 2 + 0] = pData[i] & 0x0F;
+				pPlane[i * 2 + 1] = pData[i] >> 4;
+			}
+#endif
+			pData += MESH_CODEC_GROUP_SIZE / 2;
+		}
+		else if (mode == MESH_CODEC_GROUP_RAW)
+		{
+			if (pData + MESH_CODEC_GROUP_SIZE > pDataEnd)
+				return nullptr;
+
+			memcpy(pPlane, pData, MESH_CODEC_GROUP_SIZE);
+			pData += MESH_CODEC_GROUP_SIZE;
+		}
+		else
+		{
+			return nullptr;
+		}
+	}
+
+	return pData;
+}
+
+
+// combine 4 byte planes into 32-bit words and undo the zigzag encoding
+void MeshDecoderClass::CombineBytePlanes(const uint8_t* pPlanes, const size_t planeSize, const size_t verticesCount, uint32_t* pWords)
+{
+	const uint8_t* pPlane0 = pPlanes;
+	const uint8_t* pPlane1 = pPlanes + planeSize;
+	const uint8_t* pPlane2 = pPlanes + planeSize * 2;
+	const uint8_t* pPlane3 = pPlanes + planeSize * 3;
+
+#ifdef MESH_DECODER_SSE2
+	// the planes are padded up to the whole number of groups so we always handle 16 words at once
+	const __m128i one = _mm_set1_epi32(1);
+	const __m128i zero = _mm_setzero_si128();
+
+	for (size_t i = 0; i < verticesCount; i += MESH_CODEC_GROUP_SIZE)
+	{
+		const __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pPlane0 + i));
+		const __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pPlane1 + i));
+		const __m128i b2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pPlane2 + i));
+		const __m128i b3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pPlane3 + i));
+
+		// transpose bytes: (b0 b1) and (b2 b3) pairs into 16-bit values and then into 32-bit words
+		const __m128i lo01 = _mm_unpacklo_epi8(b0, b1);
+		const __m128i hi01 = _mm_unpackhi_epi8(b0, b1);
+		const __m128i lo23 = _mm_unpacklo_epi8(b2, b3);
+		const __m128i hi23 = _mm_unpackhi_epi8(b2, b3);
+
+		__m128i words[4] =
+		{
+			_mm_unpacklo_epi16(lo01, lo23),
+			_mm_unpackhi_epi16(lo01, lo23),
+			_mm_unpacklo_epi16(hi01, hi23),
+			_mm_unpackhi_epi16(hi01, hi23),
+		};
+
+		for (size_t k = 0; k < 4; k++)
+		{
+			// (z >> 1) ^ -(z & 1)
+			const __m128i sign = _mm_sub_epi32(zero, _mm_and_si128(words[k], one));
+			words[k] = _mm_xor_si128(_mm_srli_epi32(words[k], 1), sign);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pWords + i + k * 4), words[k]);
+		}
+	}
+#else
+	for (size_t i = 0; i < verticesCount; i++)
+	{
+		const uint32_t z =
+			(uint32_t)pPlane0[i] |
+			((uint32_t)pPlane1[i] << 8) |
+			((uint32_t)pPlane2[i] << 16) |
+			((uint32_t)pPlane3[i] << 24);
+
+		pWords[i] = (uint32_t)MeshCodecUnZigZag(z);
+	}
+#endif
+
+	return;
+}
+
+
+// all the numbers of the format are little endian
+uint32_t MeshDecoderClass::ReadUInt32(const uint8_t* pData)
+{
+	return (uint32_t)pData[0] | ((uint32_t)pData[1] << 8) | ((uint32_t)pData[2] << 16) | ((uint32_t)pData[3] << 24);
+}
@@ -0,0 +1,46 @@
+/////////////////////////////////////////////////////////////////////
+// Filename:     MeshDecoderClass.h
+// Description:  a standalone decoder of the compressed vertex/index
+//               streams (see MeshCodec.h for the format); the engine
+//               can build it without the rest of the model converter
+//
+// Created:      19.10.26
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////////////////////////
+// INCLUDES
+//////////////////////////////////
+#include "MeshCodec.h"
+
+
+//////////////////////////////////
+// Class name: MeshDecoderClass
+//////////////////////////////////
+class MeshDecoderClass
+{
+public:
+	struct STREAM_INFO
+	{
+		MESH_CODEC_STREAM_TYPE type = MESH_CODEC_STREAM_POSITIONS;
+		uint32_t elementsCount = 0;
+		uint32_t stride = 0;
+		const uint8_t* pData = nullptr;      // the encoded stream (points into the file's data)
+		size_t dataSize = 0;
+	};
+
+public:
+	// find a stream of the input type in the compressed file's data
+	static bool FindStream(const uint8_t* pFileData, const size_t fileSize, const MESH_CODEC_STREAM_TYPE type, STREAM_INFO & stream);
+
+	// decode vertices into the destination buffer (verticesCount * stride bytes)
+	static bool DecodeVertexStream(void* pDestination, const size_t verticesCount, const size_t stride, const uint8_t* pData, const size_t dataSize);
+
+	// decode triangles into the destination buffer (indicesCount indices)
+	static bool DecodeIndexStream(uint32_t* pDestination, const size_t indicesCount, const uint8_t* pData, const size_t dataSize);
+
+private:
+	static const uint8_t* DecodeBytePlane(const uint8_t* pData, const uint8_t* pDataEnd, const size_t groupsCount, uint8_t* pPlane);
+	static void CombineBytePlanes(const uint8_t* pPlanes, const size_t planeSize, const size_t verticesCount, uint32_t* pWords);
+	static uint32_t ReadUInt32(const uint8_t* pData);
+};
@@ -0,0 +1,267 @@
+#include "MeshEncoderClass.h"
+
+#include <cstring>
+
+
+// ----------------------------------------------------------------------------------- //
+//
+//                          PUBLIC METHODS
+//
+// ----------------------------------------------------------------------------------- //
+
+// encode vertices with the stride which is a multiple of 4 bytes
+void MeshEncoderClass::EncodeVertexStream(const void* pVertices, const size_t verticesCount, const size_t stride, std::vector<uint8_t> & output)
+{
+	const uint8_t* pVertexBytes = static_cast<const uint8_t*>(pVertices);
+	const size_t channelsCount = stride / sizeof(uint32_t);
+	const size_t groupsCount = (verticesCount + MESH_CODEC_GROUP_SIZE - 1) / MESH_CODEC_GROUP_SIZE;
+
+	// byte planes of a single channel (padded with zeros up to the whole number of groups)
+	std::vector<uint8_t> planes(4 * groupsCount * MESH_CODEC_GROUP_SIZE);
+
+	WriteUInt32(MESH_CODEC_VERTEX_MAGIC, output);
+	WriteUInt32((uint32_t)verticesCount, output);
+	WriteUInt32((uint32_t)stride, output);
+
+	for (size_t channel = 0; channel < channelsCount; channel++)
+	{
+		uint32_t prevWord = 0;
+
+		std::fill(planes.begin(), planes.end(), (uint8_t)0);
+
+		// compute zigzag encoded deltas and split them into byte planes
+		for (size_t i = 0; i < verticesCount; i++)
+		{
+			uint32_t word = 0;
+			memcpy(&word, pVertexBytes + i * stride + channel * sizeof(uint32_t), sizeof(uint32_t));
+
+			const uint32_t delta = MeshCodecZigZag((int32_t)(word - prevWord));
+			prevWord = word;
+
+			for (size_t plane = 0; plane < 4; plane++)
+				planes[plane * groupsCount * MESH_CODEC_GROUP_SIZE + i] = (uint8_t)(delta >> (plane * 8));
+		}
+
+		for (size_t plane = 0; plane < 4; plane++)
+			EncodeBytePlane(&planes[plane * groupsCount * MESH_CODEC_GROUP_SIZE], groupsCount, output);
+	}
+
+	return;
+}
+
+
+// encode a list of triangles; a triangle which shares an edge with one of the recent
+// triangles is rotated so this edge goes first and only its third vertex is coded
+void MeshEncoderClass::EncodeIndexStream(const uint32_t* pIndices, const size_t indicesCount, std::vector<uint8_t> & output)
+{
+	uint32_t edgeFifo[MESH_CODEC_FIFO_SIZE][2];
+	uint32_t vertexFifo[MESH_CODEC_FIFO_SIZE];
+	size_t edgeFifoHead = 0;
+	size_t vertexFifoHead = 0;
+	uint32_t nextVertex = 0;
+
+	memset(edgeFifo, 0xFF, sizeof(edgeFifo));
+	memset(vertexFifo, 0xFF, sizeof(vertexFifo));
+
+	auto PushEdge = [&](const uint32_t a, const uint32_t b)
+	{
+		edgeFifo[edgeFifoHead & (MESH_CODEC_FIFO_SIZE - 1)][0] = a;
+		edgeFifo[edgeFifoHead & (MESH_CODEC_FIFO_SIZE - 1)][1] = b;
+		edgeFifoHead++;
+	};
+
+	auto PushVertex = [&](const uint32_t v)
+	{
+		vertexFifo[vertexFifoHead & (MESH_CODEC_FIFO_SIZE - 1)] = v;
+		vertexFifoHead++;
+	};
+
+	// returns an index of the vertex in the fifo (0 -- the most recent one) or -1
+	auto FindVertex = [&](const uint32_t v, const size_t searchCount) -> int
+	{
+		for (size_t i = 0; i < searchCount; i++)
+		{
+			if (vertexFifo[(vertexFifoHead - 1 - i) & (MESH_CODEC_FIFO_SIZE - 1)] == v)
+				return (int)i;
+		}
+		return -1;
+	};
+
+	// code the vertex: the next new vertex, a recent vertex or an explicit index;
+	// returns the code and writes the explicit index (if there is one) into the explicit data
+	auto CodeVertex = [&](const uint32_t v, const uint8_t fifoCount, const uint8_t explicitCode, std::vector<uint8_t> & explicitData) -> uint8_t
+	{
+		if (v == nextVertex)
+		{
+			nextVertex++;
+			PushVertex(v);
+			return 0;
+		}
+
+		const int fifoIdx = FindVertex(v, fifoCount);
+
+		if (fifoIdx != -1)
+			return (uint8_t)(1 + fifoIdx);
+
+		WriteVarUInt32(MeshCodecZigZag((int32_t)(v - nextVertex)), explicitData);
+		PushVertex(v);
+		return explicitCode;
+	};
+
+	std::vector<uint8_t> explicitData;
+
+	WriteUInt32(MESH_CODEC_INDEX_MAGIC, output);
+	WriteUInt32((uint32_t)indicesCount, output);
+
+	for (size_t it = 0; it + 2 < indicesCount; it += 3)
+	{
+		const uint32_t a = pIndices[it + 0];
+		const uint32_t b = pIndices[it + 1];
+		const uint32_t c = pIndices[it + 2];
+		bool isEdgeFound = false;
+
+		explicitData.clear();
+
+		// try to find an edge of the triangle in the edges fifo
+		for (uint8_t edge = 0; (edge < MESH_CODEC_EDGES_IN_FIFO) && !isEdgeFound; edge++)
+		{
+			const uint32_t* pEdge = edgeFifo[(edgeFifoHead - 1 - edge) & (MESH_CODEC_FIFO_SIZE - 1)];
+			const uint32_t x = pEdge[0];
+			const uint32_t y = pEdge[1];
+			uint32_t z = 0;
+
+			if ((x == a) && (y == b)) z = c;
+			else if ((x == b) && (y == c)) z = a;
+			else if ((x == c) && (y == a)) z = b;
+			else continue;
+
+			const uint8_t vertexCode = CodeVertex(z, MESH_CODEC_SHORT_FIFO_COUNT, MESH_CODEC_SHORT_EXPLICIT, explicitData);
+
+			output.push_back((uint8_t)((edge << 4) | vertexCode));
+			output.insert(output.end(), explicitData.begin(), explicitData.end());
+
+			// the neighbouring triangles go through the new edges in the opposite direction
+			PushEdge(z, y);
+			PushEdge(x, z);
+			isEdgeFound = true;
+		}
+
+		if (isEdgeFound)
+			continue;
+
+		// there is no shared edge so code all the 3 vertices
+		output.push_back(MESH_CODEC_NO_EDGE);
+
+		for (const uint32_t v : { a, b, c })
+		{
+			explicitData.clear();
+			output.push_back(CodeVertex(v, MESH_CODEC_FULL_FIFO_COUNT, MESH_CODEC_FULL_EXPLICIT, explicitData));
+			output.insert(output.end(), explicitData.begin(), explicitData.end());
+		}
+
+		PushEdge(b, a);
+		PushEdge(c, b);
+		PushEdge(a, c);
+	}
+
+	return;
+}
+
+
+// append a stream into the compressed file's data (the file header is written with the first stream)
+void MeshEncoderClass::AppendStreamIntoFile(const MESH_CODEC_STREAM_TYPE type,
+	const size_t elementsCount,
+	const size_t stride,
+	const std::vector<uint8_t> & encodedStream,
+	std::vector<uint8_t> & fileData)
+{
+	const size_t streamsCountOffset = 2 * sizeof(uint32_t);
+
+	if (fileData.empty())
+	{
+		WriteUInt32(MESH_CODEC_FILE_MAGIC, fileData);
+		WriteUInt32(MESH_CODEC_FILE_VERSION, fileData);
+		WriteUInt32(0, fileData);
+	}
+
+	// increase the number of streams in the header (the number is less than 256)
+	fileData[streamsCountOffset]++;
+
+	WriteUInt32((uint32_t)type, fileData);
+	WriteUInt32((uint32_t)elementsCount, fileData);
+	WriteUInt32((uint32_t)stride, fileData);
+	WriteUInt32((uint32_t)encodedStream.size(), fileData);
+	fileData.insert(fileData.end(), encodedStream.begin(), encodedStream.end());
+
+	return;
+}
+
+
+
+// ----------------------------------------------------------------------------------- //
+//
+//                          PRIVATE METHODS / HELPERS
+//
+// ----------------------------------------------------------------------------------- //
+
+// write 2-bit modes of all the groups of the byte plane and then data of the groups
+void MeshEncoderClass::EncodeBytePlane(const uint8_t* pPlane, const size_t groupsCount, std::vector<uint8_t> & output)
+{
+	const size_t modesOffset = output.size();
+
+	output.resize(output.size() + (groupsCount + 3) / 4, 0);
+
+	for (size_t group = 0; group < groupsCount; group++)
+	{
+		const uint8_t* pGroup = pPlane + group * MESH_CODEC_GROUP_SIZE;
+		uint8_t maxByte = 0;
+
+		for (size_t i = 0; i < MESH_CODEC_GROUP_SIZE; i++)
+			maxByte |= pGroup[i];
+
+		uint8_t mode = MESH_CODEC_GROUP_RAW;
+
+		if (maxByte == 0)
+		{
+			mode = MESH_CODEC_GROUP_ZERO;
+		}
+		else if (maxByte < 16)
+		{
+			mode = MESH_CODEC_GROUP_NIBBLES;
+
+			for (size_t i = 0; i < MESH_CODEC_GROUP_SIZE; i += 2)
+				output.push_back((uint8_t)(pGroup[i] | (pGroup[i + 1] << 4)));
+		}
+		else
+		{
+			output.insert(output.end(), pGroup, pGroup + MESH_CODEC_GROUP_SIZE);
+		}
+
+		output[modesOffset + group / 4] |= (uint8_t)(mode << ((group % 4) * 2));
+	}
+
+	return;
+}
+
+
+// all the numbers of the format are little endian
+void MeshEncoderClass::WriteUInt32(const uint32_t value, std::vector<uint8_t> & output)
+{
+	output.push_back((uint8_t)(value));
+	output.push_back((uint8_t)(value >> 8));
+	output.push_back((uint8_t)(value >> 16));
+	output.push_back((uint8_t)(value >> 24));
+}
+
+
+// LEB128: 7 bits per byte, the high bit means that there are more bytes
+void MeshEncoderClass::WriteVarUInt32(uint32_t value, std::vector<uint8_t> & output)
+{
+	while (value >= 0x80)
+	{
+		output.push_back((uint8_t)(value | 0x80));
+		value >>= 7;
+	}
+
+	output.push_back((uint8_t)value);
+}
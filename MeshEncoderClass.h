@@ -0,0 +1,42 @@
+/////////////////////////////////////////////////////////////////////
+// Filename:     MeshEncoderClass.h
+// Description:  encodes vertex/index buffers of the mesh into the
+//               compressed streams (see MeshCodec.h for the format);
+//               they are decoded in the engine with MeshDecoderClass
+//
+// Created:      19.10.26
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////////////////////////
+// INCLUDES
+//////////////////////////////////
+#include "MeshCodec.h"
+
+#include <vector>
+
+
+//////////////////////////////////
+// Class name: MeshEncoderClass
+//////////////////////////////////
+class MeshEncoderClass
+{
+public:
+	// encode vertices with the stride which is a multiple of 4 bytes
+	static void EncodeVertexStream(const void* pVertices, const size_t verticesCount, const size_t stride, std::vector<uint8_t> & output);
+
+	// encode a list of triangles (the decoded triangles may have rotated vertices but the winding order is the same)
+	static void EncodeIndexStream(const uint32_t* pIndices, const size_t indicesCount, std::vector<uint8_t> & output);
+
+	// append a stream into the compressed file's data (the file header is written with the first stream)
+	static void AppendStreamIntoFile(const MESH_CODEC_STREAM_TYPE type,
+		const size_t elementsCount,
+		const size_t stride,
+		const std::vector<uint8_t> & encodedStream,
+		std::vector<uint8_t> & fileData);
+
+private:
+	static void EncodeBytePlane(const uint8_t* pPlane, const size_t groupsCount, std::vector<uint8_t> & output);
+	static void WriteUInt32(const uint32_t value, std::vector<uint8_t> & output);
+	static void WriteVarUInt32(uint32_t value, std::vector<uint8_t> & output);
+};
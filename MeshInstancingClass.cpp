@@ -0,0 +1,505 @@
+#include "MeshInstancingClass.h"
+#include "ParallelFor.h"
+#include "TraceRecorderClass.h"
+
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <unordered_map>
+
+
+// ----------------------------------------------------------------------------------- //
+//
+//                          PUBLIC METHODS
+//
+// ----------------------------------------------------------------------------------- //
+
+// split the mesh into pieces by groups/objects and find the congruent ones;
+// each piece becomes an instance (of a new or of an already found prototype)
+bool MeshInstancingClass::Run(const MeshData & mesh, const ConversionOptions & options,
+	std::vector<INSTANCE_PROTOTYPE> & prototypes,
+	std::vector<MESH_INSTANCE> & instances)
+{
+	TRACE_SCOPE("DetectInstances");
+
+	if (!(options.instanceTolerance >= 0.0f))
+	{
+		Log::Error(LOG_MACRO, "the instancing tolerance must be >= 0");
+		return false;
+	}
+
+	tolerance_ = options.instanceTolerance;
+	flattenedSize_ = 0;
+	instancedSize_ = 0;
+	prototypes.clear();
+	instances.clear();
+
+	// a piece is all the submeshes of the same group/object (in the order of their first usage);
+	// the submeshes without faces (e.g. all of them are removed by the cleaner) aren't a part of
+	// any piece so a group without faces doesn't become an empty prototype
+	std::vector<std::string> groupsNames;
+	std::vector<std::vector<UINT>> groupsSubmeshes;
+	std::map<std::string, size_t> groupsLookup;
+
+	for (size_t idx = 0; idx < mesh.submeshes.size(); idx++)
+	{
+		if (mesh.submeshes[idx].indexCount == 0)
+			continue;
+
+		const std::string & groupName = mesh.submeshes[idx].groupName;
+		const auto result = groupsLookup.insert({ groupName, groupsNames.size() });
+
+		if (result.second)
+		{
+			groupsNames.push_back(groupName);
+			groupsSubmeshes.push_back({});
+		}
+
+		groupsSubmeshes[result.first->second].push_back((UINT)idx);
+	}
+
+	// move each piece into its canonical frame (each piece is handled by a single thread)
+	std::vector<CANONICAL_PIECE> pieces(groupsNames.size());
+
+	ParallelFor(pieces.size(), 1, [&](size_t begin, size_t end, size_t)
+	{
+		for (size_t idx = begin; idx < end; idx++)
+		{
+			this->CollectPiece(mesh, groupsSubmeshes[idx], pieces[idx]);
+			this->Canonicalize(pieces[idx]);
+		}
+	});
+
+	// match the pieces with the prototypes which have the same hash (in the order
+	// of pieces so the first piece of each shape becomes its prototype)
+	std::unordered_map<uint64_t, std::vector<UINT>> prototypesLookup;
+	std::vector<size_t> prototypesPieces;
+
+	for (size_t idx = 0; idx < pieces.size(); idx++)
+	{
+		CANONICAL_PIECE & piece = pieces[idx];
+		std::vector<UINT> & candidates = prototypesLookup[piece.hash];
+
+		MESH_INSTANCE instance;
+		instance.groupName = groupsNames[idx];
+		instance.prototypeIndex = UINT_MAX;
+
+		for (const UINT prototypeIdx : candidates)
+		{
+			if (IsCongruent(piece, pieces[prototypesPieces[prototypeIdx]], tolerance_))
+			{
+				instance.prototypeIndex = prototypeIdx;
+				break;
+			}
+		}
+
+		// this piece has a new shape
+		if (instance.prototypeIndex == UINT_MAX)
+		{
+			instance.prototypeIndex = (UINT)prototypesPieces.size();
+			candidates.push_back(instance.prototypeIndex);
+			prototypesPieces.push_back(idx);
+		}
+
+		pieces[prototypesPieces[instance.prototypeIndex]].geometry.instancesCount++;
+
+		// the transpose of the axes rotates the prototype's frame back into the mesh
+		const float centroid[3] = { piece.centroid.x, piece.centroid.y, piece.centroid.z };
+
+		for (size_t row = 0; row < 3; row++)
+		{
+			for (size_t col = 0; col < 3; col++)
+				instance.transform[row][col] = piece.axes[col][row];
+
+			instance.transform[row][3] = centroid[row];
+		}
+
+		flattenedSize_ += GetGeometrySize(piece.geometry);
+		instances.push_back(instance);
+	}
+
+	// the geometry of the first piece of each shape is its prototype
+	prototypes.reserve(prototypesPieces.size());
+
+	for (const size_t pieceIdx : prototypesPieces)
+	{
+		instancedSize_ += GetGeometrySize(pieces[pieceIdx].geometry);
+		prototypes.push_back(std::move(pieces[pieceIdx].geometry));
+	}
+
+	instancedSize_ += instances.size() * sizeof(MESH_INSTANCE::transform);
+
+	Log::Print("instancing: %u pieces, %u unique; %u bytes instead of %u (%u bytes saved)",
+		(UINT)instances.size(),
+		(UINT)prototypes.size(),
+		(UINT)instancedSize_,
+		(UINT)flattenedSize_,
+		(UINT)((flattenedSize_ > instancedSize_) ? flattenedSize_ - instancedSize_ : 0));
+
+	return true;
+}
+
+
+
+// ----------------------------------------------------------------------------------- //
+//
+//                          PRIVATE METHODS / HELPERS
+//
+// ----------------------------------------------------------------------------------- //
+
+// gather the faces of the submeshes into compact buffers of the piece: the unique
+// (position, texture coords) pairs get local indices in the order of their first usage
+void MeshInstancingClass::CollectPiece(const MeshData & mesh, const std::vector<UINT> & submeshesIndices, CANONICAL_PIECE & piece) const
+{
+	INSTANCE_PROTOTYPE & geometry = piece.geometry;
+	std::unordered_map<uint64_t, UINT> localIndices;
+
+	for (const UINT submeshIdx : submeshesIndices)
+	{
+		const SUBMESH & submesh = mesh.submeshes[submeshIdx];
+
+		// the submeshes of the group have different materials
+		PROTOTYPE_SUBMESH prototypeSubmesh;
+		prototypeSubmesh.materialIndex = submesh.materialIndex;
+		prototypeSubmesh.indexOffset = geometry.indices.size();
+		prototypeSubmesh.indexCount = submesh.indexCount;
+		geometry.submeshes.push_back(prototypeSubmesh);
+
+		for (size_t it = submesh.indexOffset; it < submesh.indexOffset + submesh.indexCount; it++)
+		{
+			const UINT vertexIndex = mesh.vertexIndices[it];
+			const UINT textureIndex = mesh.textureIndices[it];
+			const uint64_t key = ((uint64_t)vertexIndex << 32) | textureIndex;
+
+			const auto result = localIndices.insert({ key, (UINT)geometry.vertices.size() });
+
+			// a new unique vertex of the piece (invalid indices give zero attributes)
+			if (result.second)
+			{
+				geometry.vertices.push_back((vertexIndex < mesh.vertices.size()) ? mesh.vertices[vertexIndex] : VERTEX3D());
+				geometry.texCoords.push_back((textureIndex < mesh.texCoords.size()) ? mesh.texCoords[textureIndex] : TEXTURE_COORDS());
+			}
+
+			geometry.indices.push_back(result.first->second);
+		}
+	}
+
+	return;
+}
+
+
+// move the piece into its canonical frame: the origin is the centroid of its vertices
+// and the axes are its principal axes (by the covariance of the vertices); the signs of
+// the axes are defined by the first vertices (copies keep the order of their vertices)
+void MeshInstancingClass::Canonicalize(CANONICAL_PIECE & piece) const
+{
+	std::vector<VERTEX3D> & vertices = piece.geometry.vertices;
+	const size_t verticesCount = vertices.size();
+
+	// the centroid and the covariance matrix of the vertices
+	double centroid[3] = { 0.0, 0.0, 0.0 };
+	double covariance[3][3] = { { 0.0 } };
+
+	for (const VERTEX3D & vertex : vertices)
+	{
+		centroid[0] += vertex.x;
+		centroid[1] += vertex.y;
+		centroid[2] += vertex.z;
+	}
+
+	for (size_t axis = 0; axis < 3; axis++)
+		centroid[axis] /= (double)(std::max)(verticesCount, (size_t)1);
+
+	std::vector<double> offsets(verticesCount * 3);
+	double radius = 0.0;
+
+	for (size_t idx = 0; idx < verticesCount; idx++)
+	{
+		double* d = &offsets[idx * 3];
+		d[0] = vertices[idx].x - centroid[0];
+		d[1] = vertices[idx].y - centroid[1];
+		d[2] = vertices[idx].z - centroid[2];
+
+		for (size_t row = 0; row < 3; row++)
+			for (size_t col = 0; col < 3; col++)
+				covariance[row][col] += d[row] * d[col];
+
+		radius = (std::max)(radius, std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]));
+	}
+
+	double axes[3][3];
+	double eigenvalues[3];
+	ComputeEigenvectors(covariance, axes, eigenvalues);
+
+	// returns the first vertex which is further from the origin than the threshold along the direction
+	// (or farther from the line along the direction if it is perpendicular)
+	const double threshold = radius * 0.01;
+
+	auto Dot = [](const double* a, const double* b) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; };
+	auto Cross = [](const double* a, const double* b, double* result)
+	{
+		result[0] = a[1] * b[2] - a[2] * b[1];
+		result[1] = a[2] * b[0] - a[0] * b[2];
+		result[2] = a[0] * b[1] - a[1] * b[0];
+	};
+	auto Normalize = [&Dot](double* a)
+	{
+		const double length = std::sqrt(Dot(a, a));
+
+		if (length > 0.0)
+			for (size_t i = 0; i < 3; i++)
+				a[i] /= length;
+	};
+
+	const double gap = eigenvalues[0] * EIGENVALUES_GAP_;
+	const bool hasDistinctAxes = (eigenvalues[0] - eigenvalues[1] > gap) && (eigenvalues[1] - eigenvalues[2] > gap);
+
+	if (hasDistinctAxes)
+	{
+		// the principal axes are defined up to their signs: make the first vertex
+		// which isn't close to the plane of the axis to have a positive coordinate
+		for (size_t axis = 0; axis < 2; axis++)
+		{
+			for (size_t idx = 0; idx < verticesCount; idx++)
+			{
+				const double projection = Dot(&offsets[idx * 3], axes[axis]);
+
+				if (std::abs(projection) > threshold)
+				{
+					if (projection < 0.0)
+						for (size_t i = 0; i < 3; i++)
+							axes[axis][i] = -axes[axis][i];
+					break;
+				}
+			}
+		}
+	}
+	else
+	{
+		// a symmetric piece (like a cube or a sphere) has ambiguous principal axes so we
+		// take the first vertex which is far from the centroid as the first axis and the
+		// next vertex which is far from the first axis as the second one
+		double first[3] = { 1.0, 0.0, 0.0 };
+		double second[3] = { 0.0, 0.0, 0.0 };
+		size_t idx = 0;
+
+		for (; idx < verticesCount; idx++)
+		{
+			if (std::sqrt(Dot(&offsets[idx * 3], &offsets[idx * 3])) > threshold)
+			{
+				memcpy(first, &offsets[idx * 3], sizeof(first));
+				break;
+			}
+		}
+
+		Normalize(first);
+
+		for (; idx < verticesCount; idx++)
+		{
+			const double* d = &offsets[idx * 3];
+			const double projection = Dot(d, first);
+			const double perpendicular[3] = { d[0] - first[0] * projection, d[1] - first[1] * projection, d[2] - first[2] * projection };
+
+			if (std::sqrt(Dot(perpendicular, perpendicular)) > threshold)
+			{
+				memcpy(second, perpendicular, sizeof(second));
+				break;
+			}
+		}
+
+		// all the vertices are on a single line so any perpendicular axis will do
+		if (Dot(second, second) == 0.0)
+		{
+			const double basisAxis[3] = { (std::abs(first[0]) < 0.5) ? 1.0 : 0.0, (std::abs(first[0]) < 0.5) ? 0.0 : 1.0, 0.0 };
+			double third[3];
+
+			Cross(first, basisAxis, third);
+			Cross(third, first, second);
+		}
+
+		Normalize(second);
+		memcpy(axes[0], first, sizeof(first));
+		memcpy(axes[1], second, sizeof(second));
+	}
+
+	// the third axis keeps the frame right handed (so the transform is a rotation)
+	Cross(axes[0], axes[1], axes[2]);
+	Normalize(axes[2]);
+
+	// move the vertices into the canonical frame
+	for (size_t idx = 0; idx < verticesCount; idx++)
+	{
+		const double* d = &offsets[idx * 3];
+
+		vertices[idx].x = (float)Dot(axes[0], d);
+		vertices[idx].y = (float)Dot(axes[1], d);
+		vertices[idx].z = (float)Dot(axes[2], d);
+	}
+
+	piece.centroid = { (float)centroid[0], (float)centroid[1], (float)centroid[2] };
+	piece.radius = (float)radius;
+	piece.hash = ComputeHash(piece.geometry);
+
+	for (size_t row = 0; row < 3; row++)
+		for (size_t col = 0; col < 3; col++)
+			piece.axes[row][col] = (float)axes[row][col];
+
+	return;
+}
+
+
+// hash of everything which must be the same in the congruent pieces except of the
+// positions (the positions are compared with the tolerance so they can't be hashed)
+uint64_t MeshInstancingClass::ComputeHash(const INSTANCE_PROTOTYPE & geometry)
+{
+	uint64_t hash = 0xcbf29ce484222325ULL;
+
+	auto Mix = [&hash](const uint64_t value)
+	{
+		hash = (hash ^ value) * 0x100000001b3ULL;
+		hash ^= hash >> 29;
+	};
+
+	Mix(geometry.vertices.size());
+
+	for (const UINT index : geometry.indices)
+		Mix(index);
+
+	for (const PROTOTYPE_SUBMESH & submesh : geometry.submeshes)
+	{
+		Mix(submesh.materialIndex);
+		Mix(submesh.indexCount);
+	}
+
+	for (const TEXTURE_COORDS & texCoords : geometry.texCoords)
+	{
+		uint64_t bits = 0;
+		memcpy(&bits, &texCoords, (std::min)(sizeof(bits), sizeof(texCoords)));
+		Mix(bits);
+	}
+
+	return hash;
+}
+
+
+// the pieces are congruent if they have the same topology, texture coords and materials
+// and their vertices in the canonical frames are within the tolerance of each other
+bool MeshInstancingClass::IsCongruent(const CANONICAL_PIECE & piece, const CANONICAL_PIECE & prototype, const float tolerance)
+{
+	const INSTANCE_PROTOTYPE & a = piece.geometry;
+	const INSTANCE_PROTOTYPE & b = prototype.geometry;
+
+	if ((a.vertices.size() != b.vertices.size()) ||
+		(a.indices != b.indices) ||
+		(a.submeshes.size() != b.submeshes.size()) ||
+		(!a.texCoords.empty() && memcmp(a.texCoords.data(), b.texCoords.data(), a.texCoords.size() * sizeof(TEXTURE_COORDS)) != 0))
+	{
+		return false;
+	}
+
+	for (size_t idx = 0; idx < a.submeshes.size(); idx++)
+	{
+		if ((a.submeshes[idx].materialIndex != b.submeshes[idx].materialIndex) ||
+			(a.submeshes[idx].indexCount != b.submeshes[idx].indexCount))
+		{
+			return false;
+		}
+	}
+
+	const float maxDistance = tolerance * (std::max)(piece.radius, prototype.radius);
+	const float maxSquaredDistance = maxDistance * maxDistance;
+
+	for (size_t idx = 0; idx < a.vertices.size(); idx++)
+	{
+		const float dx = a.vertices[idx].x - b.vertices[idx].x;
+		const float dy = a.vertices[idx].y - b.vertices[idx].y;
+		const float dz = a.vertices[idx].z - b.vertices[idx].z;
+
+		if (dx * dx + dy * dy + dz * dz > maxSquaredDistance)
+			return false;
+	}
+
+	return true;
+}
+
+
+// the cyclic Jacobi method; the eigenvectors (rows of the axes) are sorted
+// by their eigenvalues in the decreasing order
+void MeshInstancingClass::ComputeEigenvectors(const double matrix[3][3], double axes[3][3], double eigenvalues[3])
+{
+	double a[3][3];
+	double v[3][3] = { { 1.0, 0.0, 0.0 }, { 0.0, 1.0, 0.0 }, { 0.0, 0.0, 1.0 } };
+
+	memcpy(a, matrix, sizeof(a));
+
+	for (int sweep = 0; sweep < 50; sweep++)
+	{
+		const double offDiagonal = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+		const double diagonal = a[0][0] * a[0][0] + a[1][1] * a[1][1] + a[2][2] * a[2][2];
+
+		if (offDiagonal <= diagonal * 1e-30)
+			break;
+
+		for (int p = 0; p < 2; p++)
+		{
+			for (int q = p + 1; q < 3; q++)
+			{
+				if (a[p][q] == 0.0)
+					continue;
+
+				// the rotation which zeroes a[p][q]
+				const double theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+				const double t = ((theta >= 0.0) ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+				const double c = 1.0 / std::sqrt(t * t + 1.0);
+				const double s = t * c;
+
+				for (int k = 0; k < 3; k++)
+				{
+					const double akp = a[k][p];
+					const double akq = a[k][q];
+					a[k][p] = c * akp - s * akq;
+					a[k][q] = s * akp + c * akq;
+				}
+
+				for (int k = 0; k < 3; k++)
+				{
+					const double apk = a[p][k];
+					const double aqk = a[q][k];
+					a[p][k] = c * apk - s * aqk;
+					a[q][k] = s * apk + c * aqk;
+				}
+
+				for (int k = 0; k < 3; k++)
+				{
+					const double vkp = v[k][p];
+					const double vkq = v[k][q];
+					v[k][p] = c * vkp - s * vkq;
+					v[k][q] = s * vkp + c * vkq;
+				}
+			}
+		}
+	}
+
+	// the columns of v are the eigenvectors
+	int order[3] = { 0, 1, 2 };
+	std::sort(order, order + 3, [&a](const int i, const int j) { return a[i][i] > a[j][j]; });
+
+	for (int row = 0; row < 3; row++)
+	{
+		eigenvalues[row] = a[order[row]][order[row]];
+
+		for (int col = 0; col < 3; col++)
+			axes[row][col] = v[col][order[row]];
+	}
+
+	return;
+}
+
+
+// how many bytes the vertices and indices of the geometry take
+size_t MeshInstancingClass::GetGeometrySize(const INSTANCE_PROTOTYPE & geometry)
+{
+	return geometry.vertices.size() * (sizeof(VERTEX3D) + sizeof(TEXTURE_COORDS)) +
+		geometry.indices.size() * sizeof(UINT);
+}
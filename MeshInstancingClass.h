@@ -0,0 +1,93 @@
+/////////////////////////////////////////////////////////////////////
+// Filename:     MeshInstancingClass.h
+// Description:  finds repeated sub-objects of the mesh (the same bolt
+//               or tree copied many times with different transforms):
+//               the mesh is split into pieces by groups/objects, each
+//               piece is moved into its canonical frame (its centroid
+//               and principal axes) and pieces which have the same
+//               canonical geometry are the instances of one prototype
+//
+// Created:      19.10.26
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////////////////////////
+// INCLUDES
+//////////////////////////////////
+#include "MeshData.h"
+#include "ConversionOptions.h"
+#include "Log.h"       // for using the log system
+
+
+// a range of faces of the prototype with the same material
+struct PROTOTYPE_SUBMESH
+{
+	UINT materialIndex = 0;
+	size_t indexOffset = 0;              // the first index of the range in the prototype's indices
+	size_t indexCount = 0;
+};
+
+// the unique geometry of a piece in its canonical frame
+struct INSTANCE_PROTOTYPE
+{
+	std::vector<VERTEX3D> vertices;      // unique (position, texture coords) pairs of the piece
+	std::vector<TEXTURE_COORDS> texCoords;
+	std::vector<UINT> indices;           // local indices (the faces winding order is the same as in the mesh data)
+	std::vector<PROTOTYPE_SUBMESH> submeshes;
+	size_t instancesCount = 0;
+};
+
+// a piece of the mesh as an instance of the prototype
+struct MESH_INSTANCE
+{
+	std::string groupName{ "" };
+	UINT prototypeIndex = 0;
+	float transform[3][4];               // rows of the 3x4 matrix (rotation | translation) from the prototype's frame into the mesh
+};
+
+
+//////////////////////////////////
+// Class name: MeshInstancingClass
+//////////////////////////////////
+class MeshInstancingClass
+{
+public:
+	// split the mesh into pieces by groups/objects and find the congruent ones;
+	// each piece becomes an instance (of a new or of an already found prototype)
+	bool Run(const MeshData & mesh, const ConversionOptions & options,
+		std::vector<INSTANCE_PROTOTYPE> & prototypes,
+		std::vector<MESH_INSTANCE> & instances);
+
+	// how many bytes the vertices and indices of all the pieces take with and without instancing
+	size_t GetFlattenedSize() const { return flattenedSize_; }
+	size_t GetInstancedSize() const { return instancedSize_; }
+
+private:
+	// the piece of the mesh in its canonical frame
+	struct CANONICAL_PIECE
+	{
+		INSTANCE_PROTOTYPE geometry;
+		VERTEX3D centroid;
+		float axes[3][3];                    // rows are the principal axes (the rotation from the mesh into the canonical frame)
+		float radius = 0.0f;                 // max distance from the centroid to the piece's vertices
+		uint64_t hash = 0;                   // hash of the topology, texture coords and materials
+	};
+
+	void CollectPiece(const MeshData & mesh, const std::vector<UINT> & submeshesIndices, CANONICAL_PIECE & piece) const;
+	void Canonicalize(CANONICAL_PIECE & piece) const;
+	static uint64_t ComputeHash(const INSTANCE_PROTOTYPE & geometry);
+	static bool IsCongruent(const CANONICAL_PIECE & piece, const CANONICAL_PIECE & prototype, const float tolerance);
+
+	// find eigenvectors (rows of the axes) and eigenvalues of the symmetric 3x3 matrix
+	static void ComputeEigenvectors(const double matrix[3][3], double axes[3][3], double eigenvalues[3]);
+
+	static size_t GetGeometrySize(const INSTANCE_PROTOTYPE & geometry);
+
+private:
+	float tolerance_ = 0.0f;
+	size_t flattenedSize_ = 0;
+	size_t instancedSize_ = 0;
+
+	// constants
+	static constexpr double EIGENVALUES_GAP_ = 1e-3;          // principal axes with closer eigenvalues are ambiguous
+};
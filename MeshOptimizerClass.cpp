@@ -0,0 +1,249 @@
+#include "MeshOptimizerClass.h"
+#include "MeshValidatorClass.h"
+#include "MeshCleanerClass.h"
+#include "MeshAdjacencyClass.h"
+#include "MeshAmbientOcclusionClass.h"
+#include "TraceRecorderClass.h"
+
+#include <cfloat>
+#include <numeric>
+#include <algorithm>
+
+
+MeshOptimizerClass::MeshOptimizerClass(const ConversionOptions & options)
+	: options_(options)
+{
+}
+
+
+// execute all the processing stages over the mesh data
+bool MeshOptimizerClass::Run(MeshData & mesh)
+{
+	TRACE_SCOPE("OptimizeMesh");
+	TRACE_ARG("faces", mesh.GetFacesCount());
+
+	// check indices and attributes values (and clamp/drop the invalid ones if the options say so)
+	if (options_.validateMesh && !MeshValidatorClass().Run(mesh, options_))
+	{
+		Log::Error(LOG_MACRO, "can't validate the mesh data");
+		return false;
+	}
+
+	// weld vertices and remove degenerate/duplicate triangles
+	if (!MeshCleanerClass().Run(mesh, options_))
+	{
+		Log::Error(LOG_MACRO, "can't clean up the mesh data");
+		return false;
+	}
+
+	// make each material a contiguous range of faces so the engine can render it with a single draw call
+	this->SortFacesByMaterial(mesh);
+	this->ComputeSubmeshesBounds(mesh);
+	this->ChooseIndexFormat(mesh);
+
+	Log::Debug(LOG_MACRO, "SUBMESHES COUNT: " + std::to_string(mesh.submeshes.size()));
+	Log::Debug(LOG_MACRO, "MATERIALS COUNT: " + std::to_string(mesh.materialsNames.size()));
+
+	// compute the optional adjacency/edges data by the final order of faces
+	if (!MeshAdjacencyClass().Run(mesh, options_))
+	{
+		Log::Error(LOG_MACRO, "can't compute the adjacency data");
+		return false;
+	}
+
+	// bake the per-vertex ambient occlusion by the final (welded) positions
+	if (options_.bakeAmbientOcclusion && !MeshAmbientOcclusionClass().Run(mesh, options_))
+	{
+		Log::Error(LOG_MACRO, "can't bake the ambient occlusion");
+		return false;
+	}
+
+	return true;
+}
+
+
+// sort faces so each material is a contiguous range of faces (and each submesh 
+// is a contiguous range inside of its material's range); the order of faces
+// inside of each submesh stays the same as in the input file
+void MeshOptimizerClass::SortFacesByMaterial(MeshData & mesh)
+{
+	TRACE_SCOPE("SortFacesByMaterial");
+
+	const size_t submeshesCount = mesh.submeshes.size();
+	const size_t facesCount = mesh.faceSubmeshIndices.size();
+
+	// define the order of submeshes: by the material, and then by the first usage of the submesh
+	std::vector<UINT> submeshesOrder(submeshesCount);
+	std::iota(submeshesOrder.begin(), submeshesOrder.end(), 0);
+	std::stable_sort(submeshesOrder.begin(), submeshesOrder.end(), [&mesh](UINT a, UINT b)
+	{
+		return mesh.submeshes[a].materialIndex < mesh.submeshes[b].materialIndex;
+	});
+
+	// calculate the number of faces in each submesh
+	std::vector<size_t> facesPerSubmesh(submeshesCount, 0);
+
+	for (const UINT submeshIdx : mesh.faceSubmeshIndices)
+		facesPerSubmesh[submeshIdx]++;
+
+	// calculate the first face of each submesh in the sorted faces array
+	std::vector<size_t> nextFace(submeshesCount, 0);
+	size_t facesOffset = 0;
+
+	for (const UINT submeshIdx : submeshesOrder)
+	{
+		nextFace[submeshIdx] = facesOffset;
+		mesh.submeshes[submeshIdx].indexOffset = facesOffset * 3;                  // each face has 3 vertices
+		mesh.submeshes[submeshIdx].indexCount = facesPerSubmesh[submeshIdx] * 3;
+		facesOffset += facesPerSubmesh[submeshIdx];
+	}
+
+	// put faces into their places in the sorted arrays
+	std::vector<UINT> sortedVertexIndices(facesCount * 3);
+	std::vector<UINT> sortedTextureIndices(facesCount * 3);
+
+	for (size_t face = 0; face < facesCount; face++)
+	{
+		const size_t src = face * 3;
+		const size_t dst = (nextFace[mesh.faceSubmeshIndices[face]]++) * 3;
+
+		for (size_t vertex = 0; vertex < 3; vertex++)
+		{
+			sortedVertexIndices[dst + vertex] = mesh.vertexIndices[src + vertex];
+			sortedTextureIndices[dst + vertex] = mesh.textureIndices[src + vertex];
+		}
+	}
+
+	mesh.vertexIndices = std::move(sortedVertexIndices);
+	mesh.textureIndices = std::move(sortedTextureIndices);
+
+	// reorder the submeshes table according to the new order of faces
+	std::vector<SUBMESH> sortedSubmeshes;
+	sortedSubmeshes.reserve(submeshesCount);
+
+	for (const UINT submeshIdx : submeshesOrder)
+		sortedSubmeshes.push_back(mesh.submeshes[submeshIdx]);
+
+	mesh.submeshes = std::move(sortedSubmeshes);
+
+	// faces are sorted now so the per-face submesh indices and source lines aren't valid anymore
+	mesh.faceSubmeshIndices.clear();
+	mesh.faceSourceLines.clear();
+
+	return;
+}
+
+
+// compute an axis-aligned bounding box of each submesh
+void MeshOptimizerClass::ComputeSubmeshesBounds(MeshData & mesh)
+{
+	TRACE_SCOPE("ComputeSubmeshesBounds");
+
+	for (SUBMESH & submesh : mesh.submeshes)
+	{
+		submesh.aabbMin = { FLT_MAX, FLT_MAX, FLT_MAX };
+		submesh.aabbMax = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+		for (size_t i = submesh.indexOffset; i < submesh.indexOffset + submesh.indexCount; i++)
+		{
+			const UINT vertexIndex = mesh.vertexIndices[i];
+
+			// skip invalid indices
+			if (vertexIndex >= mesh.vertices.size())
+				continue;
+
+			const VERTEX3D & v = mesh.vertices[vertexIndex];
+
+			submesh.aabbMin = { (std::min)(submesh.aabbMin.x, v.x), (std::min)(submesh.aabbMin.y, v.y), (std::min)(submesh.aabbMin.z, v.z) };
+			submesh.aabbMax = { (std::max)(submesh.aabbMax.x, v.x), (std::max)(submesh.aabbMax.y, v.y), (std::max)(submesh.aabbMax.z, v.z) };
+		}
+
+		// the submesh doesn't have any valid vertex
+		if (submesh.aabbMin.x > submesh.aabbMax.x)
+		{
+			submesh.aabbMin = { 0.0f, 0.0f, 0.0f };
+			submesh.aabbMax = { 0.0f, 0.0f, 0.0f };
+		}
+	}
+
+	return;
+}
+
+
+// choose the narrowest index format: 16-bit indices if the whole mesh has at most 65536
+// vertices and texture coords and all the indices are less than 65536 (invalid indices
+// survive when the validation keeps them); otherwise 16-bit indices relative to the base vertex of
+// each submesh if each submesh refers to a range of at most 65536 vertices/texture coords;
+// otherwise 32-bit indices
+void MeshOptimizerClass::ChooseIndexFormat(MeshData & mesh)
+{
+	TRACE_SCOPE("ChooseIndexFormat");
+
+	for (SUBMESH & submesh : mesh.submeshes)
+	{
+		submesh.baseVertex = 0;
+		submesh.baseTexCoord = 0;
+	}
+
+	mesh.indexFormat = INDEX_FORMAT_UINT32;
+
+	if (!options_.allow16BitIndices)
+		return;
+
+	auto GetMaxIndex = [](const std::vector<UINT> & indices) -> UINT
+	{
+		return indices.empty() ? 0 : *std::max_element(indices.begin(), indices.end());
+	};
+
+	if ((mesh.vertices.size() <= MAX_16BIT_INDICES_RANGE_) && (mesh.texCoords.size() <= MAX_16BIT_INDICES_RANGE_) &&
+		(GetMaxIndex(mesh.vertexIndices) < MAX_16BIT_INDICES_RANGE_) && (GetMaxIndex(mesh.textureIndices) < MAX_16BIT_INDICES_RANGE_))
+	{
+		mesh.indexFormat = INDEX_FORMAT_UINT16;
+		Log::Print("index format: 16-bit");
+		return;
+	}
+
+	// returns true if the indices of the submesh fit into a 16-bit range; the base is the min index
+	auto GetIndicesBase = [](const std::vector<UINT> & indices, const SUBMESH & submesh, UINT & base) -> bool
+	{
+		UINT minIndex = UINT_MAX;
+		UINT maxIndex = 0;
+
+		for (size_t i = submesh.indexOffset; i < submesh.indexOffset + submesh.indexCount; i++)
+		{
+			minIndex = (std::min)(minIndex, indices[i]);
+			maxIndex = (std::max)(maxIndex, indices[i]);
+		}
+
+		base = (submesh.indexCount > 0) ? minIndex : 0;
+
+		return (submesh.indexCount == 0) || (maxIndex - minIndex < MAX_16BIT_INDICES_RANGE_);
+	};
+
+	std::vector<UINT> baseVertices(mesh.submeshes.size());
+	std::vector<UINT> baseTexCoords(mesh.submeshes.size());
+
+	for (size_t idx = 0; idx < mesh.submeshes.size(); idx++)
+	{
+		if (!GetIndicesBase(mesh.vertexIndices, mesh.submeshes[idx], baseVertices[idx]) ||
+			!GetIndicesBase(mesh.textureIndices, mesh.submeshes[idx], baseTexCoords[idx]))
+		{
+			Log::Print("index format: 32-bit (submesh %s/%s refers to more than %u vertices)",
+				mesh.submeshes[idx].materialName.c_str(),
+				mesh.submeshes[idx].groupName.c_str(),
+				MAX_16BIT_INDICES_RANGE_);
+			return;
+		}
+	}
+
+	for (size_t idx = 0; idx < mesh.submeshes.size(); idx++)
+	{
+		mesh.submeshes[idx].baseVertex = baseVertices[idx];
+		mesh.submeshes[idx].baseTexCoord = baseTexCoords[idx];
+	}
+
+	mesh.indexFormat = INDEX_FORMAT_UINT16_BASE_VERTEX;
+	Log::Print("index format: 16-bit with a base vertex per submesh");
+
+	return;
+}
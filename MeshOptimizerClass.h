@@ -0,0 +1,45 @@
+/////////////////////////////////////////////////////////////////////
+// Filename:     MeshOptimizerClass.h
+// Description:  the common processing stages which are executed over
+//               the model's data after it was read in by some input
+//               format converter and before it is written into the
+//               output file
+//
+// Created:      19.10.26
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////////////////////////
+// INCLUDES
+//////////////////////////////////
+#include "MeshData.h"
+#include "ConversionOptions.h"
+#include "Log.h"       // for using the log system
+
+
+//////////////////////////////////
+// Class name: MeshOptimizerClass
+//////////////////////////////////
+class MeshOptimizerClass
+{
+public:
+	MeshOptimizerClass(const ConversionOptions & options);
+
+	// execute all the processing stages over the mesh data
+	bool Run(MeshData & mesh);
+
+	// make each material a contiguous range of faces
+	void SortFacesByMaterial(MeshData & mesh);
+
+	// compute an AABB of each submesh
+	void ComputeSubmeshesBounds(MeshData & mesh);
+
+	// choose the narrowest index format which can address the mesh's vertices
+	void ChooseIndexFormat(MeshData & mesh);
+
+private:
+	static const UINT MAX_16BIT_INDICES_RANGE_ = 0x10000;    // 16-bit indices address up to 65536 elements
+
+private:
+	ConversionOptions options_;
+};
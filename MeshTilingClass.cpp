@@ -0,0 +1,351 @@
+#include "MeshTilingClass.h"
+#include "ParallelFor.h"
+#include "TraceRecorderClass.h"
+
+#include <cmath>
+#include <cfloat>
+#include <unordered_map>
+
+
+// ----------------------------------------------------------------------------------- //
+//
+//                          PUBLIC METHODS
+//
+// ----------------------------------------------------------------------------------- //
+
+// partition the final (sorted) faces of the mesh into tiles; empty tiles are skipped
+bool MeshTilingClass::Run(const MeshData & mesh, const ConversionOptions & options, std::vector<MESH_TILE> & tiles)
+{
+	TRACE_SCOPE("PartitionIntoTiles");
+
+	std::vector<TILE_FACES> tilesFaces;
+
+	tiles.clear();
+	this->ComputeCentroids(mesh);
+
+	switch (options.tilingMode)
+	{
+		case TILING_MODE_GRID:
+		{
+			const unsigned int* cells = options.tileGridCells;
+			const size_t cellsCount = (size_t)cells[0] * cells[1] * cells[2];
+
+			if ((cellsCount == 0) || (cellsCount > MAX_GRID_CELLS_COUNT_))
+			{
+				Log::Error(LOG_MACRO, ("invalid number of the grid cells: " + std::to_string(cellsCount)).c_str());
+				return false;
+			}
+
+			this->PartitionByGrid(cells, tilesFaces);
+			break;
+		}
+		case TILING_MODE_OCTREE:
+		{
+			this->PartitionByOctree((std::max)(1u, options.tileMaxTriangles), options.tileMaxDepth, tilesFaces);
+			break;
+		}
+		default:
+		{
+			Log::Error(LOG_MACRO, ("unknown tiling mode: " + std::to_string(options.tilingMode)).c_str());
+			return false;
+		}
+	}
+
+	// build the tiles' buffers in parallel (each tile is built by a single thread)
+	tiles.resize(tilesFaces.size());
+
+	ParallelFor(tilesFaces.size(), 1, [&](size_t begin, size_t end, size_t)
+	{
+		for (size_t idx = begin; idx < end; idx++)
+			this->BuildTile(mesh, tilesFaces[idx], tiles[idx]);
+	});
+
+	size_t tilesVerticesCount = 0;
+
+	for (const MESH_TILE & tile : tiles)
+		tilesVerticesCount += tile.vertices.size();
+
+	Log::Print("tiling: %u tiles; %u vertices in the tiles (%u in the mesh)",
+		(UINT)tiles.size(),
+		(UINT)tilesVerticesCount,
+		(UINT)mesh.vertices.size());
+
+	return true;
+}
+
+
+
+// ----------------------------------------------------------------------------------- //
+//
+//                          PRIVATE METHODS / HELPERS
+//
+// ----------------------------------------------------------------------------------- //
+
+// compute a centroid of each face and bounds of the centroids (the non-finite centroids
+// of the faces with NaN/Inf positions don't extend the bounds, such faces go to the first tile)
+void MeshTilingClass::ComputeCentroids(const MeshData & mesh)
+{
+	const size_t facesCount = mesh.GetFacesCount();
+	const size_t threadsCount = GetWorkerThreadsCount();
+
+	std::vector<VERTEX3D> threadsMin(threadsCount, { FLT_MAX, FLT_MAX, FLT_MAX });
+	std::vector<VERTEX3D> threadsMax(threadsCount, { -FLT_MAX, -FLT_MAX, -FLT_MAX });
+
+	centroids_.resize(facesCount);
+
+	ParallelFor(facesCount, MIN_ELEMENTS_PER_THREAD_, [&](size_t begin, size_t end, size_t threadIdx)
+	{
+		VERTEX3D & localMin = threadsMin[threadIdx];
+		VERTEX3D & localMax = threadsMax[threadIdx];
+
+		for (size_t face = begin; face < end; face++)
+		{
+			VERTEX3D centroid;
+
+			for (size_t vertex = 0; vertex < 3; vertex++)
+			{
+				const UINT vertexIndex = mesh.vertexIndices[face * 3 + vertex];
+
+				// invalid indices are counted as the origin
+				if (vertexIndex >= mesh.vertices.size())
+					continue;
+
+				centroid.x += mesh.vertices[vertexIndex].x / 3.0f;
+				centroid.y += mesh.vertices[vertexIndex].y / 3.0f;
+				centroid.z += mesh.vertices[vertexIndex].z / 3.0f;
+			}
+
+			centroids_[face] = centroid;
+
+			if (!IsFinite(centroid))
+				continue;
+
+			localMin = { (std::min)(localMin.x, centroid.x), (std::min)(localMin.y, centroid.y), (std::min)(localMin.z, centroid.z) };
+			localMax = { (std::max)(localMax.x, centroid.x), (std::max)(localMax.y, centroid.y), (std::max)(localMax.z, centroid.z) };
+		}
+	});
+
+	boundsMin_ = { FLT_MAX, FLT_MAX, FLT_MAX };
+	boundsMax_ = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+	for (size_t i = 0; i < threadsCount; i++)
+	{
+		boundsMin_ = { (std::min)(boundsMin_.x, threadsMin[i].x), (std::min)(boundsMin_.y, threadsMin[i].y), (std::min)(boundsMin_.z, threadsMin[i].z) };
+		boundsMax_ = { (std::max)(boundsMax_.x, threadsMax[i].x), (std::max)(boundsMax_.y, threadsMax[i].y), (std::max)(boundsMax_.z, threadsMax[i].z) };
+	}
+
+	return;
+}
+
+
+// put each face into the grid cell which has its centroid
+void MeshTilingClass::PartitionByGrid(const unsigned int cells[3], std::vector<TILE_FACES> & tilesFaces)
+{
+	const size_t facesCount = centroids_.size();
+	const float boundsMin[3] = { boundsMin_.x, boundsMin_.y, boundsMin_.z };
+	const float boundsMax[3] = { boundsMax_.x, boundsMax_.y, boundsMax_.z };
+
+	// returns a cell of the value along the axis
+	auto GetCell = [&](const float value, const size_t axis) -> UINT
+	{
+		const float extent = boundsMax[axis] - boundsMin[axis];
+
+		if (!(extent > 0.0f))
+			return 0;
+
+		const float cell = (value - boundsMin[axis]) / extent * (float)cells[axis];
+
+		// NaN fails every comparison so it must be tested before the clamping
+		if (!(cell >= 0.0f))
+			return 0;
+
+		return (UINT)(std::min)(cell, (float)(cells[axis] - 1));
+	};
+
+	// compute the cell of each face
+	std::vector<UINT> facesCells(facesCount);
+
+	ParallelFor(facesCount, MIN_ELEMENTS_PER_THREAD_, [&](size_t begin, size_t end, size_t)
+	{
+		for (size_t face = begin; face < end; face++)
+		{
+			const VERTEX3D & centroid = centroids_[face];
+
+			facesCells[face] = !IsFinite(centroid) ? 0 :
+				(GetCell(centroid.z, 2) * cells[1] + GetCell(centroid.y, 1)) * cells[0] + GetCell(centroid.x, 0);
+		}
+	});
+
+	// make a tile for each non-empty cell (in the order of cells)
+	std::vector<UINT> cellsTiles((size_t)cells[0] * cells[1] * cells[2], UINT_MAX);
+
+	for (size_t face = 0; face < facesCount; face++)
+		cellsTiles[facesCells[face]] = 0;
+
+	for (size_t cell = 0; cell < cellsTiles.size(); cell++)
+	{
+		if (cellsTiles[cell] == UINT_MAX)
+			continue;
+
+		TILE_FACES tileFaces;
+		tileFaces.coords[0] = (UINT)(cell % cells[0]);
+		tileFaces.coords[1] = (UINT)((cell / cells[0]) % cells[1]);
+		tileFaces.coords[2] = (UINT)(cell / ((size_t)cells[0] * cells[1]));
+
+		cellsTiles[cell] = (UINT)tilesFaces.size();
+		tilesFaces.push_back(tileFaces);
+	}
+
+	for (size_t face = 0; face < facesCount; face++)
+		tilesFaces[cellsTiles[facesCells[face]]].faces.push_back((UINT)face);
+
+	return;
+}
+
+
+// split the bounds of the faces' centroids into octants until the nodes are
+// small enough (or they reach the max depth); the leaves of the octree are tiles
+void MeshTilingClass::PartitionByOctree(const size_t maxTriangles, const UINT maxDepth, std::vector<TILE_FACES> & tilesFaces)
+{
+	struct OCTREE_NODE
+	{
+		TILE_FACES tileFaces;
+		VERTEX3D boundsMin;
+		VERTEX3D boundsMax;
+	};
+
+	OCTREE_NODE root;
+	root.boundsMin = boundsMin_;
+	root.boundsMax = boundsMax_;
+	root.tileFaces.faces.resize(centroids_.size());
+
+	for (size_t face = 0; face < centroids_.size(); face++)
+		root.tileFaces.faces[face] = (UINT)face;
+
+	// handle the nodes in the depth-first order (children in the order of octants)
+	std::vector<OCTREE_NODE> stack;
+	stack.push_back(std::move(root));
+
+	while (!stack.empty())
+	{
+		OCTREE_NODE node = std::move(stack.back());
+		stack.pop_back();
+
+		if (node.tileFaces.faces.empty())
+			continue;
+
+		if ((node.tileFaces.faces.size() <= maxTriangles) || (node.tileFaces.level >= maxDepth))
+		{
+			tilesFaces.push_back(std::move(node.tileFaces));
+			continue;
+		}
+
+		// halves are added so the center of the huge bounds doesn't overflow
+		const VERTEX3D center =
+		{
+			node.boundsMin.x * 0.5f + node.boundsMax.x * 0.5f,
+			node.boundsMin.y * 0.5f + node.boundsMax.y * 0.5f,
+			node.boundsMin.z * 0.5f + node.boundsMax.z * 0.5f
+		};
+
+		OCTREE_NODE children[8];
+
+		for (UINT octant = 0; octant < 8; octant++)
+		{
+			OCTREE_NODE & child = children[octant];
+			const bool isUpper[3] = { (octant & 1) != 0, (octant & 2) != 0, (octant & 4) != 0 };
+
+			child.tileFaces.level = node.tileFaces.level + 1;
+			child.boundsMin = { isUpper[0] ? center.x : node.boundsMin.x, isUpper[1] ? center.y : node.boundsMin.y, isUpper[2] ? center.z : node.boundsMin.z };
+			child.boundsMax = { isUpper[0] ? node.boundsMax.x : center.x, isUpper[1] ? node.boundsMax.y : center.y, isUpper[2] ? node.boundsMax.z : center.z };
+
+			for (size_t axis = 0; axis < 3; axis++)
+				child.tileFaces.coords[axis] = node.tileFaces.coords[axis] * 2 + (isUpper[axis] ? 1 : 0);
+		}
+
+		// the faces stay in the increasing order inside of each child
+		for (const UINT face : node.tileFaces.faces)
+		{
+			const VERTEX3D & centroid = centroids_[face];
+			const UINT octant = !IsFinite(centroid) ? 0 : ((centroid.x >= center.x) ? 1 : 0) | ((centroid.y >= center.y) ? 2 : 0) | ((centroid.z >= center.z) ? 4 : 0);
+
+			children[octant].tileFaces.faces.push_back(face);
+		}
+
+		for (int octant = 7; octant >= 0; octant--)
+			stack.push_back(std::move(children[octant]));
+	}
+
+	return;
+}
+
+
+// build compact buffers of the tile: the unique (position, texture coords) pairs
+// of its faces get local indices in the order of their first usage
+void MeshTilingClass::BuildTile(const MeshData & mesh, const TILE_FACES & tileFaces, MESH_TILE & tile) const
+{
+	std::unordered_map<uint64_t, UINT> localIndices;
+	localIndices.reserve(tileFaces.faces.size() * 2);
+
+	tile.level = tileFaces.level;
+	tile.coords[0] = tileFaces.coords[0];
+	tile.coords[1] = tileFaces.coords[1];
+	tile.coords[2] = tileFaces.coords[2];
+	tile.aabbMin = { FLT_MAX, FLT_MAX, FLT_MAX };
+	tile.aabbMax = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	tile.indices.reserve(tileFaces.faces.size() * 3);
+
+	// the submeshes are sorted by their offsets so we go through them along with the faces
+	auto submeshIt = mesh.submeshes.begin();
+
+	for (const UINT face : tileFaces.faces)
+	{
+		while ((submeshIt != mesh.submeshes.end()) && ((size_t)face * 3 >= submeshIt->indexOffset + submeshIt->indexCount))
+			++submeshIt;
+
+		const UINT materialIndex = (submeshIt != mesh.submeshes.end()) ? submeshIt->materialIndex : 0;
+
+		// start a new range if the material is changed
+		if (tile.submeshes.empty() || (tile.submeshes.back().materialIndex != materialIndex))
+		{
+			TILE_SUBMESH submesh;
+			submesh.materialIndex = materialIndex;
+			submesh.indexOffset = tile.indices.size();
+			tile.submeshes.push_back(submesh);
+		}
+
+		for (size_t vertex = 0; vertex < 3; vertex++)
+		{
+			const UINT vertexIndex = mesh.vertexIndices[(size_t)face * 3 + vertex];
+			const UINT textureIndex = mesh.textureIndices[(size_t)face * 3 + vertex];
+			const uint64_t key = ((uint64_t)vertexIndex << 32) | textureIndex;
+
+			const auto result = localIndices.insert({ key, (UINT)tile.vertices.size() });
+
+			// a new unique vertex of the tile (invalid indices give zero attributes)
+			if (result.second)
+			{
+				const VERTEX3D position = (vertexIndex < mesh.vertices.size()) ? mesh.vertices[vertexIndex] : VERTEX3D();
+				const TEXTURE_COORDS texCoords = (textureIndex < mesh.texCoords.size()) ? mesh.texCoords[textureIndex] : TEXTURE_COORDS();
+
+				tile.vertices.push_back(position);
+				tile.texCoords.push_back(texCoords);
+
+				tile.aabbMin = { (std::min)(tile.aabbMin.x, position.x), (std::min)(tile.aabbMin.y, position.y), (std::min)(tile.aabbMin.z, position.z) };
+				tile.aabbMax = { (std::max)(tile.aabbMax.x, position.x), (std::max)(tile.aabbMax.y, position.y), (std::max)(tile.aabbMax.z, position.z) };
+			}
+
+			tile.indices.push_back(result.first->second);
+		}
+
+		tile.submeshes.back().indexCount += 3;
+	}
+
+	return;
+}
+
+
+bool MeshTilingClass::IsFinite(const VERTEX3D & point)
+{
+	return std::isfinite(point.x) && std::isfinite(point.y) && std::isfinite(point.z);
+}
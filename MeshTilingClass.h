@@ -0,0 +1,77 @@
+/////////////////////////////////////////////////////////////////////
+// Filename:     MeshTilingClass.h
+// Description:  partitions the mesh into spatial tiles (by a uniform
+//               grid or an octree) so the engine can stream and cull
+//               it by parts; each face goes into the tile which has
+//               its centroid and each tile gets its own compact vertex
+//               and index buffers (with local indices) and bounds
+//
+// Created:      19.10.26
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////////////////////////
+// INCLUDES
+//////////////////////////////////
+#include "MeshData.h"
+#include "ConversionOptions.h"
+#include "Log.h"       // for using the log system
+
+
+// a range of faces of the tile with the same material
+struct TILE_SUBMESH
+{
+	UINT materialIndex = 0;
+	size_t indexOffset = 0;              // the first index of the range in the tile's indices
+	size_t indexCount = 0;
+};
+
+struct MESH_TILE
+{
+	UINT level = 0;                      // a depth of the octree node (0 for the grid)
+	UINT coords[3] = { 0, 0, 0 };        // the cell of the grid (or of the octree's level)
+	VERTEX3D aabbMin;                    // bounds of the tile's faces
+	VERTEX3D aabbMax;
+
+	std::vector<VERTEX3D> vertices;      // unique (position, texture coords) pairs of the tile
+	std::vector<TEXTURE_COORDS> texCoords;
+	std::vector<UINT> indices;           // local indices (the faces winding order is the same as in the mesh data)
+	std::vector<TILE_SUBMESH> submeshes;
+};
+
+
+//////////////////////////////////
+// Class name: MeshTilingClass
+//////////////////////////////////
+class MeshTilingClass
+{
+public:
+	// partition the final (sorted) faces of the mesh into tiles; empty tiles are skipped
+	bool Run(const MeshData & mesh, const ConversionOptions & options, std::vector<MESH_TILE> & tiles);
+
+private:
+	// a set of faces which go into the same tile
+	struct TILE_FACES
+	{
+		UINT level = 0;
+		UINT coords[3] = { 0, 0, 0 };
+		std::vector<UINT> faces;             // in the increasing order (so the materials ranges stay contiguous)
+	};
+
+	void ComputeCentroids(const MeshData & mesh);
+	void PartitionByGrid(const unsigned int cells[3], std::vector<TILE_FACES> & tilesFaces);
+	void PartitionByOctree(const size_t maxTriangles, const UINT maxDepth, std::vector<TILE_FACES> & tilesFaces);
+
+	void BuildTile(const MeshData & mesh, const TILE_FACES & tileFaces, MESH_TILE & tile) const;
+
+	static bool IsFinite(const VERTEX3D & point);
+
+private:
+	std::vector<VERTEX3D> centroids_;        // a centroid of each face
+	VERTEX3D boundsMin_;                     // bounds of the centroids
+	VERTEX3D boundsMax_;
+
+	// constants
+	static constexpr size_t MIN_ELEMENTS_PER_THREAD_ = 1 << 16;     // smaller meshes are handled on a single thread
+	static constexpr size_t MAX_GRID_CELLS_COUNT_ = 1 << 24;
+};
@@ -0,0 +1,389 @@
+#include "MeshValidatorClass.h"
+#include "ParallelFor.h"
+#include "TraceRecorderClass.h"
+
+#include <cmath>
+#include <cfloat>
+#include <climits>
+
+// use SSE2 where it is available (it is always available on x64)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+	#define MESH_VALIDATOR_SSE2
+	#include <emmintrin.h>
+#endif
+
+// the attributes arrays are checked as plain arrays of floats
+static_assert(sizeof(VERTEX3D) == 3 * sizeof(float), "VERTEX3D must be 3 packed floats");
+static_assert(sizeof(TEXTURE_COORDS) == 2 * sizeof(float), "TEXTURE_COORDS must be 2 packed floats");
+
+
+// ----------------------------------------------------------------------------------- //
+//
+//                          PUBLIC METHODS
+//
+// ----------------------------------------------------------------------------------- //
+
+// validate the mesh data (it must be executed before the cleanup so faces are still in the input order)
+bool MeshValidatorClass::Run(MeshData & mesh, const ConversionOptions & options)
+{
+	TRACE_SCOPE("ValidateMesh");
+
+	stats_ = VALIDATION_STATS();
+
+	std::vector<size_t> invalidFaces;
+	std::vector<size_t> nonFiniteVertices;
+	std::vector<size_t> nonFiniteTexCoords;
+
+	this->FindInvalidFaces(mesh, invalidFaces);
+	FindNonFiniteValues(reinterpret_cast<const float*>(mesh.vertices.data()), mesh.vertices.size(), 3, nonFiniteVertices);
+	FindNonFiniteValues(reinterpret_cast<const float*>(mesh.texCoords.data()), mesh.texCoords.size(), 2, nonFiniteTexCoords);
+
+	stats_.invalidIndicesFacesCount = invalidFaces.size();
+	stats_.nonFiniteVerticesCount = nonFiniteVertices.size();
+	stats_.nonFiniteTexCoordsCount = nonFiniteTexCoords.size();
+
+	if (invalidFaces.empty() && nonFiniteVertices.empty() && nonFiniteTexCoords.empty())
+	{
+		Log::Debug(LOG_MACRO, "MESH DATA IS VALID");
+		return true;
+	}
+
+	this->PrintReport(mesh, options, invalidFaces, nonFiniteVertices, nonFiniteTexCoords);
+
+	switch (options.invalidDataAction)
+	{
+		case VALIDATION_ACTION_KEEP:
+			break;
+
+		case VALIDATION_ACTION_CLAMP:
+			this->ClampInvalidData(mesh, invalidFaces, nonFiniteVertices, nonFiniteTexCoords);
+			break;
+
+		case VALIDATION_ACTION_DROP:
+			this->DropInvalidData(mesh, invalidFaces, nonFiniteVertices, nonFiniteTexCoords);
+			break;
+
+		default:
+			Log::Error(LOG_MACRO, ("unknown validation action: " + std::to_string(options.invalidDataAction)).c_str());
+			return false;
+	}
+
+	return true;
+}
+
+
+
+// ----------------------------------------------------------------------------------- //
+//
+//                          PRIVATE METHODS / HELPERS
+//
+// ----------------------------------------------------------------------------------- //
+
+// find faces which have some vertex/texture index out of the range of the attributes
+// (the result is sorted by the faces order)
+void MeshValidatorClass::FindInvalidFaces(const MeshData & mesh, std::vector<size_t> & invalidFaces) const
+{
+	const size_t facesCount = mesh.GetFacesCount();
+	const size_t verticesCount = mesh.vertices.size();
+	const size_t texCoordsCount = mesh.texCoords.size();
+
+	std::vector<std::vector<size_t>> threadsInvalidFaces(GetWorkerThreadsCount());
+
+	ParallelFor(facesCount, MIN_ELEMENTS_PER_THREAD_, [&](size_t begin, size_t end, size_t threadIdx)
+	{
+		for (size_t blockBegin = begin; blockBegin < end; blockBegin += BLOCK_SIZE_)
+		{
+			const size_t blockEnd = (std::min)(end, blockBegin + BLOCK_SIZE_);
+			const size_t indicesCount = (blockEnd - blockBegin) * 3;
+
+			if (!HasIndicesOutOfRange(mesh.vertexIndices.data() + blockBegin * 3, indicesCount, verticesCount) &&
+				!HasIndicesOutOfRange(mesh.textureIndices.data() + blockBegin * 3, indicesCount, texCoordsCount))
+			{
+				continue;
+			}
+
+			for (size_t face = blockBegin; face < blockEnd; face++)
+			{
+				for (size_t vertex = 0; vertex < 3; vertex++)
+				{
+					if ((mesh.vertexIndices[face * 3 + vertex] >= verticesCount) ||
+						(mesh.textureIndices[face * 3 + vertex] >= texCoordsCount))
+					{
+						threadsInvalidFaces[threadIdx].push_back(face);
+						break;
+					}
+				}
+			}
+		}
+	});
+
+	// the threads have contiguous ranges of faces so we keep the order by joining them in the threads order
+	for (const std::vector<size_t> & threadInvalidFaces : threadsInvalidFaces)
+		invalidFaces.insert(invalidFaces.end(), threadInvalidFaces.begin(), threadInvalidFaces.end());
+
+	return;
+}
+
+
+// find elements (of elementSize floats) which have some NaN/Inf value
+void MeshValidatorClass::FindNonFiniteValues(const float* pValues, const size_t elementsCount, const size_t elementSize,
+	std::vector<size_t> & invalidElements)
+{
+	std::vector<std::vector<size_t>> threadsInvalidElements(GetWorkerThreadsCount());
+
+	ParallelFor(elementsCount, MIN_ELEMENTS_PER_THREAD_, [&](size_t begin, size_t end, size_t threadIdx)
+	{
+		for (size_t blockBegin = begin; blockBegin < end; blockBegin += BLOCK_SIZE_)
+		{
+			const size_t blockEnd = (std::min)(end, blockBegin + BLOCK_SIZE_);
+
+			if (!HasNonFiniteValues(pValues + blockBegin * elementSize, (blockEnd - blockBegin) * elementSize))
+				continue;
+
+			for (size_t element = blockBegin; element < blockEnd; element++)
+			{
+				for (size_t i = 0; i < elementSize; i++)
+				{
+					if (!std::isfinite(pValues[element * elementSize + i]))
+					{
+						threadsInvalidElements[threadIdx].push_back(element);
+						break;
+					}
+				}
+			}
+		}
+	});
+
+	for (const std::vector<size_t> & threadInvalidElements : threadsInvalidElements)
+		invalidElements.insert(invalidElements.end(), threadInvalidElements.begin(), threadInvalidElements.end());
+
+	return;
+}
+
+
+// print the counts of the invalid faces/values and the first of them
+void MeshValidatorClass::PrintReport(const MeshData & mesh, const ConversionOptions & options,
+	const std::vector<size_t> & invalidFaces,
+	const std::vector<size_t> & nonFiniteVertices,
+	const std::vector<size_t> & nonFiniteTexCoords) const
+{
+	const char* actionNames[3] = { "they are kept", "they are clamped", "they are dropped" };
+	const size_t maxReported = options.maxReportedProblems;
+
+	Log::Print("validation: %u faces with invalid indices, %u non-finite positions, %u non-finite texture coords; %s",
+		(UINT)invalidFaces.size(),
+		(UINT)nonFiniteVertices.size(),
+		(UINT)nonFiniteTexCoords.size(),
+		(options.invalidDataAction <= VALIDATION_ACTION_DROP) ? actionNames[options.invalidDataAction] : "");
+
+	for (size_t idx = 0; idx < (std::min)(maxReported, invalidFaces.size()); idx++)
+	{
+		const size_t face = invalidFaces[idx];
+		const UINT* v = &mesh.vertexIndices[face * 3];
+		const UINT* t = &mesh.textureIndices[face * 3];
+
+		// the line of the face in the input file (if the input format has lines)
+		const std::string line = (face < mesh.faceSourceLines.size()) ? " (line " + std::to_string(mesh.faceSourceLines[face]) + ")" : "";
+
+		Log::Print("validation: face %u%s: vertex indices %u %u %u (of %u), texture indices %u %u %u (of %u)",
+			(UINT)face,
+			line.c_str(),
+			v[0], v[1], v[2], (UINT)mesh.vertices.size(),
+			t[0], t[1], t[2], (UINT)mesh.texCoords.size());
+	}
+
+	for (size_t idx = 0; idx < (std::min)(maxReported, nonFiniteVertices.size()); idx++)
+	{
+		const VERTEX3D & vertex = mesh.vertices[nonFiniteVertices[idx]];
+		Log::Print("validation: position %u: %f %f %f", (UINT)nonFiniteVertices[idx], vertex.x, vertex.y, vertex.z);
+	}
+
+	for (size_t idx = 0; idx < (std::min)(maxReported, nonFiniteTexCoords.size()); idx++)
+	{
+		const TEXTURE_COORDS & texCoords = mesh.texCoords[nonFiniteTexCoords[idx]];
+		Log::Print("validation: texture coords %u: %f %f", (UINT)nonFiniteTexCoords[idx], texCoords.tu, texCoords.tv);
+	}
+
+	return;
+}
+
+
+// clamp the invalid indices into the range of the attributes and replace NaN with 0 and Inf with +-FLT_MAX;
+// the faces can't be clamped if there are no attributes at all so they are dropped
+void MeshValidatorClass::ClampInvalidData(MeshData & mesh,
+	const std::vector<size_t> & invalidFaces,
+	const std::vector<size_t> & nonFiniteVertices,
+	const std::vector<size_t> & nonFiniteTexCoords)
+{
+	if (!invalidFaces.empty() && (mesh.vertices.empty() || mesh.texCoords.empty()))
+	{
+		this->DropInvalidData(mesh, invalidFaces, {}, {});
+	}
+	else
+	{
+		const UINT maxVertexIndex = (UINT)mesh.vertices.size() - 1;
+		const UINT maxTextureIndex = (UINT)mesh.texCoords.size() - 1;
+
+		for (const size_t face : invalidFaces)
+		{
+			for (size_t vertex = 0; vertex < 3; vertex++)
+			{
+				UINT & vertexIndex = mesh.vertexIndices[face * 3 + vertex];
+				UINT & textureIndex = mesh.textureIndices[face * 3 + vertex];
+
+				vertexIndex = (std::min)(vertexIndex, maxVertexIndex);
+				textureIndex = (std::min)(textureIndex, maxTextureIndex);
+			}
+		}
+	}
+
+	auto ClampValue = [](float & value)
+	{
+		if (std::isnan(value))
+			value = 0.0f;
+		else if (std::isinf(value))
+			value = (value > 0.0f) ? FLT_MAX : -FLT_MAX;
+	};
+
+	for (const size_t idx : nonFiniteVertices)
+	{
+		ClampValue(mesh.vertices[idx].x);
+		ClampValue(mesh.vertices[idx].y);
+		ClampValue(mesh.vertices[idx].z);
+	}
+
+	for (const size_t idx : nonFiniteTexCoords)
+	{
+		ClampValue(mesh.texCoords[idx].tu);
+		ClampValue(mesh.texCoords[idx].tv);
+	}
+
+	return;
+}
+
+
+// remove faces which have invalid indices or which use non-finite attributes; the non-finite
+// values aren't used by any face after that but they are zeroed so they don't get into the output
+void MeshValidatorClass::DropInvalidData(MeshData & mesh,
+	const std::vector<size_t> & invalidFaces,
+	const std::vector<size_t> & nonFiniteVertices,
+	const std::vector<size_t> & nonFiniteTexCoords)
+{
+	const size_t facesCount = mesh.GetFacesCount();
+	std::vector<uint8_t> keepFaces(facesCount, 1);
+
+	for (const size_t face : invalidFaces)
+		keepFaces[face] = 0;
+
+	if (!nonFiniteVertices.empty() || !nonFiniteTexCoords.empty())
+	{
+		std::vector<uint8_t> isInvalidVertex(mesh.vertices.size(), 0);
+		std::vector<uint8_t> isInvalidTexCoord(mesh.texCoords.size(), 0);
+
+		for (const size_t idx : nonFiniteVertices)
+		{
+			isInvalidVertex[idx] = 1;
+			mesh.vertices[idx] = VERTEX3D();
+		}
+
+		for (const size_t idx : nonFiniteTexCoords)
+		{
+			isInvalidTexCoord[idx] = 1;
+			mesh.texCoords[idx] = TEXTURE_COORDS();
+		}
+
+		ParallelFor(facesCount, MIN_ELEMENTS_PER_THREAD_, [&](size_t begin, size_t end, size_t)
+		{
+			for (size_t face = begin; face < end; face++)
+			{
+				if (!keepFaces[face])
+					continue;
+
+				for (size_t vertex = 0; vertex < 3; vertex++)
+				{
+					if (isInvalidVertex[mesh.vertexIndices[face * 3 + vertex]] ||
+						isInvalidTexCoord[mesh.textureIndices[face * 3 + vertex]])
+					{
+						keepFaces[face] = 0;
+						break;
+					}
+				}
+			}
+		});
+	}
+
+	const size_t facesCountBefore = facesCount;
+	mesh.CompactFaces(keepFaces);
+	stats_.droppedFacesCount += facesCountBefore - mesh.GetFacesCount();
+
+	Log::Print("validation: %u faces are dropped", (UINT)stats_.droppedFacesCount);
+
+	return;
+}
+
+
+// returns true if some of the indices are >= limit
+bool MeshValidatorClass::HasIndicesOutOfRange(const UINT* pIndices, const size_t count, const size_t limit)
+{
+	if (limit == 0)
+		return count > 0;
+
+	// all the 32-bit indices are valid
+	if (limit > UINT_MAX)
+		return false;
+
+	size_t i = 0;
+
+#ifdef MESH_VALIDATOR_SSE2
+	// SSE2 has only signed comparisons of 32-bit integers so both sides are biased by 2^31
+	const __m128i bias = _mm_set1_epi32(INT_MIN);
+	const __m128i maxIndex = _mm_xor_si128(_mm_set1_epi32((int)(UINT)(limit - 1)), bias);
+	__m128i outOfRange = _mm_setzero_si128();
+
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128i indices = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pIndices + i)), bias);
+		outOfRange = _mm_or_si128(outOfRange, _mm_cmpgt_epi32(indices, maxIndex));
+	}
+
+	if (_mm_movemask_epi8(outOfRange) != 0)
+		return true;
+#endif
+
+	for (; i < count; i++)
+	{
+		if (pIndices[i] >= limit)
+			return true;
+	}
+
+	return false;
+}
+
+
+// returns true if some of the values is NaN/Inf (all bits of its exponent are set)
+bool MeshValidatorClass::HasNonFiniteValues(const float* pValues, const size_t count)
+{
+	size_t i = 0;
+
+#ifdef MESH_VALIDATOR_SSE2
+	const __m128i exponentMask = _mm_set1_epi32(0x7F800000);
+	__m128i nonFinite = _mm_setzero_si128();
+
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128i exponents = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pValues + i)), exponentMask);
+		nonFinite = _mm_or_si128(nonFinite, _mm_cmpeq_epi32(exponents, exponentMask));
+	}
+
+	if (_mm_movemask_epi8(nonFinite) != 0)
+		return true;
+#endif
+
+	for (; i < count; i++)
+	{
+		if (!std::isfinite(pValues[i]))
+			return true;
+	}
+
+	return false;
+}
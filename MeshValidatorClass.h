@@ -0,0 +1,74 @@
+/////////////////////////////////////////////////////////////////////
+// Filename:     MeshValidatorClass.h
+// Description:  a validation stage of the mesh data: checks all the
+//               indices against the counts of the attributes and the
+//               attributes for NaN/Inf values (by blocks with SSE2 so
+//               it is cheap enough to be always on); reports the first
+//               invalid faces/values and (optionally) clamps or drops
+//               them; faces and attributes are numbered from 0 in the
+//               order of the input file (faces of text formats are also
+//               reported with their lines in the input file)
+//
+// Created:      19.10.26
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////////////////////////
+// INCLUDES
+//////////////////////////////////
+#include "MeshData.h"
+#include "ConversionOptions.h"
+#include "Log.h"       // for using the log system
+
+#include <cstdint>
+
+
+//////////////////////////////////
+// Class name: MeshValidatorClass
+//////////////////////////////////
+class MeshValidatorClass
+{
+public:
+	struct VALIDATION_STATS
+	{
+		size_t invalidIndicesFacesCount = 0;   // faces which have some index out of the range of the attributes
+		size_t nonFiniteVerticesCount = 0;     // positions which have NaN/Inf coordinates
+		size_t nonFiniteTexCoordsCount = 0;
+		size_t droppedFacesCount = 0;
+	};
+
+public:
+	// validate the mesh data (it must be executed before the cleanup so faces are still in the input order)
+	bool Run(MeshData & mesh, const ConversionOptions & options);
+
+	const VALIDATION_STATS & GetStats() const { return stats_; }
+
+private:
+	void FindInvalidFaces(const MeshData & mesh, std::vector<size_t> & invalidFaces) const;
+	static void FindNonFiniteValues(const float* pValues, const size_t elementsCount, const size_t elementSize, std::vector<size_t> & invalidElements);
+
+	void PrintReport(const MeshData & mesh, const ConversionOptions & options,
+		const std::vector<size_t> & invalidFaces,
+		const std::vector<size_t> & nonFiniteVertices,
+		const std::vector<size_t> & nonFiniteTexCoords) const;
+
+	void ClampInvalidData(MeshData & mesh,
+		const std::vector<size_t> & invalidFaces,
+		const std::vector<size_t> & nonFiniteVertices,
+		const std::vector<size_t> & nonFiniteTexCoords);
+	void DropInvalidData(MeshData & mesh,
+		const std::vector<size_t> & invalidFaces,
+		const std::vector<size_t> & nonFiniteVertices,
+		const std::vector<size_t> & nonFiniteTexCoords);
+
+	// the SIMD checks of the whole block (the block is scanned once more only if it has some invalid element)
+	static bool HasIndicesOutOfRange(const UINT* pIndices, const size_t count, const size_t limit);
+	static bool HasNonFiniteValues(const float* pValues, const size_t count);
+
+private:
+	VALIDATION_STATS stats_;
+
+	// constants
+	static constexpr size_t BLOCK_SIZE_ = 4096;                        // how many elements are checked at once
+	static constexpr size_t MIN_ELEMENTS_PER_THREAD_ = 1 << 16;        // smaller meshes are handled on a single thread
+};
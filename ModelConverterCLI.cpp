@@ -0,0 +1,371 @@
+/////////////////////////////////////////////////////////////////////
+// Filename:     ModelConverterCLI.cpp
+// Description:  a headless command line converter over the library's
+//               interface: converts a single model file or all the
+//               model files (.obj, .ply, .stl) of a directory tree;
+//               the files of a tree are converted in parallel (the
+//               biggest ones first) and the output tree mirrors the
+//               input one
+//
+// Created:      19.10.26
+/////////////////////////////////////////////////////////////////////
+#include "ModelConverterDLLEntry.h"
+#include "ParallelFor.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+
+struct CONVERSION_JOB
+{
+	fs::path inputFile;
+	fs::path outputFile;
+	uintmax_t size = 0;
+};
+
+
+static void PrintUsage()
+{
+	std::cout <<
+		"usage: model_converter [options] <input> [<output>]\n"
+		"  <input>                     a model file (.obj, .ply, .stl) or a directory which is converted recursively\n"
+		"  <output>                    the output file or directory (by default the .txt files are written next to the input files)\n"
+		"options:\n"
+		"  -j <count>                  how many files are converted at the same time (default: half of the hardware threads)\n"
+		"  --invalid-data <action>     keep | clamp | drop (faces with invalid indices and NaN/Inf values)\n"
+		"  --no-validation             don't check indices and values of the input data\n"
+		"  --no-cleanup                don't weld vertices and don't remove degenerate/duplicate triangles\n"
+		"  --weld-tolerance <value>    max distance between welded vertices\n"
+		"  --adjacency                 write triangles with adjacency\n"
+		"  --edges                     write unique edges with their faces\n"
+		"  --no-16bit-indices          always write 32-bit indices\n"
+		"  --vertex-layout <layout>    interleaved | soa | position_stream (write the .vbuf vertex buffers file)\n"
+		"  --tiles <mode>              grid | octree (write the .tiles/.tiledata files)\n"
+		"  --instances                 write repeated groups/objects as instances (.instances/.instdata files)\n"
+		"  --ao                        bake the per-vertex ambient occlusion\n"
+		"  --ao-rays <count>           rays per vertex of the ambient occlusion\n"
+		"  --ao-distance <value>       max distance of the ambient occlusion rays\n"
+		"  --compress                  write the compressed streams (.mcmp file)\n"
+		"  --trace <file>              write the trace events of the conversions into the Chrome trace JSON file\n";
+}
+
+
+// returns true if the file has an extension of the supported input formats
+static bool IsModelFile(const fs::path & path)
+{
+	std::string extension = path.extension().string();
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+
+	return (extension == ".obj") || (extension == ".ply") || (extension == ".stl");
+}
+
+
+// returns the index of the name in the array or -1 if there is no such name
+static int FindName(const char* name, const char* const* names, const int namesCount)
+{
+	for (int idx = 0; idx < namesCount; idx++)
+	{
+		if (strcmp(name, names[idx]) == 0)
+			return idx;
+	}
+
+	return -1;
+}
+
+
+// fill in the options by the command line arguments; the positional arguments are returned separately
+static bool ParseArguments(const int argc, char** argv, ConversionOptions & options, size_t & jobsCount,
+	std::string & traceFilename, std::vector<std::string> & paths)
+{
+	const char* actionsNames[] = { "keep", "clamp", "drop" };                          // by VALIDATION_ACTION
+	const char* layoutsNames[] = { "none", "interleaved", "soa", "position_stream" };  // by VERTEX_LAYOUT
+	const char* tilingNames[] = { "none", "grid", "octree" };                          // by TILING_MODE
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char* arg = argv[i];
+		const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+		bool usesValue = false;
+		bool isValid = true;
+
+		if (arg[0] != '-')
+		{
+			paths.push_back(arg);
+			continue;
+		}
+
+		if (strcmp(arg, "-j") == 0)
+		{
+			usesValue = isValid = (value != nullptr) && (atoi(value) > 0);
+			jobsCount = isValid ? (size_t)atoi(value) : 0;
+		}
+		else if (strcmp(arg, "--invalid-data") == 0)
+		{
+			const int idx = (value != nullptr) ? FindName(value, actionsNames, 3) : -1;
+			usesValue = isValid = (idx >= 0);
+			options.invalidDataAction = (VALIDATION_ACTION)(std::max)(idx, 0);
+		}
+		else if (strcmp(arg, "--no-validation") == 0)
+		{
+			options.validateMesh = false;
+		}
+		else if (strcmp(arg, "--no-cleanup") == 0)
+		{
+			options.weldVertices = false;
+			options.removeDegenerateTriangles = false;
+			options.removeDuplicateTriangles = false;
+		}
+		else if (strcmp(arg, "--weld-tolerance") == 0)
+		{
+			usesValue = isValid = (value != nullptr);
+			options.weldTolerance = isValid ? (float)atof(value) : 0.0f;
+		}
+		else if (strcmp(arg, "--adjacency") == 0)
+		{
+			options.computeAdjacency = true;
+		}
+		else if (strcmp(arg, "--edges") == 0)
+		{
+			options.computeEdges = true;
+		}
+		else if (strcmp(arg, "--no-16bit-indices") == 0)
+		{
+			options.allow16BitIndices = false;
+		}
+		else if (strcmp(arg, "--vertex-layout") == 0)
+		{
+			const int idx = (value != nullptr) ? FindName(value, layoutsNames, 4) : -1;
+			usesValue = isValid = (idx >= 0);
+			options.vertexLayout = (VERTEX_LAYOUT)(std::max)(idx, 0);
+		}
+		else if (strcmp(arg, "--tiles") == 0)
+		{
+			const int idx = (value != nullptr) ? FindName(value, tilingNames, 3) : -1;
+			usesValue = isValid = (idx >= 0);
+			options.tilingMode = (TILING_MODE)(std::max)(idx, 0);
+		}
+		else if (strcmp(arg, "--instances") == 0)
+		{
+			options.detectInstances = true;
+		}
+		else if (strcmp(arg, "--ao") == 0)
+		{
+			options.bakeAmbientOcclusion = true;
+		}
+		else if (strcmp(arg, "--ao-rays") == 0)
+		{
+			usesValue = isValid = (value != nullptr) && (atoi(value) > 0);
+			options.ambientOcclusionRaysCount = isValid ? (unsigned int)atoi(value) : 0;
+		}
+		else if (strcmp(arg, "--ao-distance") == 0)
+		{
+			usesValue = isValid = (value != nullptr) && (atof(value) >= 0.0);
+			options.ambientOcclusionMaxDistance = isValid ? (float)atof(value) : 0.0f;
+		}
+		else if (strcmp(arg, "--compress") == 0)
+		{
+			options.compressStreams = true;
+		}
+		else if (strcmp(arg, "--trace") == 0)
+		{
+			usesValue = isValid = (value != nullptr);
+			traceFilename = isValid ? value : "";
+		}
+		else
+		{
+			std::cout << "unknown option: " << arg << std::endl;
+			return false;
+		}
+
+		if (!isValid)
+		{
+			std::cout << "invalid value of the option " << arg << ": " << ((value != nullptr) ? value : "(none)") << std::endl;
+			return false;
+		}
+
+		if (usesValue)
+			i++;
+	}
+
+	return true;
+}
+
+
+// make a job per model file; a directory is converted into the output directory with the same tree
+static bool CollectJobs(const fs::path & input, const fs::path & output, std::vector<CONVERSION_JOB> & jobs)
+{
+	std::error_code error;
+
+	if (!fs::is_directory(input, error))
+	{
+		CONVERSION_JOB job;
+		job.inputFile = input;
+		job.outputFile = output.empty() ? fs::path(input).replace_extension(".txt") : output;
+		job.size = fs::file_size(input, error);
+
+		if (error)
+		{
+			std::cout << "can't open the input file: " << input.string() << std::endl;
+			return false;
+		}
+
+		if (fs::equivalent(job.inputFile, job.outputFile, error))
+		{
+			std::cout << "the output file is the input file: " << input.string() << std::endl;
+			return false;
+		}
+
+		jobs.push_back(job);
+		return true;
+	}
+
+	const fs::path outputDirectory = output.empty() ? input : output;
+
+	for (fs::recursive_directory_iterator it(input, error), end; !error && (it != end); it.increment(error))
+	{
+		if (!it->is_regular_file(error) || !IsModelFile(it->path()))
+			continue;
+
+		CONVERSION_JOB job;
+		job.inputFile = it->path();
+		job.outputFile = (outputDirectory / fs::relative(it->path(), input, error)).replace_extension(".txt");
+		job.size = it->file_size(error);
+		jobs.push_back(job);
+	}
+
+	if (error)
+	{
+		std::cout << "can't read the input directory: " << input.string() << " (" << error.message() << ")" << std::endl;
+		return false;
+	}
+
+	// the models which differ only by the extension (a.obj, a.ply) would be converted into the same output file
+	std::vector<const CONVERSION_JOB*> sortedJobs;
+	bool hasClashes = false;
+
+	for (const CONVERSION_JOB & job : jobs)
+		sortedJobs.push_back(&job);
+
+	std::sort(sortedJobs.begin(), sortedJobs.end(), [](const CONVERSION_JOB* a, const CONVERSION_JOB* b)
+	{
+		return a->outputFile < b->outputFile;
+	});
+
+	for (size_t first = 0, last = 0; first < sortedJobs.size(); first = last)
+	{
+		for (last = first + 1; (last < sortedJobs.size()) && (sortedJobs[last]->outputFile == sortedJobs[first]->outputFile); last++)
+		{
+		}
+
+		if (last - first < 2)
+			continue;
+
+		std::cout << "several input files have the same output file " << sortedJobs[first]->outputFile.string() << ":" << std::endl;
+
+		for (size_t idx = first; idx < last; idx++)
+			std::cout << "  " << sortedJobs[idx]->inputFile.string() << std::endl;
+
+		hasClashes = true;
+	}
+
+	if (hasClashes)
+		return false;
+
+	// the biggest files go first so the last ones to finish are small
+	std::stable_sort(jobs.begin(), jobs.end(), [](const CONVERSION_JOB & a, const CONVERSION_JOB & b)
+	{
+		return a.size > b.size;
+	});
+
+	return true;
+}
+
+
+int main(int argc, char** argv)
+{
+	ConversionOptions options;
+	size_t jobsCount = 0;
+	std::string traceFilename;
+	std::vector<std::string> paths;
+
+	if (!ParseArguments(argc, argv, options, jobsCount, traceFilename, paths) || paths.empty() || (paths.size() > 2))
+	{
+		PrintUsage();
+		return 2;
+	}
+
+	std::vector<CONVERSION_JOB> jobs;
+
+	if (!CollectJobs(paths[0], (paths.size() > 1) ? paths[1] : "", jobs))
+		return 1;
+
+	// the output directories are created before the conversions start
+	for (const CONVERSION_JOB & job : jobs)
+	{
+		std::error_code error;
+
+		if (job.outputFile.has_parent_path())
+			fs::create_directories(job.outputFile.parent_path(), error);
+	}
+
+	if (!traceFilename.empty() && !ModelConverter::StartTracing())
+		traceFilename.clear();
+
+	// each conversion uses several threads by itself so by default only a half of the hardware threads take files
+	const size_t workersCount = (std::min)(jobs.size(), (jobsCount > 0) ? jobsCount : (std::max)((size_t)1, GetWorkerThreadsCount() / 2));
+	const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+	std::atomic<size_t> nextJob{ 0 };
+	std::atomic<size_t> failedCount{ 0 };
+	std::vector<std::thread> workers;
+
+	auto Worker = [&]()
+	{
+		for (size_t idx = nextJob++; idx < jobs.size(); idx = nextJob++)
+		{
+			const std::string inputFilename = jobs[idx].inputFile.string();
+			const std::string outputFilename = jobs[idx].outputFile.string();
+
+			if (!ModelConverter::ImportModelFromFileWithOptions(inputFilename.c_str(), outputFilename.c_str(), &options))
+				failedCount++;
+		}
+	};
+
+	for (size_t idx = 1; idx < workersCount; idx++)
+		workers.emplace_back(Worker);
+
+	Worker();
+
+	for (std::thread & worker : workers)
+		worker.join();
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	uintmax_t totalSize = 0;
+
+	for (const CONVERSION_JOB & job : jobs)
+		totalSize += job.size;
+
+	if (!traceFilename.empty())
+		ModelConverter::StopTracing(traceFilename.c_str());
+
+	printf("converted %u of %u files (%.1f MB) in %.2f s (%.1f MB/s) with %u workers\n",
+		(unsigned int)(jobs.size() - failedCount),
+		(unsigned int)jobs.size(),
+		(double)totalSize / (1 << 20),
+		seconds,
+		(seconds > 0.0) ? (double)totalSize / (1 << 20) / seconds : 0.0,
+		(unsigned int)workersCount);
+
+	return (failedCount == 0) ? 0 : 1;
+}
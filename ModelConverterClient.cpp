@@ -0,0 +1,231 @@
+#include "ModelConverterClient.h"
+#include "ModelConverterServiceProtocol.h"
+
+#include <iostream>
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <cstring>
+#include <filesystem>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+static std::string serviceSocketPath{ MODEL_CONVERTER_SERVICE_DEFAULT_SOCKET };
+static std::mutex serviceSocketPathMutex;
+
+
+// ----------------------------------------------------------------------------------- //
+//
+//                          HELPERS
+//
+// ----------------------------------------------------------------------------------- //
+
+#ifndef _WIN32
+
+static bool WriteAll(const int fd, const void* pData, const size_t size)
+{
+	const char* ptr = static_cast<const char*>(pData);
+
+	for (size_t writtenSize = 0; writtenSize < size; )
+	{
+		const ssize_t result = send(fd, ptr + writtenSize, size - writtenSize, MSG_NOSIGNAL);
+
+		if (result <= 0)
+			return false;
+
+		writtenSize += (size_t)result;
+	}
+
+	return true;
+}
+
+static bool ReadAll(const int fd, void* pData, const size_t size)
+{
+	char* ptr = static_cast<char*>(pData);
+
+	for (size_t readSize = 0; readSize < size; )
+	{
+		const ssize_t result = read(fd, ptr + readSize, size - readSize);
+
+		if (result <= 0)
+			return false;
+
+		readSize += (size_t)result;
+	}
+
+	return true;
+}
+
+
+// send the request to the service and wait for its response
+static bool SendRequest(const MODEL_CONVERTER_REQUEST_TYPE type,
+	const std::string & input,
+	const std::string & outputFilename,
+	const ConversionOptions* pOptions)
+{
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	{
+		std::lock_guard<std::mutex> lock(serviceSocketPathMutex);
+		strncpy(address.sun_path, serviceSocketPath.c_str(), sizeof(address.sun_path) - 1);
+	}
+
+	const int socketFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+	if (socketFd < 0)
+		return false;
+
+	if (connect(socketFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+	{
+		std::cout << "can't connect to the conversion service: " << address.sun_path << std::endl;
+		close(socketFd);
+		return false;
+	}
+
+	const ConversionOptions options = (pOptions != nullptr) ? *pOptions : ConversionOptions();
+
+	MODEL_CONVERTER_REQUEST_HEADER header;
+	header.type = type;
+	header.inputSize = (uint32_t)input.size();
+	header.outputSize = (uint32_t)outputFilename.size();
+
+	MODEL_CONVERTER_RESPONSE response;
+	response.magic = 0;
+
+	const bool isSent =
+		WriteAll(socketFd, &header, sizeof(header)) &&
+		WriteAll(socketFd, &options, sizeof(options)) &&
+		WriteAll(socketFd, input.data(), input.size()) &&
+		WriteAll(socketFd, outputFilename.data(), outputFilename.size()) &&
+		ReadAll(socketFd, &response, sizeof(response));
+
+	close(socketFd);
+
+	return isSent && (response.magic == MODEL_CONVERTER_SERVICE_MAGIC) && (response.result != 0);
+}
+
+
+// the service has its own working directory so we pass absolute paths
+static std::string GetAbsolutePath(const char* filename)
+{
+	std::error_code errorCode;
+	const std::filesystem::path absolutePath = std::filesystem::absolute(filename, errorCode);
+
+	return errorCode ? std::string(filename) : absolutePath.string();
+}
+
+#endif
+
+
+
+// ----------------------------------------------------------------------------------- //
+//
+//                          PUBLIC FUNCTIONS
+//
+// ----------------------------------------------------------------------------------- //
+
+void ModelConverterClient::SetServiceSocketPath(const char* socketPath)
+{
+	std::lock_guard<std::mutex> lock(serviceSocketPathMutex);
+	serviceSocketPath = socketPath;
+}
+
+
+bool ModelConverterClient::ImportModelFromFile(
+	const char* inputFilename,      // path to the model's input data file 
+	const char* outputFilename)     // path to the model's output data file
+{
+	return ModelConverterClient::ImportModelFromFileWithOptions(inputFilename, outputFilename, nullptr);
+}
+
+
+bool ModelConverterClient::ImportModelFromFileWithOptions(
+	const char* inputFilename,      // path to the model's input data file 
+	const char* outputFilename,     // path to the model's output data file
+	const ConversionOptions* pOptions)  // options of the conversion (nullptr -- default options)
+{
+#ifdef _WIN32
+	std::cout << "the conversion service isn't supported on Windows" << std::endl;
+	return false;
+#else
+	const bool result = SendRequest(MODEL_CONVERTER_REQUEST_CONVERT_FILE,
+		GetAbsolutePath(inputFilename),
+		GetAbsolutePath(outputFilename),
+		pOptions);
+
+	if (!result)
+	{
+		std::cout << "can't convert a model by file:\n" << inputFilename << std::endl;
+		return false;
+	}
+
+	return true;
+#endif
+}
+
+
+// the data is copied into a new shared memory object which is removed after the conversion
+bool ModelConverterClient::ImportModelFromBuffer(
+	const void* pInputData,         // the input file's data
+	const size_t inputDataSize,
+	const char* inputExtension,     // the input file's extension (like ".obj") is used to detect its format
+	const char* outputFilename,     // path to the model's output data file
+	const ConversionOptions* pOptions)  // options of the conversion (nullptr -- default options)
+{
+#ifdef _WIN32
+	std::cout << "the conversion service isn't supported on Windows" << std::endl;
+	return false;
+#else
+	static std::atomic<unsigned int> buffersCounter{ 0 };
+
+	const std::string sharedMemoryName = "/model_converter_" + std::to_string(getpid()) + "_" +
+		std::to_string(buffersCounter++) + ((inputExtension != nullptr) ? inputExtension : "");
+
+	const int sharedMemoryFd = shm_open(sharedMemoryName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+
+	if (sharedMemoryFd < 0)
+	{
+		std::cout << "can't create the shared memory object: " << sharedMemoryName << std::endl;
+		return false;
+	}
+
+	bool result = (ftruncate(sharedMemoryFd, (off_t)inputDataSize) == 0);
+
+	if (result && (inputDataSize > 0))
+	{
+		void* pSharedMemory = mmap(nullptr, inputDataSize, PROT_WRITE, MAP_SHARED, sharedMemoryFd, 0);
+		result = (pSharedMemory != MAP_FAILED);
+
+		if (result)
+		{
+			memcpy(pSharedMemory, pInputData, inputDataSize);
+			munmap(pSharedMemory, inputDataSize);
+		}
+	}
+
+	close(sharedMemoryFd);
+
+	result = result && SendRequest(MODEL_CONVERTER_REQUEST_CONVERT_SHARED_MEMORY,
+		sharedMemoryName,
+		GetAbsolutePath(outputFilename),
+		pOptions);
+
+	shm_unlink(sharedMemoryName.c_str());
+
+	if (!result)
+	{
+		std::cout << "can't convert a model from the buffer" << std::endl;
+		return false;
+	}
+
+	return true;
+#endif
+}
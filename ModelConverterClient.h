@@ -0,0 +1,41 @@
+/////////////////////////////////////////////////////////////////////
+// Filename:     ModelConverterClient.h
+// Description:  a thin client of the resident conversion service
+//               (ModelConverterServiceClass); the functions have the
+//               same semantics as the DLL's functions but the models
+//               are converted by the service; the client doesn't
+//               depend on the converter itself (and on its log)
+//
+//               the client is available on POSIX systems only
+//
+// Created:      19.10.26
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "ConversionOptions.h"
+
+#include <cstddef>
+
+
+namespace ModelConverterClient
+{
+	// set a path of the service's socket (MODEL_CONVERTER_SERVICE_DEFAULT_SOCKET by default)
+	void SetServiceSocketPath(const char* socketPath);
+
+	bool ImportModelFromFile(
+		const char* inputFilename,      // path to the model's input data file 
+		const char* outputFilename);    // path to the model's output data file
+
+	bool ImportModelFromFileWithOptions(
+		const char* inputFilename,      // path to the model's input data file 
+		const char* outputFilename,     // path to the model's output data file
+		const ConversionOptions* pOptions);  // options of the conversion (nullptr -- default options)
+
+	// the input file's data is passed to the service through the shared memory
+	bool ImportModelFromBuffer(
+		const void* pInputData,         // the input file's data
+		const size_t inputDataSize,
+		const char* inputExtension,     // the input file's extension (like ".obj") is used to detect its format
+		const char* outputFilename,     // path to the model's output data file
+		const ConversionOptions* pOptions);  // options of the conversion (nullptr -- default options)
+}
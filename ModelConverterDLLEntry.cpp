@@ -3,15 +3,38 @@
 #include "ModelConverterDLLEntry.h"
 #include "ModelConverterInterface.h"
 #include "ModelConverterForObjTypeClass.h"
+#include "ModelWatcherClass.h"
+#include "ModelConverterServiceClass.h"
+#include "TraceRecorderClass.h"
 #include "Log.h"
 
 #include <iostream>
 #include <cassert>
+#include <memory>
+#include <mutex>
+
+
+static Log logSystem;                                       // the log system of the library (clients which include the DLL's header don't create their own one)
+
+static std::unique_ptr<ModelWatcherClass> pModelWatcher;    // is created by the first call of StartWatchingDirectory()
+static std::mutex modelWatcherMutex;
+
+static ModelConverterServiceClass* pConversionService = nullptr;   // is set while RunConversionService() is running
+static std::mutex conversionServiceMutex;
 
 
 bool ModelConverter::ImportModelFromFile(
 	const char* inputFilename,      // full path to the model's input data file 
 	const char* outputFilename)     // full path to the model's output data file
+{
+	return ModelConverter::ImportModelFromFileWithOptions(inputFilename, outputFilename, nullptr);
+}
+
+
+bool ModelConverter::ImportModelFromFileWithOptions(
+	const char* inputFilename,      // full path to the model's input data file 
+	const char* outputFilename,     // full path to the model's output data file
+	const ConversionOptions* pOptions)  // options of the conversion (nullptr -- default options)
 {
 	// check input data
 	assert((inputFilename != nullptr) && (inputFilename[0] != '\0'));
@@ -22,7 +45,9 @@ bool ModelConverter::ImportModelFromFile(
 
 	//Log::Debug("\n\n\n-----   START OF THE CONVERTATION PROCESS:   -----\n";
 
-	bool result = pModelConverter->Convert(inputFilename, outputFilename);
+	const ConversionOptions options = (pOptions != nullptr) ? *pOptions : ConversionOptions();
+
+	bool result = pModelConverter->Convert(inputFilename, outputFilename, options);
 	if (!result)
 	{
 		std::cout << "can't convert a model by file:\n" << inputFilename << std::endl;
@@ -31,3 +56,82 @@ bool ModelConverter::ImportModelFromFile(
 
 	return true;
 }
+
+
+bool ModelConverter::StartWatchingDirectory(
+	const char* inputDirectory,     // full path to the directory with .obj files
+	const char* outputDirectory,    // full path to the directory for the output data files
+	const ConversionOptions* pOptions)  // options of the conversion (nullptr -- default options)
+{
+	assert((inputDirectory != nullptr) && (inputDirectory[0] != '\0'));
+	assert((outputDirectory != nullptr) && (outputDirectory[0] != '\0'));
+
+	std::lock_guard<std::mutex> lock(modelWatcherMutex);
+
+	if (!pModelWatcher)
+	{
+		const ConversionOptions options = (pOptions != nullptr) ? *pOptions : ConversionOptions();
+		pModelWatcher = std::make_unique<ModelWatcherClass>(options);
+	}
+
+	return pModelWatcher->AddDirectory(inputDirectory, outputDirectory) && pModelWatcher->Start();
+}
+
+
+void ModelConverter::StopWatchingDirectories()
+{
+	std::lock_guard<std::mutex> lock(modelWatcherMutex);
+	pModelWatcher.reset();
+}
+
+
+bool ModelConverter::RunConversionService(
+	const char* socketPath,         // path to the socket file
+	const unsigned int workersCount)   // how many requests are handled at the same time (0 -- by the hardware)
+{
+	ModelConverterServiceClass service(workersCount);
+	{
+		std::lock_guard<std::mutex> lock(conversionServiceMutex);
+
+		if (pConversionService != nullptr)
+		{
+			Log::Error(LOG_MACRO, "the conversion service is already running");
+			return false;
+		}
+
+		pConversionService = &service;
+	}
+
+	const bool result = service.Run((socketPath != nullptr) ? socketPath : MODEL_CONVERTER_SERVICE_DEFAULT_SOCKET);
+
+	std::lock_guard<std::mutex> lock(conversionServiceMutex);
+	pConversionService = nullptr;
+
+	return result;
+}
+
+
+void ModelConverter::StopConversionService()
+{
+	std::lock_guard<std::mutex> lock(conversionServiceMutex);
+
+	if (pConversionService != nullptr)
+		pConversionService->Stop();
+}
+
+
+bool ModelConverter::StartTracing()
+{
+	return TraceRecorderClass::Start();
+}
+
+bool ModelConverter::StopTracing(const char* traceFilename)
+{
+	if (traceFilename == nullptr)
+	{
+		Log::Error(LOG_MACRO, "the trace file name is empty");
+		return false;
+	}
+
+	return TraceRecorderClass::Stop(traceFilename);
+}
@@ -1,26 +1,20 @@
 #pragma once
 
 #include "Log.h"
+#include "ConversionOptions.h"
 
 namespace ModelConverter
 {
-	// when the MODEL_CONVERTER_DLL_EXPORTS macro is defined, the MODEL_CONVERTER_API
-	// macro sets the __declspec(dllexport) modifier on the function declarations. This
-	// modifier tells the compiler and linker to export a function or variable from the DLL
-	// for use by other applications. Then MODEL_CONVERTER_DLL_EXPORTS is undefined, for 
-	// example, wneh the header file is included by a client application,
-	// MODEL_CONVERTER_API applies the __declspec(dllimport) modifier to the declarations.
-	// This modifier optimizes the import of the function or variable in an application.
+	// when the MODEL_CONVERTER_DLL_ENTRY_EXPORTS macro is defined (while the library itself is
+	// built) the functions are exported from the DLL / shared library; when the header file
+	// is included by a client application the functions are imported (see Platform.h)
 	#ifdef MODEL_CONVERTER_DLL_ENTRY_EXPORTS
-		#define MODEL_CONVERTER_API __declspec(dllexport)
+		#define MODEL_CONVERTER_API MODEL_CONVERTER_EXPORT
 	#else
-		#define MODEL_CONVERTER_API __declspec(dllimport)
+		#define MODEL_CONVERTER_API MODEL_CONVERTER_IMPORT
 	#endif
 
 
-	static Log log;
-
-
 	// DEFINE THE DLL's INTERFACE
 
 	//#ifdef __cplusplus    // if used by C++ code,
@@ -32,6 +26,37 @@ namespace ModelConverter
 		const char* inputFilename,      // full path to the model's input data file 
 		const char* outputFilename);    // full path to the model's output data file
 
+	extern "C" MODEL_CONVERTER_API bool ImportModelFromFileWithOptions(
+		const char* inputFilename,      // full path to the model's input data file 
+		const char* outputFilename,     // full path to the model's output data file
+		const ConversionOptions* pOptions);  // options of the conversion (nullptr -- default options)
+
+	// start watching of the directory: changed .obj files are reconverted in the background
+	// into the output directory (the options of the first call are used for all the directories)
+	extern "C" MODEL_CONVERTER_API bool StartWatchingDirectory(
+		const char* inputDirectory,     // full path to the directory with .obj files
+		const char* outputDirectory,    // full path to the directory for the output data files
+		const ConversionOptions* pOptions);  // options of the conversion (nullptr -- default options)
+
+	// stop watching of all the directories
+	extern "C" MODEL_CONVERTER_API void StopWatchingDirectories();
+
+	// run the resident conversion service on the Unix domain socket (nullptr -- the default socket);
+	// returns when StopConversionService() is called (see ModelConverterClient for the client side)
+	extern "C" MODEL_CONVERTER_API bool RunConversionService(
+		const char* socketPath,         // path to the socket file
+		const unsigned int workersCount);  // how many requests are handled at the same time (0 -- by the hardware)
+
+	extern "C" MODEL_CONVERTER_API void StopConversionService();
+
+	// start recording of the trace events of all the conversions (on all the threads);
+	// returns false if the events are compiled out (see TraceRecorderClass.h)
+	extern "C" MODEL_CONVERTER_API bool StartTracing();
+
+	// stop recording and write the events into the Chrome trace JSON file
+	extern "C" MODEL_CONVERTER_API bool StopTracing(
+		const char* traceFilename);     // full path to the trace file (.json)
+
 	//#ifdef __cplusplus    // if used by C++ code,
 	//	}                 // the end of "extern C" declaration
 	//#endif
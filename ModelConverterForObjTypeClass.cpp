@@ -1,7 +1,26 @@
 #include "ModelConverterForObjTypeClass.h"
+#include "MeshOptimizerClass.h"
+#include "ModelWriterClass.h"
+#include "TraceRecorderClass.h"
 
 #include <cstdio>   // for using a remove() method for deleting files
 #include <cassert>
+#include <cstring>
+#include <algorithm>
+#include <limits>
+
+
+// returns a name which is stored in the line after some keyword (for instance: "usemtl ");
+// we cut off the trailing spaces and '\r' symbol (if the file has Windows line endings)
+static std::string GetNameFromLine(const char* str)
+{
+	std::string name{ str };
+
+	size_t lastSymbolPos = name.find_last_not_of(" \t\r");
+	name.erase((lastSymbolPos == std::string::npos) ? 0 : lastSymbolPos + 1);
+
+	return name;
+}
 
 
 ModelConverterForObjTypeClass::ModelConverterForObjTypeClass(void)
@@ -34,11 +53,18 @@ ModelConverterForObjTypeClass::~ModelConverterForObjTypeClass(void)
 
 
 // converts a model of the ".obj" type into the internal model format
-bool ModelConverterForObjTypeClass::ConvertFromObj(const char* inputFilename, const char* outputFilename)
+bool ModelConverterForObjTypeClass::ConvertFromObj(const char* inputFilename, const char* outputFilename,
+	const ConversionOptions & options)
 {
+	TRACE_SCOPE("ConvertFromObj");
+	TRACE_ARG("file", inputFilename);
+
 	// print names of the input/output file
 	this->PrintIOFilenames(inputFilename, outputFilename);
 
+	// the file is read by several passes so start reading it into the page cache right away
+	Platform::AdviseSequentialRead(inputFilename);
+
 	// open the input file and create an output file
 	std::ifstream fin(inputFilename, std::ios::in | std::ios::binary);	// input data file (.obj)
 	std::ofstream fout(outputFilename, std::ios::out);                  // ouptput data file (.txt)
@@ -62,7 +88,7 @@ bool ModelConverterForObjTypeClass::ConvertFromObj(const char* inputFilename, co
 	}
 	
 	// convert the model
-	bool result = this->ConvertFromObjHelper(fin, fout);
+	bool result = this->ConvertFromObjHelper(fin, fout, outputFilename, options);
 	if (!result)
 	{
 		Log::Error(LOG_MACRO, "can't convert model's data from .obj type");
@@ -104,10 +130,21 @@ void ModelConverterForObjTypeClass::PrintIOFilenames(const char* inputFilename,
 // ----------------------------------------------------------------------------------- //
 
 // help us to convert .obj file model data into the internal model format
-bool ModelConverterForObjTypeClass::ConvertFromObjHelper(ifstream& fin, ofstream& fout)
+bool ModelConverterForObjTypeClass::ConvertFromObjHelper(ifstream& fin, ofstream& fout, const char* outputFilename, const ConversionOptions & options)
 {
 	bool result = false;
 
+	// reset the state of the previous conversion (the converter can be used many times)
+	verticesCount_ = 0;
+	textureCoordsCount_ = 0;
+	normalsCount_ = 0;
+	facesCount_ = 0;
+	linesCount_ = 0;
+	lineOfNormalsData_ = 0;
+	initialGroupName_.clear();
+	inputLineBuffer_[0] = '\0';
+	mesh_.Clear();
+
 	// read the count of vertices, textures coordinates and the count of faces as well
 	this->ReadCounts(fin);
 
@@ -134,30 +171,24 @@ bool ModelConverterForObjTypeClass::ConvertFromObjHelper(ifstream& fin, ofstream
 #endif
 
 
-	// write the number of vertices/indices/texture coords into the output data file
-	fout << "Vertex Count: " << verticesCount_ << "\n";
-	fout << "Indices Count: " << facesCount_ * 3 << "\n";         // each face has 3 vertices
-	fout << "Textures Count: " << textureCoordsCount_ << "\n\n";
-
-
 	// because earlier we've went up to the end of the file (EOF) 
 	// during reading of counts we have to clear ifstream state
 	fin.clear();
 	fin.seekg(0, fin.beg);   // go to the beginning of the file
 
 	// handle vertices data
-	if (!ReadInAndWriteVerticesData(fin, fout))
+	if (!ReadInVerticesData(fin))
 	{
-		Log::Error(LOG_MACRO, "can't read/write vertices data");
+		Log::Error(LOG_MACRO, "can't read in vertices data");
 		return false;
 	}
 	Log::Debug(LOG_MACRO, "VERTICES DATA WAS HANDLED CORRECTLY");
 
 
 	// handle texture coords data
-	if (!ReadInAndWriteTexturesData(fin, fout))
+	if (!ReadInTexturesData(fin))
 	{
-		Log::Error(LOG_MACRO, "can't read/write textures data");
+		Log::Error(LOG_MACRO, "can't read in textures data");
 		return false;
 	}
 	Log::Debug(LOG_MACRO, "TEXTURE DATA WAS HANDLED CORRECTLY");
@@ -187,14 +218,20 @@ bool ModelConverterForObjTypeClass::ConvertFromObjHelper(ifstream& fin, ofstream
 	// the end of the file (EOF) we have to clear ifstream state
 	fin.clear();             
 
-	// write faces data
-	if (!this->WriteIndicesIntoOutputFile(fout))
+	// execute the common processing stages (mesh cleanup, submeshes sorting, etc.)
+	if (!MeshOptimizerClass(options).Run(mesh_))
 	{
-		Log::Error(LOG_MACRO, "can't read/write indices data");
+		Log::Error(LOG_MACRO, "can't process the mesh data");
+		return false;
+	}
+
+	// write all the data into the output file
+	if (!ModelWriterClass(options).WriteIntoOutputFile(mesh_, fout, outputFilename))
+	{
+		Log::Error(LOG_MACRO, "can't write data into the output file");
 		return false;
 	}
 
-	Log::Debug(LOG_MACRO, "FACES DATA WAS WRITTEN SUCCESSFULLY");
 	Log::Debug(LOG_MACRO, "-----   CONVERTATION IS FINISHED   -----");
 
 	// put two empty lines in the log file to separate this convertation's log from the other
@@ -215,10 +252,23 @@ void ModelConverterForObjTypeClass::SkipUntilVerticesData(ifstream & fin)
 	{
 		posBeforeVerticesData = fin.tellg();                                  // store the position in input sequence
 		fin.getline(inputLineBuffer_, ModelConverterForObjTypeClass::INPUT_LINE_SIZE_); // get a line from the file						
+		linesCount_++;
+
+		// remember the materials library and the group/object which is declared before vertices data
+		if (strncmp(inputLineBuffer_, "mtllib ", 7) == 0)
+		{
+			mesh_.materialLibName = GetNameFromLine(inputLineBuffer_ + 7);
+		}
+		else if (((inputLineBuffer_[0] == 'o') || (inputLineBuffer_[0] == 'g')) && (inputLineBuffer_[1] == ' '))
+		{
+			initialGroupName_ = GetNameFromLine(inputLineBuffer_ + 2);
+		}
 	}
 
 	// we got to the vertices data so return a stream pointer to the position right before the vertices data
+	// (the first line of the vertices data will be read once more)
 	fin.seekg(posBeforeVerticesData);
+	linesCount_--;
 
 	return;
 }
@@ -227,14 +277,18 @@ void ModelConverterForObjTypeClass::SkipUntilVerticesData(ifstream & fin)
 // read the count of vertices, textures coordinates and the count of faces as well
 void ModelConverterForObjTypeClass::ReadCounts(ifstream & fin)
 {
+	TRACE_SCOPE("ReadCounts");
+
 	this->SkipUntilVerticesData(fin);
 
 	posBeforeVerticesData_ = fin.tellg();	 // later we'll return to this position so save it
 	fin.getline(inputLineBuffer_, INPUT_LINE_SIZE_); // read the first line of vertices data
+	linesCount_++;
 
 
 	this->CalculateCount(fin, verticesCount_, posBeforeTexturesData_, "VERTICES", "v ", "vt");
 	this->CalculateCount(fin, textureCoordsCount_, posBeforeNormalsData_, "TEXTURES", "vt", "vn");
+	lineOfNormalsData_ = linesCount_;    // the current line is the one at posBeforeNormalsData_
 	this->CalculateCount(fin, normalsCount_, posBeforeFacesData_, "NORMALS", "vn", "f");
 
 	// calculate the number of faces in a separate way because faces data can be
@@ -248,6 +302,10 @@ void ModelConverterForObjTypeClass::ReadCounts(ifstream & fin)
 		fin.getline(inputLineBuffer_, INPUT_LINE_SIZE_);
 	}
 
+	TRACE_ARG("vertices", verticesCount_);
+	TRACE_ARG("texture_coords", textureCoordsCount_);
+	TRACE_ARG("faces", facesCount_);
+
 	return;
 }
 
@@ -255,7 +313,7 @@ void ModelConverterForObjTypeClass::ReadCounts(ifstream & fin)
 // calculate counts for some particular data block 
 // (for instance: count of vertices, position before the next block, etc.)
 void ModelConverterForObjTypeClass::CalculateCount(ifstream & fin,
-	int & countOfData,               // 1. how many lines this block of data has
+	size_t & countOfData,            // 1. how many lines this block of data has
 	streampos & posBeforeNextBlock,  // 2. file ptr position right before next block of data
 	std::string dataType,            // 3. which type of data we're reading from the current data block
 	std::string prefix,              // 4. each line of the current data block starts with this prefix
@@ -269,6 +327,7 @@ void ModelConverterForObjTypeClass::CalculateCount(ifstream & fin,
 			countOfData++;
 			//std::cout << inputLineBuffer_ << "\n";
 			fin.getline(inputLineBuffer_, INPUT_LINE_SIZE_);
+			linesCount_++;
 		}
 		
 		// skip lines until the next block of data
@@ -277,6 +336,7 @@ void ModelConverterForObjTypeClass::CalculateCount(ifstream & fin,
 		{
 			// std::cout << "skip line: " << inputLineBuffer_ << std::endl;   // for debug purpose
 			fin.getline(inputLineBuffer_, INPUT_LINE_SIZE_);
+			linesCount_++;
 		}
 
 		// calculate the file ptr position right before the next data block
@@ -296,17 +356,22 @@ void ModelConverterForObjTypeClass::CalculateCount(ifstream & fin,
 
 
 // in this function we read in vertices data from the input data file 
-// and right after it we write this data into the output data file
-bool ModelConverterForObjTypeClass::ReadInAndWriteVerticesData(ifstream & fin, ofstream & fout)
+bool ModelConverterForObjTypeClass::ReadInVerticesData(ifstream & fin)
 {
+	TRACE_SCOPE("ReadInVerticesData");
+	TRACE_ARG("begin_byte", (int64_t)posBeforeVerticesData_);
+	TRACE_ARG("end_byte", (int64_t)posBeforeTexturesData_);
+	TRACE_ARG("count", verticesCount_);
+
 	char input;                              // for reading the '\n' symbol
 	VERTEX3D  vertex3D;                      // will contain vertex data
 
 	try
 	{
 		fin.seekg(posBeforeVerticesData_);   // return to the position before the vertices data 
-		fout << "\nVertices Data:\n";        // write into the output file that the following data block is vertices data
 
+		mesh_.vertices.clear();
+		mesh_.vertices.reserve(verticesCount_);
 
 		for (size_t i = 0; i < verticesCount_; i++)
 		{
@@ -314,56 +379,48 @@ bool ModelConverterForObjTypeClass::ReadInAndWriteVerticesData(ifstream & fin, o
 			fin.ignore(1);                                              // skip the "v" symbol at the beginning of the line
 			fin >> vertex3D.x >> vertex3D.y >> vertex3D.z >> input;     // read in x, y, z vertex coordinates and the '\n' symbol
 
-			fout.setf(ios::fixed, ios::floatfield);
-			fout.precision(6);
-
-			// write this vertex coordinates into the output data file
-			fout << vertex3D.x << " " 
-				 << vertex3D.y << " "
-				 << vertex3D.z * -1.0f    // invert the value to use it in the left handed coordinate system
-				 << "\n";
+			vertex3D.z *= -1.0f;    // invert the value to use it in the left handed coordinate system
+			mesh_.vertices.push_back(vertex3D);
 		}
-
-		fout << "\n\n";                   // in the output data file: make a separation space before the next data block 
 	}
 	catch (std::ifstream::failure & e)
 	{
-		Log::Error(LOG_MACRO, "Exception reading/writing file:");
+		Log::Error(LOG_MACRO, "Exception reading file:");
 		Log::Error(LOG_MACRO, e.what());
 	}
 
 	return true;
 }
 
-bool ModelConverterForObjTypeClass::ReadInAndWriteTexturesData(ifstream & fin, ofstream & fout)
+bool ModelConverterForObjTypeClass::ReadInTexturesData(ifstream & fin)
 {
+	TRACE_SCOPE("ReadInTexturesData");
+	TRACE_ARG("begin_byte", (int64_t)posBeforeTexturesData_);
+	TRACE_ARG("end_byte", (int64_t)posBeforeNormalsData_);
+	TRACE_ARG("count", textureCoordsCount_);
+
 	TEXTURE_COORDS texCoords;
 	std::string vt{ "" };          // we will write here "vt" symbols in the beginning of the line
 	
 	try
 	{
 		fin.seekg(posBeforeTexturesData_, fin.beg);    // return to the position before the textures data 
-		fout << "\nTextures Data:\n";                  // write into the output file that the following data block is textures data
+
+		mesh_.texCoords.clear();
+		mesh_.texCoords.reserve(textureCoordsCount_);
 
 		for (size_t i = 0; i < textureCoordsCount_; i++)
 		{
 			// read texture data from the input data file 
 			fin >> vt >> texCoords.tu >> texCoords.tv;    // read in texture coords data
 
-			fout.setf(ios::fixed, ios::floatfield);
-			fout.precision(6);
-
-			// write this texture coords data into the output data file
-			fout << texCoords.tu << " "
-				 << 1.0f - texCoords.tv       // invert the value to use it in the left handed coordinate system
-				 << "\n";
+			texCoords.tv = 1.0f - texCoords.tv;           // invert the value to use it in the left handed coordinate system
+			mesh_.texCoords.push_back(texCoords);
 		}
-
-		fout << "\n\n";                       // in the output data file: make a separation space before the next data block 
 	}
 	catch (std::ifstream::failure & e)
 	{
-		Log::Error(LOG_MACRO, "Exception reading/writing file:");
+		Log::Error(LOG_MACRO, "Exception reading file:");
 		Log::Error(LOG_MACRO, e.what());
 	}
 
@@ -411,27 +468,44 @@ bool ModelConverterForObjTypeClass::ReadInAndWriteNormalsData(ifstream& fin, ofs
 
 bool ModelConverterForObjTypeClass::ReadInFacesData(ifstream & fin)
 {
-	// clear the arrays if we had some data in it before
-	delete[] pVertexIndicesArray_;
-	delete[] pTextureIndicesArray_;
-	pVertexIndicesArray_ = nullptr;
-	pTextureIndicesArray_ = nullptr;
+	TRACE_SCOPE("ReadInFacesData");
+	TRACE_ARG("begin_byte", (int64_t)posBeforeNormalsData_);
+	TRACE_ARG("count", facesCount_);
 
-	// allocate memory for vertices/texture coords indices
-	pVertexIndicesArray_ = new UINT[facesCount_ * 3]{ 0 };   // each face has 3 vertices
-	pTextureIndicesArray_ = new UINT[facesCount_ * 3]{ 0 };  // each face has 3 texture coords
+	// clear the arrays if we had some data in it before
+	// and allocate memory for vertices/texture coords indices
+	mesh_.vertexIndices.clear();
+	mesh_.textureIndices.clear();
+	mesh_.vertexIndices.reserve(facesCount_ * 3);    // each face has 3 vertices
+	mesh_.textureIndices.reserve(facesCount_ * 3);   // each face has 3 texture coords
 
 
 	UINT vertexIndex = 0;
 	UINT textureIndex = 0;
 	UINT normalIndex = 0;
-	UINT arrayIndex = 0;
 
 	char slash{ ' ' };   // we'll write here a slash symbol
+	int lastSymbol = 0;  // a symbol right after the last vertex of the face
+	size_t lineNumber = lineOfNormalsData_ - 1;     // the number of the current line (for the validation reports)
+
+	// the current material and group/object of faces
+	std::string currMaterialName{ DEFAULT_MATERIAL_NAME_ };
+	std::string currGroupName{ initialGroupName_ };
+
+	// clear the submeshes data if we had some data before
+	mesh_.faceSubmeshIndices.clear();
+	mesh_.faceSubmeshIndices.reserve(facesCount_);
+	mesh_.faceSourceLines.clear();
+	mesh_.faceSourceLines.reserve(facesCount_);
+	mesh_.submeshes.clear();
+	mesh_.materialsNames.clear();
+	submeshesLookup_.clear();
 
 	inputLineBuffer_[0] = '\0';
 	
-	fin.seekg(posBeforeFacesData_, fin.beg);	// now we at the position before the beginning of polygonal face data
+	// the first "usemtl" line usually goes right after normals data (before
+	// the first face) so we start from the normals data block and skip its lines
+	fin.seekg(posBeforeNormalsData_, fin.beg);
 	fin.seekg(-1, fin.cur);
 	
 
@@ -439,10 +513,20 @@ bool ModelConverterForObjTypeClass::ReadInFacesData(ifstream & fin)
 	while (!fin.eof())
 	{
 		fin.getline(inputLineBuffer_, INPUT_LINE_SIZE_, '\n');
+		lineNumber++;
 
 		// if the current line doesn't contain data of a face we just skip this line
+		// (but we remember the current material and the current group/object)
 		if (inputLineBuffer_[0] != 'f')
 		{
+			if (strncmp(inputLineBuffer_, "usemtl ", 7) == 0)
+			{
+				currMaterialName = GetNameFromLine(inputLineBuffer_ + 7);
+			}
+			else if (((inputLineBuffer_[0] == 'o') || (inputLineBuffer_[0] == 'g')) && (inputLineBuffer_[1] == ' '))
+			{
+				currGroupName = GetNameFromLine(inputLineBuffer_ + 2);
+			}
 			//std::cout << "skip line: " << inputLineBuffer_ << std::endl;    // for debug purpose
 		}
 		// this line contains face data
@@ -455,6 +539,10 @@ bool ModelConverterForObjTypeClass::ReadInFacesData(ifstream & fin)
 			fin >> symbolsAtLineBeginning;
 
 			//std::cout << "symbols: " << symbolsAtLineBeginning << std::endl;
+
+			// this face belongs to the submesh with the current material and group
+			mesh_.faceSubmeshIndices.push_back(this->GetSubmeshIndex(currMaterialName, currGroupName));
+			mesh_.faceSourceLines.push_back((UINT)lineNumber);
 			
 			// go through each vertex of the current face
 			for (size_t faceVertex = 1; faceVertex <= 3; faceVertex++)
@@ -485,7 +573,7 @@ bool ModelConverterForObjTypeClass::ReadInFacesData(ifstream & fin)
 					return false;
 				}
 
-				fin.get();     // read up the space (or '\n') after each set of v/vt/vn
+				lastSymbol = fin.get();     // read up the space (or '\n') after each set of v/vt/vn
 
 
 				
@@ -494,11 +582,14 @@ bool ModelConverterForObjTypeClass::ReadInFacesData(ifstream & fin)
 				normalIndex--;
 
 				// write vertex/texture data into the vertex/texture indices arrays
-				pVertexIndicesArray_[arrayIndex] = vertexIndex;
-				pTextureIndicesArray_[arrayIndex] = textureIndex;
-				arrayIndex++;
+				mesh_.vertexIndices.push_back(vertexIndex);
+				mesh_.textureIndices.push_back(textureIndex);
 
 			} // for
+
+			// skip the rest of the line ('\r', trailing spaces, etc.) so each line is read once and the lines numbers are right
+			if ((lastSymbol != '\n') && (lastSymbol != EOF))
+				fin.ignore((std::numeric_limits<std::streamsize>::max)(), '\n');
 		} // else
 	} // while(!fin.eof())
 
@@ -506,33 +597,33 @@ bool ModelConverterForObjTypeClass::ReadInFacesData(ifstream & fin)
 }
 
 
-// write vertex/texture coords indices into the output data file
-bool ModelConverterForObjTypeClass::WriteIndicesIntoOutputFile(ofstream & fout)
+// returns an index of the submesh with such material and group/object;
+// if there is no such submesh we create it
+UINT ModelConverterForObjTypeClass::GetSubmeshIndex(const std::string & materialName, const std::string & groupName)
 {
-	// VERTEX INDICES WRITING
-	fout << "Vertex Indices Data:" << "\n\n";
+	const auto key = std::make_pair(materialName, groupName);
+	const auto it = submeshesLookup_.find(key);
 
-	for (size_t it = 0; it < facesCount_ * 3 - 2; it += 3)
-	{
-		fout << pVertexIndicesArray_[it + 2] << ' ';
-		fout << pVertexIndicesArray_[it + 1] << ' ';
-		fout << pVertexIndicesArray_[it] << endl;
-	}
-	fout.seekp(-1, ios::cur);
-	fout << "\n\n";
+	if (it != submeshesLookup_.end())
+		return it->second;
 
+	SUBMESH submesh;
+	submesh.materialName = materialName;
+	submesh.groupName = groupName.empty() ? DEFAULT_GROUP_NAME_ : groupName;
 
-	// TEXTURE INDICES WRITING
-	fout << "Texture Indices Data:" << "\n\n";
+	// find the material index (or register a new material)
+	std::vector<std::string> & materialsNames = mesh_.materialsNames;
+	const auto matIt = std::find(materialsNames.begin(), materialsNames.end(), materialName);
+	submesh.materialIndex = (UINT)std::distance(materialsNames.begin(), matIt);
 
-	for (size_t it = 0; it < facesCount_ * 3 - 2; it += 3)
-	{
-		fout << pTextureIndicesArray_[it + 2] << ' ';
-		fout << pTextureIndicesArray_[it + 1] << ' ';
-		fout << pTextureIndicesArray_[it] << endl;
-	}
+	if (matIt == materialsNames.end())
+		materialsNames.push_back(materialName);
 
-	return true;
+	const UINT submeshIndex = (UINT)mesh_.submeshes.size();
+	mesh_.submeshes.push_back(submesh);
+	submeshesLookup_.insert({ key, submeshIndex });
+
+	return submeshIndex;
 }
 
 
@@ -12,8 +12,9 @@
 //////////////////////////////////
 
 #include "Log.h"       // for using the log system
+#include "MeshData.h"
+#include "ConversionOptions.h"
 
-#include <windows.h>
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -21,6 +22,7 @@
 #include <vector>
 #include <memory>
 #include <string>
+#include <map>
 
 
 using namespace std;
@@ -35,10 +37,11 @@ public:
 	~ModelConverterForObjTypeClass(void);
 
 	// converts .obj file model data into the internal model format
-	bool ConvertFromObj(const char* inputFilename, const char* outputFilename);
+	bool ConvertFromObj(const char* inputFilename, const char* outputFilename,
+		const ConversionOptions & options = ConversionOptions());
 
 private:
-	bool ConvertFromObjHelper(ifstream & fin, ofstream & fout);
+	bool ConvertFromObjHelper(ifstream & fin, ofstream & fout, const char* outputFilename, const ConversionOptions & options);
 
 	// input data file reading handlers  
 	void SkipUntilVerticesData(ifstream & fin);
@@ -47,7 +50,7 @@ private:
 
 	// calculate counts for particular data block
 	void CalculateCount(ifstream & fin,
-		int & countOfData,               // 1. how many lines this block of data has
+		size_t & countOfData,            // 1. how many lines this block of data has
 		streampos & posBeforeNextBlock,  // 2. file ptr position right before next block of data
 		std::string dataType,            // 3. which type of data we're reading from the current data block
 		std::string prefix,              // 4. each line of the current data block starts with this prefix
@@ -56,37 +59,19 @@ private:
 										 //    the next data block which starts with symbols are
 										 //    stored in the skipUntilPrefix variable);
 
-	bool ReadInAndWriteVerticesData(ifstream & fin, ofstream & fout);
-	bool ReadInAndWriteTexturesData(ifstream & fin, ofstream & fout);
+	bool ReadInVerticesData(ifstream & fin);
+	bool ReadInTexturesData(ifstream & fin);
 	bool ReadInAndWriteNormalsData(ifstream & fin, ofstream & fout);
 	bool ReadInFacesData(ifstream & fin);
-	bool WriteIndicesIntoOutputFile(ofstream & fout);
+
+	// returns an index of the submesh with such material and group/object
+	UINT GetSubmeshIndex(const std::string & materialName, const std::string & groupName);
 
 	void PrintIOFilenames(const char* inputFilename, const char* outputFilename) const;
 
 
 
 private:
-	struct VERTEX3D
-	{
-		float x = 0.0f;
-		float y = 0.0f;
-		float z = 0.0f;
-	};
-
-	struct TEXTURE_COORDS
-	{
-		float tu = 0.0f;
-		float tv = 0.0f;
-	};
-
-	struct NORMAL
-	{
-		float nx = 0.0f;
-		float ny = 0.0f;
-		float nz = 0.0f;
-	};
-
 	char* inputLineBuffer_ = nullptr;                   // during execution of the getline() function we put here a one single text line
 
 	streampos posBeforeVerticesData_ = 0;
@@ -94,16 +79,22 @@ private:
 	streampos posBeforeNormalsData_ = 0;
 	streampos posBeforeFacesData_ = 0;
 
-	int verticesCount_ = 0;
-	int textureCoordsCount_ = 0;
-	int normalsCount_ = 0;
-	int facesCount_ = 0;
+	size_t verticesCount_ = 0;
+	size_t textureCoordsCount_ = 0;
+	size_t normalsCount_ = 0;
+	size_t facesCount_ = 0;
+
+	size_t linesCount_ = 0;                             // how many lines ReadCounts() has read so far
+	size_t lineOfNormalsData_ = 0;                      // the number of the line at posBeforeNormalsData_ (faces are read from it)
 
-	UINT* pVertexIndicesArray_ = nullptr;
-	UINT* pTextureIndicesArray_ = nullptr;
+	MeshData mesh_;                                     // here we put all the data which we read in from the input file
+	std::map<std::pair<std::string, std::string>, UINT> submeshesLookup_;  // (material, group) => index of submesh
+	std::string initialGroupName_{ "" };                // a name of the group/object which is declared before vertices data
 
 	
 	// constants
-	const int INPUT_LINE_SIZE_ = 80;              // how many symbols can read the getline() function as one sinle text line
+	const int INPUT_LINE_SIZE_ = 256;             // how many symbols can read the getline() function as one sinle text line
+	const char* DEFAULT_MATERIAL_NAME_ = "default";  // is used for faces which go before any "usemtl" line
+	const char* DEFAULT_GROUP_NAME_ = "default";     // is used for faces which go before any "o"/"g" line
 };
 
@@ -0,0 +1,802 @@
+#include "ModelConverterForPlyTypeClass.h"
+#include "MeshOptimizerClass.h"
+#include "ModelWriterClass.h"
+#include "BinaryDataHelpers.h"
+#include "Platform.h"
+#include "TraceRecorderClass.h"
+
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <cmath>
+#include <climits>
+
+
+// names of the vertex properties which we read in from the file
+static const char* const POS_X_NAMES[] = { "x" };
+static const char* const POS_Y_NAMES[] = { "y" };
+static const char* const POS_Z_NAMES[] = { "z" };
+static const char* const TEX_U_NAMES[] = { "u", "s", "texture_u", "texture_s" };
+static const char* const TEX_V_NAMES[] = { "v", "t", "texture_v", "texture_t" };
+static const char* const FACE_INDICES_NAMES[] = { "vertex_indices", "vertex_index" };
+
+#define NAMES_COUNT(names) (sizeof(names) / sizeof(names[0]))
+
+
+
+// ----------------------------------------------------------------------------------- //
+//
+//                          PUBLIC METHODS
+//
+// ----------------------------------------------------------------------------------- //
+
+// converts a model of the ".ply" type into the internal model format
+bool ModelConverterForPlyTypeClass::ConvertFromPly(const char* inputFilename, const char* outputFilename,
+	const ConversionOptions & options)
+{
+	TRACE_SCOPE("ConvertFromPly");
+	TRACE_ARG("file", inputFilename);
+
+	std::vector<char> & fileData = fileData_;    // the buffer keeps its memory between conversions
+	size_t headerSize = 0;
+
+	// read in the whole input file with a single read operation
+	{
+		TRACE_SCOPE("ReadWholeFile");
+
+		if (!Platform::ReadWholeFile(inputFilename, fileData))
+		{
+			std::string errorMsg{ "can't open input data file: " + std::string(inputFilename) };
+			Log::Error(LOG_MACRO, errorMsg.c_str());
+			return false;
+		}
+
+		TRACE_ARG("bytes", fileData.size());
+	}
+
+	// put a terminating null so the ascii data can be parsed with the strtod() function
+	fileData.push_back('\0');
+
+	const char* pData = fileData.data();
+	const char* pDataEnd = pData + fileData.size() - 1;
+
+	if (!ReadHeader(pData, pDataEnd, headerSize))
+	{
+		Log::Error(LOG_MACRO, "can't read the header of the .ply file");
+		return false;
+	}
+
+	// the counts of the header are checked before any buffer is allocated by them
+	if (!CheckElementsSize(pDataEnd - (pData + headerSize)))
+		return false;
+
+	mesh_.Clear();
+
+	const bool result = (format_ == PLY_FORMAT_ASCII) ?
+		ReadInAsciiData(pData + headerSize, pDataEnd) :
+		ReadInBinaryData(pData + headerSize, pDataEnd);
+
+	if (!result)
+	{
+		Log::Error(LOG_MACRO, "can't read in data of the .ply file");
+		return false;
+	}
+
+	Log::Debug(LOG_MACRO, "VERTICES COUNT: " + std::to_string(mesh_.vertices.size()));
+	Log::Debug(LOG_MACRO, "FACES COUNT:    " + std::to_string(mesh_.GetFacesCount()));
+
+	// PLY stores texture coords per vertex and has no materials
+	mesh_.SetTextureIndicesFromVertexIndices();
+	mesh_.SetSingleSubmesh();
+
+	// execute the common processing stages
+	if (!MeshOptimizerClass(options).Run(mesh_))
+	{
+		Log::Error(LOG_MACRO, "can't process the mesh data");
+		return false;
+	}
+
+	std::ofstream fout(outputFilename, std::ios::out);
+
+	if (fout.fail())
+	{
+		std::string errorMsg{ "can't open the output data file: " + std::string(outputFilename) };
+		Log::Error(LOG_MACRO, errorMsg.c_str());
+		return false;
+	}
+
+	if (!ModelWriterClass(options).WriteIntoOutputFile(mesh_, fout, outputFilename))
+	{
+		Log::Error(LOG_MACRO, "can't write data into the output file");
+		return false;
+	}
+
+	return true;
+}
+
+
+
+// ----------------------------------------------------------------------------------- //
+//
+//                          PRIVATE METHODS / HELPERS
+//
+// ----------------------------------------------------------------------------------- //
+
+// read in the ascii header of the file: the format and declarations of elements/properties;
+// output: the size of the header in bytes (the data goes right after it)
+bool ModelConverterForPlyTypeClass::ReadHeader(const char* pData, const char* pDataEnd, size_t & headerSize)
+{
+	const char* pLine = pData;
+	bool isFirstLine = true;
+	bool hasFormat = false;
+
+	elements_.clear();
+
+	while (pLine < pDataEnd)
+	{
+		const char* pLineEnd = static_cast<const char*>(memchr(pLine, '\n', pDataEnd - pLine));
+
+		if (pLineEnd == nullptr)
+		{
+			Log::Error(LOG_MACRO, "there is no \"end_header\" line in the file");
+			return false;
+		}
+
+		std::string line(pLine, pLineEnd);
+		std::stringstream ss(line);
+		std::string keyword;
+
+		pLine = pLineEnd + 1;
+		ss >> keyword;
+
+		if (isFirstLine)
+		{
+			if (keyword != "ply")
+			{
+				Log::Error(LOG_MACRO, "it isn't a .ply file");
+				return false;
+			}
+			isFirstLine = false;
+		}
+		else if (keyword == "format")
+		{
+			std::string formatName;
+			ss >> formatName;
+
+			if (formatName == "ascii")
+				format_ = PLY_FORMAT_ASCII;
+			else if (formatName == "binary_little_endian")
+				format_ = PLY_FORMAT_BINARY_LITTLE_ENDIAN;
+			else if (formatName == "binary_big_endian")
+				format_ = PLY_FORMAT_BINARY_BIG_ENDIAN;
+			else
+			{
+				Log::Error(LOG_MACRO, ("unknown format of the .ply file: " + formatName).c_str());
+				return false;
+			}
+			hasFormat = true;
+		}
+		else if (keyword == "element")
+		{
+			PLY_ELEMENT element;
+			ss >> element.name >> element.count;
+			elements_.push_back(element);
+		}
+		else if (keyword == "property")
+		{
+			if (elements_.empty())
+			{
+				Log::Error(LOG_MACRO, "a property is declared before any element");
+				return false;
+			}
+
+			PLY_PROPERTY property;
+			std::string typeName;
+			ss >> typeName;
+
+			if (typeName == "list")
+			{
+				std::string countTypeName;
+				ss >> countTypeName >> typeName;
+
+				property.isList = true;
+				property.listCountType = GetTypeByName(countTypeName);
+				elements_.back().hasLists = true;
+			}
+
+			property.type = GetTypeByName(typeName);
+			ss >> property.name;
+
+			if ((property.type == PLY_TYPE_INVALID) || (property.isList && (property.listCountType == PLY_TYPE_INVALID)))
+			{
+				Log::Error(LOG_MACRO, ("unknown type of the property: " + property.name).c_str());
+				return false;
+			}
+
+			elements_.back().properties.push_back(property);
+		}
+		else if (keyword == "end_header")
+		{
+			headerSize = pLine - pData;
+			break;
+		}
+		// skip "comment", "obj_info" and empty lines
+	}
+
+	if (!hasFormat || (headerSize == 0))
+	{
+		Log::Error(LOG_MACRO, "the header of the .ply file is broken");
+		return false;
+	}
+
+	// compute offsets of properties inside of the binary elements which have a fixed size
+	for (PLY_ELEMENT & element : elements_)
+	{
+		if (element.hasLists)
+			continue;
+
+		element.stride = 0;
+
+		for (PLY_PROPERTY & property : element.properties)
+		{
+			property.offset = element.stride;
+			element.stride += GetTypeSize(property.type);
+		}
+	}
+
+	swapBytes_ = (format_ == PLY_FORMAT_BINARY_BIG_ENDIAN) == IsLittleEndianHost();
+
+	return true;
+}
+
+
+ModelConverterForPlyTypeClass::PLY_TYPE ModelConverterForPlyTypeClass::GetTypeByName(const std::string & typeName)
+{
+	if ((typeName == "char") || (typeName == "int8"))     return PLY_TYPE_INT8;
+	if ((typeName == "uchar") || (typeName == "uint8"))   return PLY_TYPE_UINT8;
+	if ((typeName == "short") || (typeName == "int16"))   return PLY_TYPE_INT16;
+	if ((typeName == "ushort") || (typeName == "uint16")) return PLY_TYPE_UINT16;
+	if ((typeName == "int") || (typeName == "int32"))     return PLY_TYPE_INT32;
+	if ((typeName == "uint") || (typeName == "uint32"))   return PLY_TYPE_UINT32;
+	if ((typeName == "float") || (typeName == "float32")) return PLY_TYPE_FLOAT32;
+	if ((typeName == "double") || (typeName == "float64")) return PLY_TYPE_FLOAT64;
+
+	return PLY_TYPE_INVALID;
+}
+
+
+size_t ModelConverterForPlyTypeClass::GetTypeSize(const PLY_TYPE type)
+{
+	switch (type)
+	{
+		case PLY_TYPE_INT8:
+		case PLY_TYPE_UINT8:   return 1;
+		case PLY_TYPE_INT16:
+		case PLY_TYPE_UINT16:  return 2;
+		case PLY_TYPE_INT32:
+		case PLY_TYPE_UINT32:
+		case PLY_TYPE_FLOAT32: return 4;
+		case PLY_TYPE_FLOAT64: return 8;
+		default:               return 0;
+	}
+}
+
+
+// returns an index of the element's property which has one of the input names (or -1 if there is no such property)
+int ModelConverterForPlyTypeClass::FindProperty(const PLY_ELEMENT & element, const char* const names[], const size_t namesCount) const
+{
+	for (size_t idx = 0; idx < element.properties.size(); idx++)
+	{
+		for (size_t nameIdx = 0; nameIdx < namesCount; nameIdx++)
+		{
+			if (element.properties[idx].name == names[nameIdx])
+				return (int)idx;
+		}
+	}
+
+	return -1;
+}
+
+
+// check that the data after the header can hold the declared counts of elements (each element
+// has at least the size of its scalar properties and list counts; an ascii value takes at least
+// 2 chars with the separator); it rejects files with a broken or a malicious header
+bool ModelConverterForPlyTypeClass::CheckElementsSize(const size_t dataSize) const
+{
+	const bool isAscii = (format_ == PLY_FORMAT_ASCII);
+	size_t remainingSize = isAscii ? dataSize + 1 : dataSize;     // the last ascii value may have no separator
+
+	for (const PLY_ELEMENT & element : elements_)
+	{
+		size_t minElementSize = 0;
+
+		for (const PLY_PROPERTY & property : element.properties)
+		{
+			if (isAscii)
+				minElementSize += 2;
+			else
+				minElementSize += GetTypeSize(property.isList ? property.listCountType : property.type);
+		}
+
+		if ((minElementSize > 0) && (element.count > remainingSize / minElementSize))
+		{
+			Log::Error(LOG_MACRO, ("the file is too small for the declared count of the element: " + element.name +
+				" (" + std::to_string(element.count) + ")").c_str());
+			return false;
+		}
+
+		remainingSize -= element.count * minElementSize;
+	}
+
+	return true;
+}
+
+
+// check the count of list items which is read in from the file: it must be a non-negative
+// integer and the rest of the data must be able to hold so many items (maxCount)
+bool ModelConverterForPlyTypeClass::GetListItemsCount(const double value, const size_t maxCount, size_t & itemsCount)
+{
+	if (!(value >= 0.0) || (value != std::floor(value)) || (value > (double)maxCount))
+	{
+		Log::Error(LOG_MACRO, ("invalid count of the list items: " + std::to_string(value)).c_str());
+		return false;
+	}
+
+	itemsCount = (size_t)value;
+	return true;
+}
+
+
+// convert an index which is read in from the file; the values which don't fit into UINT
+// become an invalid index (so the validation stage reports them)
+UINT ModelConverterForPlyTypeClass::ToIndex(const double value)
+{
+	return ((value >= 0.0) && (value <= (double)UINT_MAX)) ? (UINT)value : UINT_MAX;
+}
+
+
+///////////////////////////////////////////////////////////
+
+bool ModelConverterForPlyTypeClass::ReadInBinaryData(const char* pData, const char* pDataEnd)
+{
+	// elements go one after another in the order of their declaration in the header
+	for (const PLY_ELEMENT & element : elements_)
+	{
+		bool result = false;
+
+		if (element.name == "vertex")
+			result = ReadInBinaryVerticesData(element, pData, pDataEnd);
+		else if (element.name == "face")
+			result = ReadInBinaryFacesData(element, pData, pDataEnd);
+		else
+			result = SkipBinaryElement(element, pData, pDataEnd);
+
+		if (!result)
+		{
+			Log::Error(LOG_MACRO, ("can't read in data of the element: " + element.name).c_str());
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+bool ModelConverterForPlyTypeClass::ReadInBinaryVerticesData(const PLY_ELEMENT & element, const char* & pData, const char* pDataEnd)
+{
+	const int xIdx = FindProperty(element, POS_X_NAMES, NAMES_COUNT(POS_X_NAMES));
+	const int yIdx = FindProperty(element, POS_Y_NAMES, NAMES_COUNT(POS_Y_NAMES));
+	const int zIdx = FindProperty(element, POS_Z_NAMES, NAMES_COUNT(POS_Z_NAMES));
+	const int uIdx = FindProperty(element, TEX_U_NAMES, NAMES_COUNT(TEX_U_NAMES));
+	const int vIdx = FindProperty(element, TEX_V_NAMES, NAMES_COUNT(TEX_V_NAMES));
+	const bool hasTexCoords = (uIdx != -1) && (vIdx != -1);
+
+	if ((xIdx == -1) || (yIdx == -1) || (zIdx == -1))
+	{
+		Log::Error(LOG_MACRO, "vertices have no positions");
+		return false;
+	}
+
+	mesh_.vertices.resize(element.count);
+	mesh_.texCoords.resize(hasTexCoords ? element.count : 0);
+
+	// vertices with lists have different sizes so we read them one by one
+	if (element.hasLists)
+	{
+		for (size_t i = 0; i < element.count; i++)
+		{
+			for (size_t propIdx = 0; propIdx < element.properties.size(); propIdx++)
+			{
+				const PLY_PROPERTY & property = element.properties[propIdx];
+
+				if (property.isList)
+				{
+					const size_t countSize = GetTypeSize(property.listCountType);
+					const size_t itemSize = GetTypeSize(property.type);
+					size_t itemsCount = 0;
+
+					if (pData + countSize > pDataEnd)
+						return false;
+
+					if (!GetListItemsCount(ReadBinaryValue(pData, property.listCountType), (pDataEnd - pData - countSize) / itemSize, itemsCount))
+						return false;
+
+					pData += countSize + itemsCount * itemSize;
+					continue;
+				}
+
+				if (pData + GetTypeSize(property.type) > pDataEnd)
+					return false;
+
+				const float value = (float)ReadBinaryValue(pData, property.type);
+
+				if ((int)propIdx == xIdx) mesh_.vertices[i].x = value;
+				else if ((int)propIdx == yIdx) mesh_.vertices[i].y = value;
+				else if ((int)propIdx == zIdx) mesh_.vertices[i].z = value;
+				else if (hasTexCoords && ((int)propIdx == uIdx)) mesh_.texCoords[i].tu = value;
+				else if (hasTexCoords && ((int)propIdx == vIdx)) mesh_.texCoords[i].tv = value;
+
+				pData += GetTypeSize(property.type);
+			}
+		}
+	}
+
+	// vertices have a fixed size so we copy the attributes in bulk
+	else
+	{
+		const size_t dataSize = element.stride * element.count;
+
+		if (pData + dataSize > pDataEnd)
+		{
+			Log::Error(LOG_MACRO, "unexpected end of the vertices data");
+			return false;
+		}
+
+		const PLY_PROPERTY & propX = element.properties[xIdx];
+		const PLY_PROPERTY & propY = element.properties[yIdx];
+		const PLY_PROPERTY & propZ = element.properties[zIdx];
+
+		const bool isPackedFloatPosition =
+			(propX.type == PLY_TYPE_FLOAT32) && (propY.type == PLY_TYPE_FLOAT32) && (propZ.type == PLY_TYPE_FLOAT32) &&
+			(propY.offset == propX.offset + 4) && (propZ.offset == propX.offset + 8);
+
+		if (isPackedFloatPosition && (element.stride == sizeof(VERTEX3D)))
+		{
+			// the whole block of data is an array of positions
+			memcpy(mesh_.vertices.data(), pData, dataSize);
+		}
+		else if (isPackedFloatPosition)
+		{
+			for (size_t i = 0; i < element.count; i++)
+				memcpy(&mesh_.vertices[i], pData + i * element.stride + propX.offset, sizeof(VERTEX3D));
+		}
+
+		if (isPackedFloatPosition && swapBytes_)
+			ByteSwapArray(mesh_.vertices.data(), sizeof(float), element.count * 3);
+
+		// positions are stored in some other types so convert them one by one
+		if (!isPackedFloatPosition)
+		{
+			for (size_t i = 0; i < element.count; i++)
+			{
+				const char* pVertex = pData + i * element.stride;
+
+				mesh_.vertices[i].x = (float)ReadBinaryValue(pVertex + propX.offset, propX.type);
+				mesh_.vertices[i].y = (float)ReadBinaryValue(pVertex + propY.offset, propY.type);
+				mesh_.vertices[i].z = (float)ReadBinaryValue(pVertex + propZ.offset, propZ.type);
+			}
+		}
+
+		if (hasTexCoords)
+		{
+			const PLY_PROPERTY & propU = element.properties[uIdx];
+			const PLY_PROPERTY & propV = element.properties[vIdx];
+
+			const bool isPackedFloatTexCoords =
+				(propU.type == PLY_TYPE_FLOAT32) && (propV.type == PLY_TYPE_FLOAT32) && (propV.offset == propU.offset + 4);
+
+			if (isPackedFloatTexCoords)
+			{
+				for (size_t i = 0; i < element.count; i++)
+					memcpy(&mesh_.texCoords[i], pData + i * element.stride + propU.offset, sizeof(TEXTURE_COORDS));
+
+				if (swapBytes_)
+					ByteSwapArray(mesh_.texCoords.data(), sizeof(float), element.count * 2);
+			}
+			else
+			{
+				for (size_t i = 0; i < element.count; i++)
+				{
+					const char* pVertex = pData + i * element.stride;
+
+					mesh_.texCoords[i].tu = (float)ReadBinaryValue(pVertex + propU.offset, propU.type);
+					mesh_.texCoords[i].tv = (float)ReadBinaryValue(pVertex + propV.offset, propV.type);
+				}
+			}
+		}
+
+		pData += dataSize;
+	}
+
+	// invert the values to use them in the left handed coordinate system
+	for (VERTEX3D & vertex : mesh_.vertices)
+		vertex.z *= -1.0f;
+
+	for (TEXTURE_COORDS & texCoords : mesh_.texCoords)
+		texCoords.tv = 1.0f - texCoords.tv;
+
+	return true;
+}
+
+
+bool ModelConverterForPlyTypeClass::ReadInBinaryFacesData(const PLY_ELEMENT & element, const char* & pData, const char* pDataEnd)
+{
+	const int indicesIdx = FindProperty(element, FACE_INDICES_NAMES, NAMES_COUNT(FACE_INDICES_NAMES));
+
+	if ((indicesIdx == -1) || !element.properties[indicesIdx].isList)
+	{
+		Log::Error(LOG_MACRO, "faces have no vertices indices");
+		return false;
+	}
+
+	const PLY_PROPERTY & indicesProp = element.properties[indicesIdx];
+	const size_t indexSize = GetTypeSize(indicesProp.type);
+	std::vector<UINT> polygon;
+
+	mesh_.vertexIndices.reserve(element.count * 3);    // usually each face is a triangle
+
+	// the most common case: each face has only a list of 32-bit indices with an 8-bit count
+	const bool isPlainIndicesList =
+		(element.properties.size() == 1) &&
+		(indicesProp.listCountType == PLY_TYPE_UINT8) &&
+		((indicesProp.type == PLY_TYPE_INT32) || (indicesProp.type == PLY_TYPE_UINT32));
+
+	for (size_t i = 0; i < element.count; i++)
+	{
+		if (isPlainIndicesList)
+		{
+			if (pData + 1 > pDataEnd)
+				return false;
+
+			const size_t polygonVerticesCount = (uint8_t)pData[0];
+			const size_t polygonDataSize = polygonVerticesCount * sizeof(UINT);
+
+			if (pData + 1 + polygonDataSize > pDataEnd)
+				return false;
+
+			polygon.resize(polygonVerticesCount);
+			memcpy(polygon.data(), pData + 1, polygonDataSize);
+
+			if (swapBytes_)
+				ByteSwapArray(polygon.data(), sizeof(UINT), polygonVerticesCount);
+
+			AddPolygon(polygon.data(), polygonVerticesCount);
+			pData += 1 + polygonDataSize;
+			continue;
+		}
+
+		// generic case: go through each property of the face
+		for (size_t propIdx = 0; propIdx < element.properties.size(); propIdx++)
+		{
+			const PLY_PROPERTY & property = element.properties[propIdx];
+
+			if (!property.isList)
+			{
+				if (pData + GetTypeSize(property.type) > pDataEnd)
+					return false;
+
+				pData += GetTypeSize(property.type);
+				continue;
+			}
+
+			const size_t countSize = GetTypeSize(property.listCountType);
+			size_t itemsCount = 0;
+
+			if (pData + countSize > pDataEnd)
+				return false;
+
+			if (!GetListItemsCount(ReadBinaryValue(pData, property.listCountType), (pDataEnd - pData - countSize) / GetTypeSize(property.type), itemsCount))
+				return false;
+
+			pData += countSize;
+
+			if ((int)propIdx == indicesIdx)
+			{
+				polygon.resize(itemsCount);
+
+				for (size_t item = 0; item < itemsCount; item++)
+					polygon[item] = ToIndex(ReadBinaryValue(pData + item * indexSize, property.type));
+
+				AddPolygon(polygon.data(), itemsCount);
+			}
+
+			pData += itemsCount * GetTypeSize(property.type);
+		}
+
+		if (pData > pDataEnd)
+			return false;
+	}
+
+	return true;
+}
+
+
+// skip data of the element which we don't use (edges, materials, etc.)
+bool ModelConverterForPlyTypeClass::SkipBinaryElement(const PLY_ELEMENT & element, const char* & pData, const char* pDataEnd)
+{
+	if (!element.hasLists)
+	{
+		pData += element.stride * element.count;
+		return pData <= pDataEnd;
+	}
+
+	for (size_t i = 0; i < element.count; i++)
+	{
+		for (const PLY_PROPERTY & property : element.properties)
+		{
+			if (property.isList)
+			{
+				const size_t countSize = GetTypeSize(property.listCountType);
+				size_t itemsCount = 0;
+
+				if (pData + countSize > pDataEnd)
+					return false;
+
+				if (!GetListItemsCount(ReadBinaryValue(pData, property.listCountType), (pDataEnd - pData - countSize) / GetTypeSize(property.type), itemsCount))
+					return false;
+
+				pData += countSize + itemsCount * GetTypeSize(property.type);
+			}
+			else
+			{
+				if (pData + GetTypeSize(property.type) > pDataEnd)
+					return false;
+
+				pData += GetTypeSize(property.type);
+			}
+		}
+	}
+
+	return pData <= pDataEnd;
+}
+
+
+// read in a single binary value of the input type (with conversion of the byte order if necessary)
+double ModelConverterForPlyTypeClass::ReadBinaryValue(const char* pData, const PLY_TYPE type) const
+{
+	uint8_t bytes[8] = { 0 };
+	const size_t size = GetTypeSize(type);
+
+	memcpy(bytes, pData, size);
+
+	if (swapBytes_)
+		ByteSwapArray(bytes, size, 1);
+
+	switch (type)
+	{
+		case PLY_TYPE_INT8:    { int8_t v;   memcpy(&v, bytes, 1); return v; }
+		case PLY_TYPE_UINT8:   { uint8_t v;  memcpy(&v, bytes, 1); return v; }
+		case PLY_TYPE_INT16:   { int16_t v;  memcpy(&v, bytes, 2); return v; }
+		case PLY_TYPE_UINT16:  { uint16_t v; memcpy(&v, bytes, 2); return v; }
+		case PLY_TYPE_INT32:   { int32_t v;  memcpy(&v, bytes, 4); return v; }
+		case PLY_TYPE_UINT32:  { uint32_t v; memcpy(&v, bytes, 4); return v; }
+		case PLY_TYPE_FLOAT32: { float v;    memcpy(&v, bytes, 4); return v; }
+		case PLY_TYPE_FLOAT64: { double v;   memcpy(&v, bytes, 8); return v; }
+		default:               return 0.0;
+	}
+}
+
+
+///////////////////////////////////////////////////////////
+
+bool ModelConverterForPlyTypeClass::ReadInAsciiData(const char* pData, const char* pDataEnd)
+{
+	char* pNext = nullptr;
+
+	// read in the next number from the data (returns false if there is no more numbers)
+	auto ReadNumber = [&pData, &pNext, pDataEnd](double & value) -> bool
+	{
+		value = strtod(pData, &pNext);
+
+		if ((pNext == pData) || (pNext > pDataEnd))
+			return false;
+
+		pData = pNext;
+		return true;
+	};
+
+	double value = 0.0;
+	std::vector<UINT> polygon;
+
+	for (const PLY_ELEMENT & element : elements_)
+	{
+		const bool isVertex = (element.name == "vertex");
+		const bool isFace = (element.name == "face");
+
+		const int xIdx = FindProperty(element, POS_X_NAMES, NAMES_COUNT(POS_X_NAMES));
+		const int yIdx = FindProperty(element, POS_Y_NAMES, NAMES_COUNT(POS_Y_NAMES));
+		const int zIdx = FindProperty(element, POS_Z_NAMES, NAMES_COUNT(POS_Z_NAMES));
+		const int uIdx = FindProperty(element, TEX_U_NAMES, NAMES_COUNT(TEX_U_NAMES));
+		const int vIdx = FindProperty(element, TEX_V_NAMES, NAMES_COUNT(TEX_V_NAMES));
+		const int indicesIdx = FindProperty(element, FACE_INDICES_NAMES, NAMES_COUNT(FACE_INDICES_NAMES));
+		const bool hasTexCoords = isVertex && (uIdx != -1) && (vIdx != -1);
+
+		if (isVertex && ((xIdx == -1) || (yIdx == -1) || (zIdx == -1)))
+		{
+			Log::Error(LOG_MACRO, "vertices have no positions");
+			return false;
+		}
+
+		if (isFace && (indicesIdx == -1))
+		{
+			Log::Error(LOG_MACRO, "faces have no vertices indices");
+			return false;
+		}
+
+		if (isVertex)
+		{
+			mesh_.vertices.resize(element.count);
+			mesh_.texCoords.resize(hasTexCoords ? element.count : 0);
+		}
+
+		for (size_t i = 0; i < element.count; i++)
+		{
+			for (size_t propIdx = 0; propIdx < element.properties.size(); propIdx++)
+			{
+				if (!ReadNumber(value))
+				{
+					Log::Error(LOG_MACRO, ("unexpected end of data of the element: " + element.name).c_str());
+					return false;
+				}
+
+				// read in (or skip) the list's items
+				if (element.properties[propIdx].isList)
+				{
+					// each of the items takes at least 2 chars (a digit and a separator)
+					size_t itemsCount = 0;
+
+					if (!GetListItemsCount(value, (size_t)(pDataEnd - pData + 1) / 2, itemsCount))
+						return false;
+
+					polygon.resize(itemsCount);
+
+					for (size_t item = 0; item < itemsCount; item++)
+					{
+						if (!ReadNumber(value))
+							return false;
+
+						polygon[item] = ToIndex(value);
+					}
+
+					if (isFace && ((int)propIdx == indicesIdx))
+						AddPolygon(polygon.data(), itemsCount);
+
+					continue;
+				}
+
+				if (!isVertex)
+					continue;
+
+				if ((int)propIdx == xIdx) mesh_.vertices[i].x = (float)value;
+				else if ((int)propIdx == yIdx) mesh_.vertices[i].y = (float)value;
+				else if ((int)propIdx == zIdx) mesh_.vertices[i].z = -(float)value;                 // invert the value to use it in the left handed coordinate system
+				else if (hasTexCoords && ((int)propIdx == uIdx)) mesh_.texCoords[i].tu = (float)value;
+				else if (hasTexCoords && ((int)propIdx == vIdx)) mesh_.texCoords[i].tv = 1.0f - (float)value;  // invert the value to use it in the left handed coordinate system
+			}
+		}
+	}
+
+	return true;
+}
+
+
+// split a polygon into triangles (as a fan around its first vertex)
+void ModelConverterForPlyTypeClass::AddPolygon(const UINT* pPolygonIndices, const size_t polygonVerticesCount)
+{
+	for (size_t i = 2; i < polygonVerticesCount; i++)
+	{
+		mesh_.vertexIndices.push_back(pPolygonIndices[0]);
+		mesh_.vertexIndices.push_back(pPolygonIndices[i - 1]);
+		mesh_.vertexIndices.push_back(pPolygonIndices[i]);
+	}
+}
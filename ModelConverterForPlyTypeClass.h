@@ -0,0 +1,99 @@
+/////////////////////////////////////////////////////////////////////
+// Filename:     ModelConverterForPlyTypeClass.h
+// Description:  this class is used to convert models data from the
+//               PLY format (binary little/big endian and ascii)
+//               into the internal model data format
+//
+// Created:      19.10.26
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////////////////////////
+// INCLUDES
+//////////////////////////////////
+#include "Log.h"       // for using the log system
+#include "MeshData.h"
+#include "ConversionOptions.h"
+
+#include <vector>
+#include <string>
+
+
+//////////////////////////////////
+// Class name: ModelConverterForPlyTypeClass
+//////////////////////////////////
+class ModelConverterForPlyTypeClass
+{
+public:
+	// converts .ply file model data into the internal model format
+	bool ConvertFromPly(const char* inputFilename, const char* outputFilename,
+		const ConversionOptions & options = ConversionOptions());
+
+private:
+	enum PLY_FORMAT
+	{
+		PLY_FORMAT_ASCII,
+		PLY_FORMAT_BINARY_LITTLE_ENDIAN,
+		PLY_FORMAT_BINARY_BIG_ENDIAN,
+	};
+
+	enum PLY_TYPE
+	{
+		PLY_TYPE_INVALID,
+		PLY_TYPE_INT8,
+		PLY_TYPE_UINT8,
+		PLY_TYPE_INT16,
+		PLY_TYPE_UINT16,
+		PLY_TYPE_INT32,
+		PLY_TYPE_UINT32,
+		PLY_TYPE_FLOAT32,
+		PLY_TYPE_FLOAT64,
+	};
+
+	struct PLY_PROPERTY
+	{
+		std::string name{ "" };
+		PLY_TYPE type = PLY_TYPE_INVALID;             // a type of the value (or a type of list items)
+		PLY_TYPE listCountType = PLY_TYPE_INVALID;    // a type of the list's count (if the property is a list)
+		bool isList = false;
+		size_t offset = 0;                            // an offset (in bytes) inside of the binary element (if the element has no lists)
+	};
+
+	struct PLY_ELEMENT
+	{
+		std::string name{ "" };
+		size_t count = 0;
+		std::vector<PLY_PROPERTY> properties;
+		bool hasLists = false;
+		size_t stride = 0;                            // a size (in bytes) of the binary element (if the element has no lists)
+	};
+
+	// header handlers
+	bool ReadHeader(const char* pData, const char* pDataEnd, size_t & headerSize);
+	static PLY_TYPE GetTypeByName(const std::string & typeName);
+	static size_t GetTypeSize(const PLY_TYPE type);
+	int FindProperty(const PLY_ELEMENT & element, const char* const names[], const size_t namesCount) const;
+	bool CheckElementsSize(const size_t dataSize) const;
+	static bool GetListItemsCount(const double value, const size_t maxCount, size_t & itemsCount);
+	static UINT ToIndex(const double value);
+
+	// binary data handlers
+	bool ReadInBinaryData(const char* pData, const char* pDataEnd);
+	bool ReadInBinaryVerticesData(const PLY_ELEMENT & element, const char* & pData, const char* pDataEnd);
+	bool ReadInBinaryFacesData(const PLY_ELEMENT & element, const char* & pData, const char* pDataEnd);
+	bool SkipBinaryElement(const PLY_ELEMENT & element, const char* & pData, const char* pDataEnd);
+	double ReadBinaryValue(const char* pData, const PLY_TYPE type) const;
+
+	// ascii data handlers
+	bool ReadInAsciiData(const char* pData, const char* pDataEnd);
+
+	// fan triangulation of a polygon
+	void AddPolygon(const UINT* pPolygonIndices, const size_t polygonVerticesCount);
+
+private:
+	MeshData mesh_;                                 // here we put all the data which we read in from the input file
+	std::vector<char> fileData_;                    // the whole input file
+	std::vector<PLY_ELEMENT> elements_;             // elements in the order they are declared in the header
+	PLY_FORMAT format_ = PLY_FORMAT_ASCII;
+	bool swapBytes_ = false;                        // true if the byte order of the file differs from the byte order of this machine
+};
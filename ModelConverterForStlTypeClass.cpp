@@ -0,0 +1,136 @@
+#include "ModelConverterForStlTypeClass.h"
+#include "MeshOptimizerClass.h"
+#include "ModelWriterClass.h"
+#include "BinaryDataHelpers.h"
+#include "Platform.h"
+#include "TraceRecorderClass.h"
+
+#include <fstream>
+#include <numeric>
+
+
+
+// ----------------------------------------------------------------------------------- //
+//
+//                          PUBLIC METHODS
+//
+// ----------------------------------------------------------------------------------- //
+
+// converts a model of the binary ".stl" type into the internal model format
+bool ModelConverterForStlTypeClass::ConvertFromStl(const char* inputFilename, const char* outputFilename,
+	const ConversionOptions & options)
+{
+	TRACE_SCOPE("ConvertFromStl");
+	TRACE_ARG("file", inputFilename);
+
+	std::vector<char> & fileData = fileData_;    // the buffer keeps its memory between conversions
+
+	// read in the whole input file with a single read operation
+	{
+		TRACE_SCOPE("ReadWholeFile");
+
+		if (!Platform::ReadWholeFile(inputFilename, fileData))
+		{
+			std::string errorMsg{ "can't open input data file: " + std::string(inputFilename) };
+			Log::Error(LOG_MACRO, errorMsg.c_str());
+			return false;
+		}
+
+		TRACE_ARG("bytes", fileData.size());
+	}
+
+	if (!IsBinaryStl(fileData.data(), fileData.size()))
+	{
+		Log::Error(LOG_MACRO, "it isn't a binary .stl file (ascii .stl files aren't supported)");
+		return false;
+	}
+
+	mesh_.Clear();
+
+	if (!ReadInTrianglesData(fileData.data(), fileData.size()))
+	{
+		Log::Error(LOG_MACRO, "can't read in data of the .stl file");
+		return false;
+	}
+
+	Log::Debug(LOG_MACRO, "FACES COUNT: " + std::to_string(mesh_.GetFacesCount()));
+
+	// STL has no texture coords and no materials
+	mesh_.SetTextureIndicesFromVertexIndices();
+	mesh_.SetSingleSubmesh();
+
+	// execute the common processing stages
+	if (!MeshOptimizerClass(options).Run(mesh_))
+	{
+		Log::Error(LOG_MACRO, "can't process the mesh data");
+		return false;
+	}
+
+	std::ofstream fout(outputFilename, std::ios::out);
+
+	if (fout.fail())
+	{
+		std::string errorMsg{ "can't open the output data file: " + std::string(outputFilename) };
+		Log::Error(LOG_MACRO, errorMsg.c_str());
+		return false;
+	}
+
+	if (!ModelWriterClass(options).WriteIntoOutputFile(mesh_, fout, outputFilename))
+	{
+		Log::Error(LOG_MACRO, "can't write data into the output file");
+		return false;
+	}
+
+	return true;
+}
+
+
+// returns true if the data has a size which is expected for the binary STL with such number of triangles
+// (we can't check the "solid" word at the beginning because a lot of exporters put it into the binary header as well)
+bool ModelConverterForStlTypeClass::IsBinaryStl(const char* pData, const size_t dataSize)
+{
+	if (dataSize < TRIANGLES_DATA_OFFSET_)
+		return false;
+
+	uint32_t trianglesCount = 0;
+	memcpy(&trianglesCount, pData + HEADER_SIZE_, sizeof(uint32_t));
+
+	if (!IsLittleEndianHost())
+		ByteSwapArray(&trianglesCount, sizeof(uint32_t), 1);
+
+	return dataSize == TRIANGLES_DATA_OFFSET_ + (size_t)trianglesCount * TRIANGLE_SIZE_;
+}
+
+
+
+// ----------------------------------------------------------------------------------- //
+//
+//                          PRIVATE METHODS / HELPERS
+//
+// ----------------------------------------------------------------------------------- //
+
+bool ModelConverterForStlTypeClass::ReadInTrianglesData(const char* pData, const size_t dataSize)
+{
+	const size_t trianglesCount = (dataSize - TRIANGLES_DATA_OFFSET_) / TRIANGLE_SIZE_;
+	const char* pTriangle = pData + TRIANGLES_DATA_OFFSET_;
+
+	// STL doesn't share vertices between triangles so each triangle has its own 3 vertices
+	mesh_.vertices.resize(trianglesCount * 3);
+	mesh_.vertexIndices.resize(trianglesCount * 3);
+
+	// copy positions of 3 vertices of each triangle at once
+	for (size_t i = 0; i < trianglesCount; i++, pTriangle += TRIANGLE_SIZE_)
+		memcpy(&mesh_.vertices[i * 3], pTriangle + TRIANGLE_VERTICES_OFFSET_, 3 * sizeof(VERTEX3D));
+
+	// STL is always little endian
+	if (!IsLittleEndianHost())
+		ByteSwapArray(mesh_.vertices.data(), sizeof(float), mesh_.vertices.size() * 3);
+
+	// invert the values to use them in the left handed coordinate system
+	for (VERTEX3D & vertex : mesh_.vertices)
+		vertex.z *= -1.0f;
+
+	std::iota(mesh_.vertexIndices.begin(), mesh_.vertexIndices.end(), 0);
+
+	return true;
+}
@@ -0,0 +1,47 @@
+/////////////////////////////////////////////////////////////////////
+// Filename:     ModelConverterForStlTypeClass.h
+// Description:  this class is used to convert models data from the
+//               binary STL format into the internal model data format
+//
+// Created:      19.10.26
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////////////////////////
+// INCLUDES
+//////////////////////////////////
+#include "Log.h"       // for using the log system
+#include "MeshData.h"
+#include "ConversionOptions.h"
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+
+//////////////////////////////////
+// Class name: ModelConverterForStlTypeClass
+//////////////////////////////////
+class ModelConverterForStlTypeClass
+{
+public:
+	// converts binary .stl file model data into the internal model format
+	bool ConvertFromStl(const char* inputFilename, const char* outputFilename,
+		const ConversionOptions & options = ConversionOptions());
+
+	// returns true if the data has a size which is expected for the binary STL with such number of triangles
+	static bool IsBinaryStl(const char* pData, const size_t dataSize);
+
+private:
+	bool ReadInTrianglesData(const char* pData, const size_t dataSize);
+
+private:
+	MeshData mesh_;                                 // here we put all the data which we read in from the input file
+	std::vector<char> fileData_;                    // the whole input file
+
+	// constants
+	static const size_t HEADER_SIZE_ = 80;          // the binary STL starts with 80 bytes of a header ...
+	static const size_t TRIANGLES_DATA_OFFSET_ = HEADER_SIZE_ + sizeof(uint32_t);  // ... and the number of triangles
+	static const size_t TRIANGLE_SIZE_ = 50;        // normal (12 bytes) + 3 vertices (36 bytes) + attributes (2 bytes)
+	static const size_t TRIANGLE_VERTICES_OFFSET_ = 12;
+};
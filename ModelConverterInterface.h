@@ -1,25 +1,122 @@
 #pragma once
 
 #include "ModelConverterForObjTypeClass.h"
+#include "ModelConverterForPlyTypeClass.h"
+#include "ModelConverterForStlTypeClass.h"
+#include "TraceRecorderClass.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
 
 class ModelConverterInterface
 {
 public:
-	bool Convert(const char* inputFilename, const char* outputFilename)
+	enum INPUT_FILE_TYPE
 	{
+		INPUT_FILE_TYPE_UNKNOWN,
+		INPUT_FILE_TYPE_OBJ,
+		INPUT_FILE_TYPE_PLY,
+		INPUT_FILE_TYPE_STL,
+	};
 
+public:
+	bool Convert(const char* inputFilename, const char* outputFilename,
+		const ConversionOptions & options = ConversionOptions())
+	{
+		TRACE_SCOPE("Convert");
+		TRACE_ARG("input", inputFilename);
+		TRACE_ARG("output", outputFilename);
 
-		std::unique_ptr<ModelConverterForObjTypeClass> pModelConverter = std::make_unique<ModelConverterForObjTypeClass>();
+		bool result = false;
 
-		bool result = pModelConverter->ConvertFromObj(inputFilename, outputFilename);
-		if (!result)
+		switch (DetectInputFileType(inputFilename))
 		{
-			std::cout << "can't convert .obj into the internal model format" << std::endl;
-			return false;
+			case INPUT_FILE_TYPE_PLY:
+			{
+				if (!pPlyConverter_)
+					pPlyConverter_ = std::make_unique<ModelConverterForPlyTypeClass>();
+
+				result = pPlyConverter_->ConvertFromPly(inputFilename, outputFilename, options);
+				if (!result)
+				{
+					std::cout << "can't convert .ply into the internal model format" << std::endl;
+					return false;
+				}
+				break;
+			}
+			case INPUT_FILE_TYPE_STL:
+			{
+				if (!pStlConverter_)
+					pStlConverter_ = std::make_unique<ModelConverterForStlTypeClass>();
+
+				result = pStlConverter_->ConvertFromStl(inputFilename, outputFilename, options);
+				if (!result)
+				{
+					std::cout << "can't convert .stl into the internal model format" << std::endl;
+					return false;
+				}
+				break;
+			}
+			default:
+			{
+				if (!pObjConverter_)
+					pObjConverter_ = std::make_unique<ModelConverterForObjTypeClass>();
+
+				result = pObjConverter_->ConvertFromObj(inputFilename, outputFilename, options);
+				if (!result)
+				{
+					std::cout << "can't convert .obj into the internal model format" << std::endl;
+					return false;
+				}
+				break;
+			}
 		}
 
 		return true;
 	}
 
-	
-};
\ No newline at end of file
+	// define the type of the input file by its magic bytes (or by its extension if there are no magic bytes)
+	static INPUT_FILE_TYPE DetectInputFileType(const char* inputFilename)
+	{
+		std::ifstream fin(inputFilename, std::ios::in | std::ios::binary | std::ios::ate);
+
+		if (fin.fail())
+			return INPUT_FILE_TYPE_UNKNOWN;
+
+		// read in the beginning of the file (the binary STL header and the triangles count)
+		char magic[84] = { '\0' };
+		const size_t fileSize = (size_t)fin.tellg();
+
+		fin.seekg(0, std::ios::beg);
+		fin.read(magic, (std::min)(fileSize, sizeof(magic)));
+
+		if ((strncmp(magic, "ply", 3) == 0) && ((magic[3] == '\n') || (magic[3] == '\r')))
+			return INPUT_FILE_TYPE_PLY;
+
+		if (ModelConverterForStlTypeClass::IsBinaryStl(magic, fileSize))
+			return INPUT_FILE_TYPE_STL;
+
+		// there are no magic bytes so check the extension
+		std::string extension{ inputFilename };
+		const size_t dotPos = extension.find_last_of('.');
+
+		extension = (dotPos == std::string::npos) ? "" : extension.substr(dotPos + 1);
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+
+		if (extension == "ply")
+			return INPUT_FILE_TYPE_PLY;
+
+		if (extension == "stl")
+			return INPUT_FILE_TYPE_STL;
+
+		return INPUT_FILE_TYPE_OBJ;
+	}
+
+private:
+	// the converters are created by the first usage and are kept so the interface
+	// which is used for many conversions reuses their memory
+	std::unique_ptr<ModelConverterForObjTypeClass> pObjConverter_;
+	std::unique_ptr<ModelConverterForPlyTypeClass> pPlyConverter_;
+	std::unique_ptr<ModelConverterForStlTypeClass> pStlConverter_;
+};
@@ -0,0 +1,309 @@
+#include "ModelConverterServiceClass.h"
+#include "ModelConverterInterface.h"
+#include "ParallelFor.h"
+
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <cstring>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+
+ModelConverterServiceClass::ModelConverterServiceClass(const size_t workersCount)
+	: workersCount_((workersCount > 0) ? workersCount : (std::max)((size_t)1, GetWorkerThreadsCount() / 2))
+{
+}
+
+ModelConverterServiceClass::~ModelConverterServiceClass(void)
+{
+	this->Stop();
+}
+
+
+
+// ----------------------------------------------------------------------------------- //
+//
+//                          PUBLIC METHODS
+//
+// ----------------------------------------------------------------------------------- //
+
+#ifdef _WIN32
+
+bool ModelConverterServiceClass::Run(const char* socketPath)
+{
+	Log::Error(LOG_MACRO, "the conversion service isn't supported on Windows");
+	return false;
+}
+
+void ModelConverterServiceClass::Stop()
+{
+}
+
+#else
+
+// listen to the socket and handle the requests until Stop() is called (from another thread)
+bool ModelConverterServiceClass::Run(const char* socketPath)
+{
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+
+	if (strlen(socketPath) >= sizeof(address.sun_path))
+	{
+		Log::Error(LOG_MACRO, (std::string("the socket path is too long: ") + socketPath).c_str());
+		return false;
+	}
+
+	strncpy(address.sun_path, socketPath, sizeof(address.sun_path) - 1);
+
+	const int listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+	if (listenFd < 0)
+	{
+		Log::Error(LOG_MACRO, "can't create the socket");
+		return false;
+	}
+
+	// the socket file of the previous run of the service can be still there
+	unlink(socketPath);
+
+	if ((bind(listenFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) || (listen(listenFd, SOMAXCONN) != 0))
+	{
+		Log::Error(LOG_MACRO, (std::string("can't listen to the socket: ") + socketPath).c_str());
+		close(listenFd);
+		return false;
+	}
+
+	isRunning_ = true;
+
+	// the processing stages of all the requests share the warm threads of this pool (the worker
+	// which handles the request executes its chunks too, so the pool has one thread less)
+	threadPool_ = std::make_shared<ThreadPoolClass>((std::max)((size_t)1, GetWorkerThreadsCount() - 1));
+	ThreadPoolClass::SetSharedPool(threadPool_);
+
+	std::vector<std::thread> workers;
+
+	for (size_t i = 0; i < workersCount_; i++)
+		workers.emplace_back(&ModelConverterServiceClass::WorkerThreadFunc, this);
+
+	Log::Print("service: listening on %s (%u workers)", socketPath, (UINT)workersCount_);
+
+	// accept connections and pass them to the workers
+	while (isRunning_)
+	{
+		pollfd pollFd = { listenFd, POLLIN, 0 };
+
+		if (poll(&pollFd, 1, ACCEPT_WAIT_MS_) <= 0)
+			continue;
+
+		const int connectionFd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+
+		if (connectionFd < 0)
+			continue;
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		connections_.push_back(connectionFd);
+		connectionsCondition_.notify_one();
+	}
+
+	// wake up the workers (and break the connections which they are waiting on)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		for (const int connectionFd : activeConnections_)
+			shutdown(connectionFd, SHUT_RDWR);
+
+		connectionsCondition_.notify_all();
+	}
+
+	for (std::thread & worker : workers)
+		worker.join();
+
+	ThreadPoolClass::SetSharedPool(nullptr);
+	threadPool_.reset();
+
+	for (const int connectionFd : connections_)
+		close(connectionFd);
+
+	connections_.clear();
+	close(listenFd);
+	unlink(socketPath);
+
+	Log::Print("service: stopped (requests: %u)", (UINT)requestsCount_);
+
+	return true;
+}
+
+
+void ModelConverterServiceClass::Stop()
+{
+	isRunning_ = false;
+}
+
+#endif
+
+
+
+// ----------------------------------------------------------------------------------- //
+//
+//                          PRIVATE METHODS / HELPERS
+//
+// ----------------------------------------------------------------------------------- //
+
+#ifndef _WIN32
+
+// handle the connections one by one; each worker has its own converter
+// which lives as long as the service
+void ModelConverterServiceClass::WorkerThreadFunc()
+{
+	ModelConverterInterface converter;
+
+	while (true)
+	{
+		int connectionFd = -1;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			connectionsCondition_.wait(lock, [this]() { return !isRunning_ || !connections_.empty(); });
+
+			if (!isRunning_)
+				return;
+
+			connectionFd = connections_.front();
+			connections_.pop_front();
+			activeConnections_.insert(connectionFd);
+		}
+
+		this->HandleConnection(connectionFd, converter);
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		activeConnections_.erase(connectionFd);
+		close(connectionFd);
+	}
+}
+
+
+// handle the requests of the connection until the client closes it
+void ModelConverterServiceClass::HandleConnection(const int connectionFd, ModelConverterInterface & converter)
+{
+	while (isRunning_ && this->HandleRequest(connectionFd, converter))
+	{
+	}
+
+	return;
+}
+
+
+// read in the request, convert the model and send the response;
+// returns false if the connection is closed or the request is invalid
+bool ModelConverterServiceClass::HandleRequest(const int connectionFd, ModelConverterInterface & converter)
+{
+	MODEL_CONVERTER_REQUEST_HEADER header;
+
+	if (!ReadAll(connectionFd, &header, sizeof(header)))
+		return false;
+
+	if ((header.magic != MODEL_CONVERTER_SERVICE_MAGIC) ||
+		(header.version != MODEL_CONVERTER_SERVICE_VERSION) ||
+		(header.optionsSize != sizeof(ConversionOptions)) ||
+		(header.inputSize == 0) || (header.inputSize > MODEL_CONVERTER_SERVICE_MAX_PATH_SIZE) ||
+		(header.outputSize == 0) || (header.outputSize > MODEL_CONVERTER_SERVICE_MAX_PATH_SIZE))
+	{
+		Log::Error(LOG_MACRO, "service: an invalid request (or the client is built with other options)");
+		return false;
+	}
+
+	ConversionOptions options;
+	std::string input(header.inputSize, '\0');
+	std::string outputFilename(header.outputSize, '\0');
+
+	if (!ReadAll(connectionFd, &options, sizeof(options)) ||
+		!ReadAll(connectionFd, &input[0], input.size()) ||
+		!ReadAll(connectionFd, &outputFilename[0], outputFilename.size()))
+	{
+		return false;
+	}
+
+	std::string inputFilename;
+
+	switch (header.type)
+	{
+		case MODEL_CONVERTER_REQUEST_CONVERT_FILE:
+			inputFilename = input;
+			break;
+
+		// the shared memory object is a file in the shared memory directory (its name
+		// is like "/name.obj" so it mustn't have any other slashes)
+		case MODEL_CONVERTER_REQUEST_CONVERT_SHARED_MEMORY:
+			if ((input[0] != '/') || (input.find('/', 1) != std::string::npos))
+			{
+				Log::Error(LOG_MACRO, ("service: an invalid name of the shared memory object: " + input).c_str());
+				return false;
+			}
+			inputFilename = SHARED_MEMORY_DIRECTORY_ + input;
+			break;
+
+		default:
+			Log::Error(LOG_MACRO, ("service: an unknown request type: " + std::to_string(header.type)).c_str());
+			return false;
+	}
+
+	const auto startTime = std::chrono::steady_clock::now();
+
+	MODEL_CONVERTER_RESPONSE response;
+	response.result = converter.Convert(inputFilename.c_str(), outputFilename.c_str(), options) ? 1 : 0;
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	requestsCount_++;
+
+	Log::Print("service: %s %s -> %s (%.3f s)",
+		(response.result != 0) ? "converted" : "can't convert",
+		inputFilename.c_str(),
+		outputFilename.c_str(),
+		seconds);
+
+	return WriteAll(connectionFd, &response, sizeof(response));
+}
+
+
+bool ModelConverterServiceClass::ReadAll(const int fd, void* pData, const size_t size)
+{
+	char* ptr = static_cast<char*>(pData);
+
+	for (size_t readSize = 0; readSize < size; )
+	{
+		const ssize_t result = read(fd, ptr + readSize, size - readSize);
+
+		if (result <= 0)
+			return false;
+
+		readSize += (size_t)result;
+	}
+
+	return true;
+}
+
+
+bool ModelConverterServiceClass::WriteAll(const int fd, const void* pData, const size_t size)
+{
+	const char* ptr = static_cast<const char*>(pData);
+
+	for (size_t writtenSize = 0; writtenSize < size; )
+	{
+		const ssize_t result = send(fd, ptr + writtenSize, size - writtenSize, MSG_NOSIGNAL);
+
+		if (result <= 0)
+			return false;
+
+		writtenSize += (size_t)result;
+	}
+
+	return true;
+}
+
+#endif
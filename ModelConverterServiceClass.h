@@ -0,0 +1,73 @@
+/////////////////////////////////////////////////////////////////////
+// Filename:     ModelConverterServiceClass.h
+// Description:  a resident conversion service: listens on the Unix
+//               domain socket and converts models by the requests
+//               of the clients (see ModelConverterServiceProtocol.h);
+//               the worker threads and their converters live as long
+//               as the service so the requests don't pay for the
+//               initialization and the memory of the converters is
+//               reused; the parallel processing stages of all the
+//               requests run on the same warm thread pool; all the
+//               requests are logged into the same log
+//
+//               the service is available on POSIX systems only
+//
+// Created:      19.10.26
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////////////////////////
+// INCLUDES
+//////////////////////////////////
+#include "ModelConverterServiceProtocol.h"
+#include "ThreadPoolClass.h"
+#include "Log.h"       // for using the log system
+
+#include <string>
+#include <set>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+
+class ModelConverterInterface;
+
+
+//////////////////////////////////
+// Class name: ModelConverterServiceClass
+//////////////////////////////////
+class ModelConverterServiceClass
+{
+public:
+	ModelConverterServiceClass(const size_t workersCount = 0);   // 0 -- half of the hardware threads
+	~ModelConverterServiceClass(void);
+
+	// listen to the socket and handle the requests until Stop() is called (from another thread)
+	bool Run(const char* socketPath);
+	void Stop();
+
+private:
+	void WorkerThreadFunc();
+	void HandleConnection(const int connectionFd, ModelConverterInterface & converter);
+	bool HandleRequest(const int connectionFd, ModelConverterInterface & converter);
+
+	static bool ReadAll(const int fd, void* pData, const size_t size);
+	static bool WriteAll(const int fd, const void* pData, const size_t size);
+
+private:
+	size_t workersCount_ = 0;
+	std::shared_ptr<ThreadPoolClass> threadPool_;        // is shared with ParallelFor() while the service runs
+
+	std::mutex mutex_;                                   // guards the connections
+	std::condition_variable connectionsCondition_;
+	std::deque<int> connections_;                        // accepted connections which wait for a worker
+	std::set<int> activeConnections_;                    // connections which are handled by workers right now
+
+	std::atomic<bool> isRunning_{ false };
+	std::atomic<size_t> requestsCount_{ 0 };
+
+	// constants
+	const int ACCEPT_WAIT_MS_ = 200;                     // how often the listening thread checks the stop flag
+	const char* SHARED_MEMORY_DIRECTORY_ = "/dev/shm";   // where Linux keeps the POSIX shared memory objects
+};
@@ -0,0 +1,47 @@
+/////////////////////////////////////////////////////////////////////
+// Filename:     ModelConverterServiceProtocol.h
+// Description:  messages between the resident conversion service
+//               (ModelConverterServiceClass) and its clients
+//               (ModelConverterClient) over the Unix domain socket
+//
+//               a client sends a request: the request header, the
+//               conversion options, the input (a path of the file or
+//               a name of the POSIX shared memory object with the file's
+//               data) and the output filename; then it waits for
+//               the response; a connection can be used for many requests
+//
+// Created:      19.10.26
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "ConversionOptions.h"
+
+#include <cstdint>
+
+
+const char* const MODEL_CONVERTER_SERVICE_DEFAULT_SOCKET = "/tmp/model_converter.sock";
+const uint32_t MODEL_CONVERTER_SERVICE_MAGIC = 0x5643434D;      // "MCCV"
+const uint32_t MODEL_CONVERTER_SERVICE_VERSION = 1;
+const uint32_t MODEL_CONVERTER_SERVICE_MAX_PATH_SIZE = 4096;    // max size of the input/output in the request
+
+enum MODEL_CONVERTER_REQUEST_TYPE
+{
+	MODEL_CONVERTER_REQUEST_CONVERT_FILE = 1,            // the input is a path of the file
+	MODEL_CONVERTER_REQUEST_CONVERT_SHARED_MEMORY = 2,   // the input is a name of the shared memory object (like "/name.obj")
+};
+
+struct MODEL_CONVERTER_REQUEST_HEADER
+{
+	uint32_t magic = MODEL_CONVERTER_SERVICE_MAGIC;
+	uint32_t version = MODEL_CONVERTER_SERVICE_VERSION;
+	uint32_t type = MODEL_CONVERTER_REQUEST_CONVERT_FILE;
+	uint32_t optionsSize = sizeof(ConversionOptions);    // the client and the service must be built with the same options
+	uint32_t inputSize = 0;                              // without the terminating zero
+	uint32_t outputSize = 0;                             // without the terminating zero
+};
+
+struct MODEL_CONVERTER_RESPONSE
+{
+	uint32_t magic = MODEL_CONVERTER_SERVICE_MAGIC;
+	uint32_t result = 0;                                 // 1 -- the model was converted
+};
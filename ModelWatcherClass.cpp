@@ -0,0 +1,440 @@
+#include "ModelWatcherClass.h"
+#include "ModelConverterForObjTypeClass.h"
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <cctype>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+
+ModelWatcherClass::ModelWatcherClass(const ConversionOptions & options, const WATCH_SETTINGS & settings)
+	: options_(options),
+	  settings_(settings)
+{
+}
+
+ModelWatcherClass::~ModelWatcherClass(void)
+{
+	this->Stop();
+}
+
+
+
+// ----------------------------------------------------------------------------------- //
+//
+//                          PUBLIC METHODS
+//
+// ----------------------------------------------------------------------------------- //
+
+// start watching of the directory (it can be called before or after Start())
+bool ModelWatcherClass::AddDirectory(const std::string & inputDirectory, const std::string & outputDirectory)
+{
+	std::error_code errorCode;
+	WATCHED_DIRECTORY directory;
+
+	directory.inputDirectory = fs::path(inputDirectory);
+	directory.outputDirectory = fs::path(outputDirectory);
+
+	if (!fs::is_directory(directory.inputDirectory, errorCode))
+	{
+		Log::Error(LOG_MACRO, ("there is no input directory: " + inputDirectory).c_str());
+		return false;
+	}
+
+	if (!fs::create_directories(directory.outputDirectory, errorCode) && errorCode)
+	{
+		Log::Error(LOG_MACRO, ("can't create the output directory: " + outputDirectory).c_str());
+		return false;
+	}
+
+#ifdef __linux__
+	if (inotifyFd_ >= 0)
+	{
+		// IN_CLOSE_WRITE/IN_MOVED_TO come when a file is written completely,
+		// IN_MODIFY postpones the conversion while the file is being written
+		directory.watchDescriptor = inotify_add_watch(inotifyFd_, inputDirectory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_MODIFY | IN_CREATE);
+
+		if (directory.watchDescriptor < 0)
+			Log::Print("watch: can't use inotify for %s (the directory will be polled)", inputDirectory.c_str());
+	}
+#endif
+
+	// convert files which are newer than their output files
+	this->ScanDirectory(directory, true);
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	directories_.push_back(directory);
+
+	return true;
+}
+
+
+bool ModelWatcherClass::Start()
+{
+	if (isRunning_)
+		return true;
+
+#ifdef __linux__
+	if (!settings_.forcePolling)
+	{
+		inotifyFd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+		if (inotifyFd_ < 0)
+			Log::Print("watch: inotify isn't available, directories will be polled");
+	}
+
+	// the directories which were added before start are watched with inotify from now on
+	if (inotifyFd_ >= 0)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		for (WATCHED_DIRECTORY & directory : directories_)
+			directory.watchDescriptor = inotify_add_watch(inotifyFd_, directory.inputDirectory.string().c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_MODIFY | IN_CREATE);
+	}
+#endif
+
+	const size_t workersCount = (settings_.workersCount > 0) ? settings_.workersCount : (std::max)((size_t)1, GetWorkerThreadsCount() / 2);
+
+	isRunning_ = true;
+	watchThread_ = std::thread(&ModelWatcherClass::WatchThreadFunc, this);
+
+	for (size_t i = 0; i < workersCount; i++)
+		workers_.emplace_back(&ModelWatcherClass::WorkerThreadFunc, this);
+
+	Log::Print("watch: started (%u workers, %s)", (UINT)workersCount, (inotifyFd_ >= 0) ? "inotify" : "polling");
+
+	return true;
+}
+
+
+// stop the watching; the conversions which are in progress are finished,
+// and the queued ones are dropped
+void ModelWatcherClass::Stop()
+{
+	if (!isRunning_.exchange(false))
+		return;
+
+	queueCondition_.notify_all();
+
+	if (watchThread_.joinable())
+		watchThread_.join();
+
+	for (std::thread & worker : workers_)
+		worker.join();
+
+	workers_.clear();
+	queue_.clear();
+	filesInProgress_.clear();
+
+#ifdef __linux__
+	if (inotifyFd_ >= 0)
+	{
+		close(inotifyFd_);
+		inotifyFd_ = -1;
+	}
+#endif
+
+	Log::Print("watch: stopped");
+
+	return;
+}
+
+
+
+// ----------------------------------------------------------------------------------- //
+//
+//                          PRIVATE METHODS / HELPERS
+//
+// ----------------------------------------------------------------------------------- //
+
+// wait for changes of files and queue the files which haven't been changed for the debounce time
+void ModelWatcherClass::WatchThreadFunc()
+{
+	auto lastScanTime = std::chrono::steady_clock::now();
+
+	while (isRunning_)
+	{
+#ifdef __linux__
+		if (inotifyFd_ >= 0)
+		{
+			pollfd pollFd = { inotifyFd_, POLLIN, 0 };
+
+			if (poll(&pollFd, 1, INOTIFY_WAIT_MS_) > 0)
+				this->ReadInotifyEvents();
+		}
+		else
+#endif
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(INOTIFY_WAIT_MS_));
+		}
+
+		// scan the directories which aren't watched with inotify
+		if (std::chrono::steady_clock::now() - lastScanTime >= std::chrono::milliseconds(settings_.pollIntervalMs))
+		{
+			std::vector<WATCHED_DIRECTORY> directories;
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				directories = directories_;
+			}
+
+			for (const WATCHED_DIRECTORY & directory : directories)
+			{
+				if (directory.watchDescriptor < 0)
+					this->ScanDirectory(directory, false);
+			}
+
+			lastScanTime = std::chrono::steady_clock::now();
+		}
+
+		this->QueueReadyFiles();
+	}
+
+	return;
+}
+
+
+// convert the queued files one by one
+void ModelWatcherClass::WorkerThreadFunc()
+{
+	while (true)
+	{
+		CONVERSION_TASK task;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			queueCondition_.wait(lock, [this]() { return !isRunning_ || !queue_.empty(); });
+
+			if (!isRunning_)
+				return;
+
+			task = queue_.front();
+			queue_.pop_front();
+		}
+
+		this->ConvertFile(task);
+
+		// if the file was changed during the conversion it is still in the pending files so it will be converted again
+		std::lock_guard<std::mutex> lock(mutex_);
+		filesInProgress_.erase(task.inputFilename.string());
+	}
+}
+
+
+// find .obj files which were changed since the last scan (or which are newer than their output files for the initial scan)
+void ModelWatcherClass::ScanDirectory(const WATCHED_DIRECTORY & directory, const bool isInitialScan)
+{
+	std::error_code errorCode;
+
+	for (fs::directory_iterator it(directory.inputDirectory, errorCode), end; !errorCode && (it != end); it.increment(errorCode))
+	{
+		const fs::path & inputFilename = it->path();
+		std::error_code fileErrorCode;
+
+		if (!IsObjFile(inputFilename) || !it->is_regular_file(fileErrorCode))
+			continue;
+
+		// the file can be removed/renamed during the scan
+		FILE_STATE state;
+		state.writeTime = fs::last_write_time(inputFilename, fileErrorCode);
+		state.size = fs::file_size(inputFilename, fileErrorCode);
+
+		if (fileErrorCode)
+			continue;
+
+		bool isChanged = false;
+
+		if (isInitialScan)
+		{
+			const fs::path outputFilename = this->GetOutputFilename(inputFilename, directory.outputDirectory);
+			std::error_code outputErrorCode;
+			const fs::file_time_type outputWriteTime = fs::last_write_time(outputFilename, outputErrorCode);
+
+			isChanged = outputErrorCode || (outputWriteTime < state.writeTime);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			auto knownIt = knownFiles_.find(inputFilename.string());
+
+			if (!isInitialScan)
+			{
+				isChanged = (knownIt == knownFiles_.end()) ||
+					(knownIt->second.writeTime != state.writeTime) ||
+					(knownIt->second.size != state.size);
+			}
+
+			knownFiles_[inputFilename.string()] = state;
+		}
+
+		if (isChanged)
+			this->MarkFileAsChanged(inputFilename, directory.outputDirectory, !isInitialScan);
+	}
+
+	return;
+}
+
+
+// mark files from the inotify events as changed
+void ModelWatcherClass::ReadInotifyEvents()
+{
+#ifdef __linux__
+	alignas(inotify_event) char buffer[4096];
+
+	while (true)
+	{
+		const ssize_t length = read(inotifyFd_, buffer, sizeof(buffer));
+
+		if (length <= 0)
+			break;
+
+		for (const char* ptr = buffer; ptr < buffer + length; )
+		{
+			const inotify_event* pEvent = reinterpret_cast<const inotify_event*>(ptr);
+			ptr += sizeof(inotify_event) + pEvent->len;
+
+			if (pEvent->len == 0)
+				continue;
+
+			fs::path inputFilename;
+			fs::path outputDirectory;
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+
+				for (const WATCHED_DIRECTORY & directory : directories_)
+				{
+					if (directory.watchDescriptor == pEvent->wd)
+					{
+						inputFilename = directory.inputDirectory / pEvent->name;
+						outputDirectory = directory.outputDirectory;
+						break;
+					}
+				}
+			}
+
+			if (!inputFilename.empty() && IsObjFile(inputFilename))
+				this->MarkFileAsChanged(inputFilename, outputDirectory, false);
+		}
+	}
+#endif
+
+	return;
+}
+
+
+// (re)start the debounce time of the file
+void ModelWatcherClass::MarkFileAsChanged(const fs::path & inputFilename, const fs::path & outputDirectory, const bool isPolled)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	PENDING_FILE & pendingFile = pendingFiles_[inputFilename.string()];
+	pendingFile.lastChangeTime = std::chrono::steady_clock::now();
+	pendingFile.outputDirectory = outputDirectory;
+	pendingFile.isPolled = isPolled;
+
+	return;
+}
+
+
+// queue the files which haven't been changed for the debounce time (for polled files we
+// also wait for the poll interval so at least one more scan sees the same file's state);
+// a file which is being converted right now waits for the end of its conversion
+void ModelWatcherClass::QueueReadyFiles()
+{
+	const auto now = std::chrono::steady_clock::now();
+	const auto debounceTime = std::chrono::milliseconds(settings_.debounceMs);
+	const auto polledDebounceTime = std::chrono::milliseconds(settings_.debounceMs + settings_.pollIntervalMs);
+	bool hasNewTasks = false;
+
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	for (auto it = pendingFiles_.begin(); it != pendingFiles_.end(); )
+	{
+		const auto fileDebounceTime = it->second.isPolled ? polledDebounceTime : debounceTime;
+
+		if ((now - it->second.lastChangeTime < fileDebounceTime) || (filesInProgress_.count(it->first) > 0))
+		{
+			++it;
+			continue;
+		}
+
+		queue_.push_back({ fs::path(it->first), it->second.outputDirectory });
+		filesInProgress_.insert(it->first);
+		it = pendingFiles_.erase(it);
+		hasNewTasks = true;
+	}
+
+	if (hasNewTasks)
+		queueCondition_.notify_all();
+
+	return;
+}
+
+
+// convert the file into the temporary directory and then move the output files into the output
+// directory; the main output file is moved the last so when it appears all its files are ready
+bool ModelWatcherClass::ConvertFile(const CONVERSION_TASK & task)
+{
+	std::error_code errorCode;
+	const auto startTime = std::chrono::steady_clock::now();
+	const fs::path outputFilename = this->GetOutputFilename(task.inputFilename, task.outputDirectory);
+	const fs::path tempDirectory = task.outputDirectory / (TEMP_DIRECTORY_PREFIX_ + task.inputFilename.stem().string());
+	const fs::path tempOutputFilename = tempDirectory / outputFilename.filename();
+
+	fs::remove_all(tempDirectory, errorCode);
+	fs::create_directories(tempDirectory, errorCode);
+
+	bool result = ModelConverterForObjTypeClass().ConvertFromObj(
+		task.inputFilename.string().c_str(),
+		tempOutputFilename.string().c_str(),
+		options_);
+
+	if (result)
+	{
+		// move the additional files (vertex buffers, compressed streams, etc.)
+		std::error_code moveErrorCode;
+
+		for (fs::directory_iterator it(tempDirectory, errorCode), end; !errorCode && (it != end); it.increment(errorCode))
+		{
+			if (it->path().filename() != tempOutputFilename.filename())
+			{
+				fs::rename(it->path(), task.outputDirectory / it->path().filename(), moveErrorCode);
+				result = result && !moveErrorCode;
+			}
+		}
+
+		fs::rename(tempOutputFilename, outputFilename, moveErrorCode);
+		result = result && !errorCode && !moveErrorCode;
+	}
+
+	fs::remove_all(tempDirectory, errorCode);
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+	if (result)
+		Log::Print("watch: converted %s (%.3f s)", task.inputFilename.string().c_str(), seconds);
+	else
+		Log::Print("watch: can't convert %s", task.inputFilename.string().c_str());
+
+	return result;
+}
+
+
+bool ModelWatcherClass::IsObjFile(const fs::path & filename)
+{
+	std::string extension = filename.extension().string();
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+
+	return extension == ".obj";
+}
+
+
+fs::path ModelWatcherClass::GetOutputFilename(const fs::path & inputFilename, const fs::path & outputDirectory) const
+{
+	return outputDirectory / (inputFilename.stem().string() + OUTPUT_FILE_EXTENSION_);
+}
@@ -0,0 +1,123 @@
+/////////////////////////////////////////////////////////////////////
+// Filename:     ModelWatcherClass.h
+// Description:  a watch mode of the converter: monitors directories
+//               with .obj files (with inotify on Linux, or by polling
+//               of the directories) and reconverts changed files on
+//               background threads; a file is converted only when
+//               it hasn't been changed for the debounce time (so we
+//               don't read partially written files); the output files
+//               are written into a temporary directory and then are
+//               renamed into the output directory (so the engine never
+//               sees a half-written mesh)
+//
+// Created:      19.10.26
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////////////////////////
+// INCLUDES
+//////////////////////////////////
+#include "ConversionOptions.h"
+#include "Log.h"       // for using the log system
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+
+
+struct WATCH_SETTINGS
+{
+	size_t debounceMs = 300;             // a file is converted when it hasn't been changed for this time
+	size_t pollIntervalMs = 500;         // how often directories are scanned when there is no inotify
+	size_t workersCount = 0;             // how many files can be converted at the same time (0 -- half of the hardware threads)
+	bool forcePolling = false;           // don't use inotify even if it is available
+};
+
+
+//////////////////////////////////
+// Class name: ModelWatcherClass
+//////////////////////////////////
+class ModelWatcherClass
+{
+public:
+	ModelWatcherClass(const ConversionOptions & options, const WATCH_SETTINGS & settings = WATCH_SETTINGS());
+	~ModelWatcherClass(void);
+
+	// start watching of the directory (it can be called before or after Start());
+	// .obj files from the input directory are converted into .txt files in the output directory;
+	// files which are newer than their output files are converted right away
+	bool AddDirectory(const std::string & inputDirectory, const std::string & outputDirectory);
+
+	bool Start();
+	void Stop();     // waits for the conversions which are in progress
+
+private:
+	struct WATCHED_DIRECTORY
+	{
+		std::filesystem::path inputDirectory;
+		std::filesystem::path outputDirectory;
+		int watchDescriptor = -1;            // inotify watch descriptor
+	};
+
+	struct FILE_STATE
+	{
+		std::filesystem::file_time_type writeTime;
+		uintmax_t size = 0;
+	};
+
+	struct PENDING_FILE
+	{
+		std::chrono::steady_clock::time_point lastChangeTime;
+		std::filesystem::path outputDirectory;
+		bool isPolled = false;               // the change was found by a scan (not by an inotify event)
+	};
+
+	struct CONVERSION_TASK
+	{
+		std::filesystem::path inputFilename;
+		std::filesystem::path outputDirectory;
+	};
+
+	void WatchThreadFunc();
+	void WorkerThreadFunc();
+
+	void ScanDirectory(const WATCHED_DIRECTORY & directory, const bool isInitialScan);
+	void ReadInotifyEvents();
+	void MarkFileAsChanged(const std::filesystem::path & inputFilename, const std::filesystem::path & outputDirectory, const bool isPolled);
+	void QueueReadyFiles();
+
+	bool ConvertFile(const CONVERSION_TASK & task);
+
+	static bool IsObjFile(const std::filesystem::path & filename);
+	std::filesystem::path GetOutputFilename(const std::filesystem::path & inputFilename, const std::filesystem::path & outputDirectory) const;
+
+private:
+	ConversionOptions options_;
+	WATCH_SETTINGS settings_;
+
+	std::mutex mutex_;                                             // guards all the containers below
+	std::condition_variable queueCondition_;
+	std::vector<WATCHED_DIRECTORY> directories_;
+	std::map<std::string, FILE_STATE> knownFiles_;                 // states of files at the last scan
+	std::map<std::string, PENDING_FILE> pendingFiles_;             // changed files which wait for the debounce time
+	std::deque<CONVERSION_TASK> queue_;                            // files which are ready for the conversion
+	std::set<std::string> filesInProgress_;                        // files which are queued or are being converted
+
+	std::atomic<bool> isRunning_{ false };
+	std::thread watchThread_;
+	std::vector<std::thread> workers_;
+	int inotifyFd_ = -1;
+
+	// constants
+	const char* OUTPUT_FILE_EXTENSION_ = ".txt";
+	const char* TEMP_DIRECTORY_PREFIX_ = ".converting_";           // the output files are written here before they are renamed
+	const int   INOTIFY_WAIT_MS_ = 50;                             // how long the watch thread waits for inotify events
+};
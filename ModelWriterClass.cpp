@@ -0,0 +1,1007 @@
+#include "ModelWriterClass.h"
+#include "MeshEncoderClass.h"
+#include "MeshDecoderClass.h"
+#include "VertexLayoutClass.h"
+#include "MeshTilingClass.h"
+#include "MeshInstancingClass.h"
+#include "ParallelFor.h"
+#include "TraceRecorderClass.h"
+#include <cassert>
+#include <cstring>
+#include <charconv>
+#include <numeric>
+#include <atomic>
+
+
+// append the number into the text in the same way as the std::ostream does it
+// (floats are written in the fixed notation with 6 digits after the point)
+static inline void AppendUInt(std::string & out, const size_t value)
+{
+	char buffer[24];
+	const std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+	out.append(buffer, result.ptr);
+}
+
+static inline void AppendFloat(std::string & out, const float value)
+{
+	char buffer[64];
+	const std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed, 6);
+	out.append(buffer, result.ptr);
+}
+
+
+ModelWriterClass::ModelWriterClass(const ConversionOptions & options)
+	: options_(options)
+{
+}
+
+
+// write all the mesh data into the output data file
+bool ModelWriterClass::WriteIntoOutputFile(const MeshData & mesh, std::ofstream & fout, const char* outputFilename)
+{
+	TRACE_SCOPE("WriteIntoOutputFile");
+	TRACE_ARG("file", outputFilename);
+
+	// the bulk sections are written at their offsets through a second handle of the same file
+	outputFile_.Open(outputFilename);
+
+	// write the number of vertices/indices/texture coords into the output data file
+	this->WriteCountsIntoOutputFile(mesh, fout);
+
+	if (!WriteVerticesIntoOutputFile(mesh, fout))
+	{
+		Log::Error(LOG_MACRO, "can't write vertices data");
+		return false;
+	}
+	Log::Debug(LOG_MACRO, "VERTICES DATA WAS WRITTEN SUCCESSFULLY");
+
+
+	if (!WriteTexturesIntoOutputFile(mesh, fout))
+	{
+		Log::Error(LOG_MACRO, "can't write textures data");
+		return false;
+	}
+	Log::Debug(LOG_MACRO, "TEXTURE DATA WAS WRITTEN SUCCESSFULLY");
+
+
+	if (!this->WriteIndicesIntoOutputFile(mesh, fout))
+	{
+		Log::Error(LOG_MACRO, "can't write indices data");
+		return false;
+	}
+	Log::Debug(LOG_MACRO, "FACES DATA WAS WRITTEN SUCCESSFULLY");
+
+
+	if (!this->WriteSubmeshesIntoOutputFile(mesh, fout))
+	{
+		Log::Error(LOG_MACRO, "can't write submeshes data");
+		return false;
+	}
+	Log::Debug(LOG_MACRO, "SUBMESHES DATA WAS WRITTEN SUCCESSFULLY");
+
+
+	// the optional sections are written only if they were computed
+	if (!mesh.adjacencyIndices.empty() && !this->WriteAdjacencyIntoOutputFile(mesh, fout))
+	{
+		Log::Error(LOG_MACRO, "can't write adjacency data");
+		return false;
+	}
+
+	if (!mesh.edges.empty() && !this->WriteEdgesIntoOutputFile(mesh, fout))
+	{
+		Log::Error(LOG_MACRO, "can't write edges data");
+		return false;
+	}
+
+	if (!mesh.ambientOcclusion.empty() && !this->WriteAmbientOcclusionIntoOutputFile(mesh, fout))
+	{
+		Log::Error(LOG_MACRO, "can't write ambient occlusion data");
+		return false;
+	}
+
+
+	// write the vertex buffers with the chosen layout into a separate binary file and describe them in the output file
+	if (options_.vertexLayout != VERTEX_LAYOUT_NONE)
+	{
+		const std::string vertexBuffersFilename = std::string(outputFilename) + VERTEX_BUFFERS_FILE_EXTENSION_;
+
+		if (!this->WriteVertexBuffersFile(mesh, vertexBuffersFilename, fout))
+		{
+			Log::Error(LOG_MACRO, ("can't write the vertex buffers file: " + vertexBuffersFilename).c_str());
+			return false;
+		}
+		Log::Debug(LOG_MACRO, "VERTEX BUFFERS WERE WRITTEN SUCCESSFULLY");
+	}
+
+
+	// write the spatial tiles into separate files and put a name of the tiles index file into the output file
+	if (options_.tilingMode != TILING_MODE_NONE)
+	{
+		const std::string tilesIndexFilename = std::string(outputFilename) + TILES_INDEX_FILE_EXTENSION_;
+		const std::string tilesDataFilename = std::string(outputFilename) + TILES_DATA_FILE_EXTENSION_;
+
+		if (!this->WriteTilesFiles(mesh, tilesIndexFilename, tilesDataFilename))
+		{
+			Log::Error(LOG_MACRO, ("can't write the tiles files: " + tilesIndexFilename).c_str());
+			return false;
+		}
+
+		fout << "\n\n";
+		fout << "Tiles Index File: " << GetFilenameWithoutDirectory(tilesIndexFilename) << "\n";
+		Log::Debug(LOG_MACRO, "TILES WERE WRITTEN SUCCESSFULLY");
+	}
+
+
+	// write the unique groups/objects and their instances into separate files and put a name of the instances index file into the output file
+	if (options_.detectInstances)
+	{
+		const std::string instancesIndexFilename = std::string(outputFilename) + INSTANCES_INDEX_FILE_EXTENSION_;
+		const std::string instancesDataFilename = std::string(outputFilename) + INSTANCES_DATA_FILE_EXTENSION_;
+
+		if (!this->WriteInstancesFiles(mesh, instancesIndexFilename, instancesDataFilename))
+		{
+			Log::Error(LOG_MACRO, ("can't write the instances files: " + instancesIndexFilename).c_str());
+			return false;
+		}
+
+		fout << "\n\n";
+		fout << "Instances Index File: " << GetFilenameWithoutDirectory(instancesIndexFilename) << "\n";
+		Log::Debug(LOG_MACRO, "INSTANCES WERE WRITTEN SUCCESSFULLY");
+	}
+
+
+	// write the compressed streams into a separate binary file and put its name into the output file
+	if (options_.compressStreams)
+	{
+		const std::string compressedFilename = std::string(outputFilename) + COMPRESSED_FILE_EXTENSION_;
+
+		if (!this->WriteCompressedStreamsFile(mesh, compressedFilename))
+		{
+			Log::Error(LOG_MACRO, ("can't write the compressed streams file: " + compressedFilename).c_str());
+			return false;
+		}
+
+		fout << "\n\n";
+		fout << "Compressed Streams File: " << GetFilenameWithoutDirectory(compressedFilename) << "\n";
+		Log::Debug(LOG_MACRO, "COMPRESSED STREAMS WERE WRITTEN SUCCESSFULLY");
+	}
+
+	return true;
+}
+
+
+// write the number of vertices/indices/texture coords into the output data file
+void ModelWriterClass::WriteCountsIntoOutputFile(const MeshData & mesh, std::ofstream & fout)
+{
+	fout << "Vertex Count: " << mesh.vertices.size() << "\n";
+	fout << "Indices Count: " << mesh.vertexIndices.size() << "\n";         // each face has 3 vertices
+	fout << "Index Format: " << INDEX_FORMAT_NAMES_[mesh.indexFormat] << "\n";
+	fout << "Textures Count: " << mesh.texCoords.size() << "\n\n";
+
+	return;
+}
+
+
+bool ModelWriterClass::WriteVerticesIntoOutputFile(const MeshData & mesh, std::ofstream & fout)
+{
+	TRACE_SCOPE("WriteVerticesIntoOutputFile");
+	TRACE_ARG("count", mesh.vertices.size());
+
+	fout << "\nVertices Data:\n";        // write into the output file that the following data block is vertices data
+
+	this->WriteInParallel(fout, mesh.vertices.size(), [&mesh](size_t begin, size_t end, std::string & out)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			const VERTEX3D & vertex3D = mesh.vertices[i];
+
+			AppendFloat(out, vertex3D.x);
+			out += ' ';
+			AppendFloat(out, vertex3D.y);
+			out += ' ';
+			AppendFloat(out, vertex3D.z);
+			out += '\n';
+		}
+	});
+
+	fout << "\n\n";                      // in the output data file: make a separation space before the next data block 
+
+	return !fout.bad();
+}
+
+
+bool ModelWriterClass::WriteTexturesIntoOutputFile(const MeshData & mesh, std::ofstream & fout)
+{
+	TRACE_SCOPE("WriteTexturesIntoOutputFile");
+	TRACE_ARG("count", mesh.texCoords.size());
+
+	fout << "\nTextures Data:\n";        // write into the output file that the following data block is textures data
+
+	this->WriteInParallel(fout, mesh.texCoords.size(), [&mesh](size_t begin, size_t end, std::string & out)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			AppendFloat(out, mesh.texCoords[i].tu);
+			out += ' ';
+			AppendFloat(out, mesh.texCoords[i].tv);
+			out += '\n';
+		}
+	});
+
+	fout << "\n\n";                      // in the output data file: make a separation space before the next data block 
+
+	return !fout.bad();
+}
+
+
+// write vertex/texture coords indices into the output data file;
+// we write vertices of each face in the reversed order to use it in the left handed coordinate system;
+// in the INDEX_FORMAT_UINT16_BASE_VERTEX format indices are written relative to the base of their submesh
+bool ModelWriterClass::WriteIndicesIntoOutputFile(const MeshData & mesh, std::ofstream & fout)
+{
+	TRACE_SCOPE("WriteIndicesIntoOutputFile");
+	TRACE_ARG("count", mesh.vertexIndices.size());
+
+	const bool useBases = (mesh.indexFormat == INDEX_FORMAT_UINT16_BASE_VERTEX);
+	const std::vector<SUBMESH> & submeshes = mesh.submeshes;
+
+	// writes faces of the range [begin, end) (the indices of each face minus the base of its submesh)
+	auto WriteIndices = [&](const std::vector<UINT> & indices, const bool isVertexIndices)
+	{
+		this->WriteInParallel(fout, indices.size() / 3, [&](size_t begin, size_t end, std::string & out)
+		{
+			// find the submesh of the first face of the range (submeshes are sorted by their offsets)
+			auto submeshIt = std::upper_bound(submeshes.begin(), submeshes.end(), begin * 3, [](size_t index, const SUBMESH & submesh)
+			{
+				return index < submesh.indexOffset;
+			});
+
+			if (submeshIt != submeshes.begin())
+				--submeshIt;
+
+			for (size_t face = begin; face < end; face++)
+			{
+				const size_t it = face * 3;
+				UINT base = 0;
+
+				if (useBases)
+				{
+					while ((submeshIt + 1 != submeshes.end()) && (it >= (submeshIt + 1)->indexOffset))
+						++submeshIt;
+
+					base = isVertexIndices ? submeshIt->baseVertex : submeshIt->baseTexCoord;
+				}
+
+				AppendUInt(out, indices[it + 2] - base);
+				out += ' ';
+				AppendUInt(out, indices[it + 1] - base);
+				out += ' ';
+				AppendUInt(out, indices[it] - base);
+				out += '\n';
+			}
+		});
+	};
+
+	// VERTEX INDICES WRITING
+	fout << "Vertex Indices Data:" << "\n\n";
+	WriteIndices(mesh.vertexIndices, true);
+	fout << "\n";
+
+	// TEXTURE INDICES WRITING
+	fout << "Texture Indices Data:" << "\n\n";
+	WriteIndices(mesh.textureIndices, false);
+
+	return !fout.bad();
+}
+
+
+// write the submeshes table and the draw batches (one batch per material) into the output data file;
+// each line of the submeshes data is:
+//   material_name group_name index_offset index_count min_x min_y min_z max_x max_y max_z base_vertex base_texture_coord
+// each line of the batches data is:
+//   material_name index_offset index_count
+// (in the INDEX_FORMAT_UINT16_BASE_VERTEX format a batch has to be drawn submesh by submesh because of the bases)
+bool ModelWriterClass::WriteSubmeshesIntoOutputFile(const MeshData & mesh, std::ofstream & fout)
+{
+	TRACE_SCOPE("WriteSubmeshesIntoOutputFile");
+	TRACE_ARG("count", mesh.submeshes.size());
+
+	const std::vector<SUBMESH> & submeshes = mesh.submeshes;
+
+	fout << "\n\n";
+	fout << "Material Library: " << (mesh.materialLibName.empty() ? "none" : mesh.materialLibName) << "\n";
+	fout << "Submeshes Count: " << submeshes.size() << "\n";
+	fout << "Batches Count: " << mesh.materialsNames.size() << "\n\n";
+
+	// SUBMESHES WRITING
+	fout << "Submeshes Data:" << "\n\n";
+
+	fout.setf(std::ios::fixed, std::ios::floatfield);
+	fout.precision(6);
+
+	for (const SUBMESH & submesh : submeshes)
+	{
+		fout << submesh.materialName << ' '
+			 << submesh.groupName << ' '
+			 << submesh.indexOffset << ' '
+			 << submesh.indexCount << ' '
+			 << submesh.aabbMin.x << ' ' << submesh.aabbMin.y << ' ' << submesh.aabbMin.z << ' '
+			 << submesh.aabbMax.x << ' ' << submesh.aabbMax.y << ' ' << submesh.aabbMax.z << ' '
+			 << submesh.baseVertex << ' '
+			 << submesh.baseTexCoord << '\n';
+	}
+	fout << "\n\n";
+
+
+	// BATCHES WRITING (submeshes of the same material go one after another so each material is a single range)
+	fout << "Batches Data:" << "\n\n";
+
+	for (size_t first = 0; first < submeshes.size(); )
+	{
+		size_t last = first;
+		size_t indexCount = 0;
+
+		while ((last < submeshes.size()) && (submeshes[last].materialIndex == submeshes[first].materialIndex))
+		{
+			indexCount += submeshes[last].indexCount;
+			last++;
+		}
+
+		fout << submeshes[first].materialName << ' '
+			 << submeshes[first].indexOffset << ' '
+			 << indexCount << '\n';
+
+		first = last;
+	}
+
+	return !fout.bad();
+}
+
+
+// write triangles with adjacency (6 indices per triangle) into the output data file;
+// as well as the usual indices we write them in the left handed winding order:
+//   v2 adjacent(v2 v1) v1 adjacent(v1 v0) v0 adjacent(v0 v2)
+bool ModelWriterClass::WriteAdjacencyIntoOutputFile(const MeshData & mesh, std::ofstream & fout)
+{
+	TRACE_SCOPE("WriteAdjacencyIntoOutputFile");
+	TRACE_ARG("count", mesh.adjacencyIndices.size());
+
+	const std::vector<UINT> & adjacency = mesh.adjacencyIndices;
+
+	fout << "\n\n";
+	fout << "Adjacency Indices Count: " << adjacency.size() << "\n\n";
+	fout << "Adjacency Indices Data:" << "\n\n";
+
+	this->WriteInParallel(fout, adjacency.size() / 6, [&adjacency](size_t begin, size_t end, std::string & out)
+	{
+		const size_t order[6] = { 4, 3, 2, 1, 0, 5 };
+
+		for (size_t face = begin; face < end; face++)
+		{
+			for (size_t i = 0; i < 6; i++)
+			{
+				AppendUInt(out, adjacency[face * 6 + order[i]]);
+				out += (i < 5) ? ' ' : '\n';
+			}
+		}
+	});
+
+	return !fout.bad();
+}
+
+
+// write unique edges into the output data file; each line is:
+//   vertex0 vertex1 face0 face1 type
+// (face1 is -1 for boundary edges; type: 0 -- manifold, 1 -- boundary, 2 -- non-manifold)
+bool ModelWriterClass::WriteEdgesIntoOutputFile(const MeshData & mesh, std::ofstream & fout)
+{
+	TRACE_SCOPE("WriteEdgesIntoOutputFile");
+	TRACE_ARG("count", mesh.edges.size());
+
+	fout << "\n\n";
+	fout << "Edges Count: " << mesh.edges.size() << "\n\n";
+	fout << "Edges Data:" << "\n\n";
+
+	this->WriteInParallel(fout, mesh.edges.size(), [&mesh](size_t begin, size_t end, std::string & out)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			const EDGE & edge = mesh.edges[i];
+
+			AppendUInt(out, edge.vertex0);
+			out += ' ';
+			AppendUInt(out, edge.vertex1);
+			out += ' ';
+			AppendUInt(out, edge.face0);
+			out += ' ';
+
+			if (edge.face1 == UINT_MAX)
+				out += "-1";
+			else
+				AppendUInt(out, edge.face1);
+
+			out += ' ';
+			AppendUInt(out, edge.type);
+			out += '\n';
+		}
+	});
+
+	return !fout.bad();
+}
+
+
+// write the baked ambient occlusion into the output data file (a value per vertex in the order of the vertices data)
+bool ModelWriterClass::WriteAmbientOcclusionIntoOutputFile(const MeshData & mesh, std::ofstream & fout)
+{
+	TRACE_SCOPE("WriteAmbientOcclusionIntoOutputFile");
+	TRACE_ARG("count", mesh.ambientOcclusion.size());
+
+	fout << "\n\n";
+	fout << "Ambient Occlusion Data:" << "\n\n";
+
+	this->WriteInParallel(fout, mesh.ambientOcclusion.size(), [&mesh](size_t begin, size_t end, std::string & out)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			AppendFloat(out, mesh.ambientOcclusion[i]);
+			out += '\n';
+		}
+	});
+
+	return !fout.bad();
+}
+
+
+// write the vertex/index buffers into the binary file as compressed streams;
+// the indices are stored in the left handed winding order (as in the text output file);
+// the compressed streams always keep absolute 32-bit indices (the decoder produces uint32 anyway)
+bool ModelWriterClass::WriteCompressedStreamsFile(const MeshData & mesh, const std::string & filename)
+{
+	TRACE_SCOPE("WriteCompressedStreamsFile");
+	TRACE_ARG("file", filename);
+
+	std::vector<uint8_t> fileData;
+	std::vector<uint8_t> stream;
+
+	// VERTICES
+	MeshEncoderClass::EncodeVertexStream(mesh.vertices.data(), mesh.vertices.size(), sizeof(VERTEX3D), stream);
+	MeshEncoderClass::AppendStreamIntoFile(MESH_CODEC_STREAM_POSITIONS, mesh.vertices.size(), sizeof(VERTEX3D), stream, fileData);
+
+	stream.clear();
+	MeshEncoderClass::EncodeVertexStream(mesh.texCoords.data(), mesh.texCoords.size(), sizeof(TEXTURE_COORDS), stream);
+	MeshEncoderClass::AppendStreamIntoFile(MESH_CODEC_STREAM_TEXTURE_COORDS, mesh.texCoords.size(), sizeof(TEXTURE_COORDS), stream, fileData);
+
+
+	// INDICES
+	const std::vector<UINT>* indicesArrays[2] = { &mesh.vertexIndices, &mesh.textureIndices };
+	const MESH_CODEC_STREAM_TYPE indicesTypes[2] = { MESH_CODEC_STREAM_VERTEX_INDICES, MESH_CODEC_STREAM_TEXTURE_INDICES };
+	std::vector<uint32_t> indices;
+
+	for (size_t i = 0; i < 2; i++)
+	{
+		const std::vector<UINT> & srcIndices = *indicesArrays[i];
+
+		indices.resize(srcIndices.size());
+
+		for (size_t it = 0; it + 2 < srcIndices.size(); it += 3)
+		{
+			indices[it + 0] = srcIndices[it + 2];
+			indices[it + 1] = srcIndices[it + 1];
+			indices[it + 2] = srcIndices[it + 0];
+		}
+
+		stream.clear();
+		MeshEncoderClass::EncodeIndexStream(indices.data(), indices.size(), stream);
+		MeshEncoderClass::AppendStreamIntoFile(indicesTypes[i], indices.size(), sizeof(uint32_t), stream, fileData);
+	}
+
+#ifdef _DEBUG
+	// check that the positions are decoded correctly
+	MeshDecoderClass::STREAM_INFO streamInfo;
+	std::vector<VERTEX3D> decodedVertices(mesh.vertices.size());
+
+	const bool isDecoded =
+		MeshDecoderClass::FindStream(fileData.data(), fileData.size(), MESH_CODEC_STREAM_POSITIONS, streamInfo) &&
+		MeshDecoderClass::DecodeVertexStream(decodedVertices.data(), decodedVertices.size(), sizeof(VERTEX3D), streamInfo.pData, streamInfo.dataSize);
+
+	assert(isDecoded && (memcmp(decodedVertices.data(), mesh.vertices.data(), decodedVertices.size() * sizeof(VERTEX3D)) == 0));
+#endif
+
+	Log::Print("compressed streams: %u bytes (uncompressed: %u bytes)",
+		(UINT)fileData.size(),
+		(UINT)(mesh.vertices.size() * sizeof(VERTEX3D) + mesh.texCoords.size() * sizeof(TEXTURE_COORDS) +
+			(mesh.vertexIndices.size() + mesh.textureIndices.size()) * sizeof(UINT)));
+
+	std::ofstream fout(filename, std::ios::out | std::ios::binary);
+
+	if (fout.fail())
+		return false;
+
+	fout.write(reinterpret_cast<const char*>(fileData.data()), fileData.size());
+
+	return !fout.fail();
+}
+
+
+// write the vertex streams and the index buffer (the unique vertices are made of the position and
+// texture coords pairs so there is a single index buffer) into the binary file; each buffer starts
+// at the 16 bytes aligned offset; indices are 16-bit if the number of the unique vertices allows it
+// and they are in the left handed winding order (as in the text output file);
+// the description is written into the output data file:
+//   Vertex Layout: <interleaved | soa | position_stream>
+//   ...
+//   Streams Data: (a line per stream)
+//     file_offset stride attributes_count [attribute_name attribute_format attribute_offset] ...
+bool ModelWriterClass::WriteVertexBuffersFile(const MeshData & mesh, const std::string & filename, std::ofstream & fout)
+{
+	TRACE_SCOPE("WriteVertexBuffersFile");
+	TRACE_ARG("file", filename);
+
+	VertexLayoutClass vertexLayout;
+
+	if (!vertexLayout.Build(mesh, options_))
+		return false;
+
+	const std::vector<VertexLayoutClass::VERTEX_STREAM> & streams = vertexLayout.GetStreams();
+	const std::vector<UINT> & indices = vertexLayout.GetIndices();
+	const bool use16BitIndices = options_.allow16BitIndices && (vertexLayout.GetVerticesCount() <= MAX_16BIT_INDICES_RANGE_);
+	const size_t indexSize = use16BitIndices ? sizeof(uint16_t) : sizeof(uint32_t);
+
+	// calculate offsets of the buffers inside of the file
+	std::vector<size_t> streamsOffsets;
+	size_t fileSize = 0;
+
+	for (const VertexLayoutClass::VERTEX_STREAM & stream : streams)
+	{
+		streamsOffsets.push_back(fileSize);
+		fileSize = (fileSize + stream.data.size() + VERTEX_BUFFERS_ALIGNMENT_ - 1) & ~(VERTEX_BUFFERS_ALIGNMENT_ - 1);
+	}
+
+	const size_t indicesOffset = fileSize;
+	fileSize += indices.size() * indexSize;
+
+	// fill in the file's data
+	std::vector<uint8_t> fileData(fileSize, 0);
+
+	for (size_t idx = 0; idx < streams.size(); idx++)
+	{
+		if (!streams[idx].data.empty())
+			memcpy(fileData.data() + streamsOffsets[idx], streams[idx].data.data(), streams[idx].data.size());
+	}
+
+	for (size_t it = 0; it + 2 < indices.size(); it += 3)
+	{
+		const UINT faceIndices[3] = { indices[it + 2], indices[it + 1], indices[it] };
+
+		for (size_t vertex = 0; vertex < 3; vertex++)
+		{
+			uint8_t* pIndex = fileData.data() + indicesOffset + (it + vertex) * indexSize;
+
+			if (use16BitIndices)
+			{
+				const uint16_t index = (uint16_t)faceIndices[vertex];
+				memcpy(pIndex, &index, sizeof(uint16_t));
+			}
+			else
+			{
+				memcpy(pIndex, &faceIndices[vertex], sizeof(uint32_t));
+			}
+		}
+	}
+
+	std::ofstream fileOut(filename, std::ios::out | std::ios::binary);
+
+	if (fileOut.fail())
+		return false;
+
+	fileOut.write(reinterpret_cast<const char*>(fileData.data()), fileData.size());
+
+	if (fileOut.fail())
+		return false;
+
+	// describe the layout in the output data file
+	fout << "\n\n";
+	fout << "Vertex Layout: " << VertexLayoutClass::GetLayoutName(options_.vertexLayout) << "\n";
+	fout << "Vertex Buffers File: " << GetFilenameWithoutDirectory(filename) << "\n";
+	fout << "Vertex Buffers Vertex Count: " << vertexLayout.GetVerticesCount() << "\n";
+	fout << "Vertex Buffers Index Format: " << (use16BitIndices ? "uint16" : "uint32") << "\n";
+	fout << "Vertex Buffers Indices Offset: " << indicesOffset << "\n";
+	fout << "Streams Count: " << streams.size() << "\n\n";
+	fout << "Streams Data:" << "\n\n";
+
+	for (size_t idx = 0; idx < streams.size(); idx++)
+	{
+		fout << streamsOffsets[idx] << ' '
+			 << streams[idx].stride << ' '
+			 << streams[idx].attributes.size();
+
+		for (const VertexLayoutClass::VERTEX_ATTRIBUTE & attribute : streams[idx].attributes)
+		{
+			fout << ' ' << VertexLayoutClass::GetAttributeName(attribute.type)
+				 << ' ' << VertexLayoutClass::GetAttributeFormat(attribute.type)
+				 << ' ' << attribute.offset;
+		}
+		fout << '\n';
+	}
+
+	return !fout.bad();
+}
+
+
+// the tiles data file has a mesh chunk of each tile;
+// the tiles index file describes the tiles (one line per tile):
+//   level x y z  min_x min_y min_z  max_x max_y max_z  data_offset vertex_count index_count index_format
+//   submeshes_count [material_index index_offset index_count]...
+bool ModelWriterClass::WriteTilesFiles(const MeshData & mesh, const std::string & indexFilename, const std::string & dataFilename)
+{
+	TRACE_SCOPE("WriteTilesFiles");
+	TRACE_ARG("file", dataFilename);
+
+	MeshTilingClass tiling;
+	std::vector<MESH_TILE> tiles;
+
+	if (!tiling.Run(mesh, options_, tiles))
+		return false;
+
+	// calculate offsets of the tiles inside of the data file
+	std::vector<size_t> tilesOffsets;
+	size_t fileSize = 0;
+
+	for (const MESH_TILE & tile : tiles)
+	{
+		tilesOffsets.push_back(fileSize);
+		fileSize += this->GetMeshChunkSize(tile.vertices.size(), tile.indices.size());
+	}
+
+	// fill in the data of the tiles in parallel (each tile has its own range of the file)
+	std::vector<uint8_t> fileData(fileSize, 0);
+
+	ParallelFor(tiles.size(), 1, [&](size_t begin, size_t end, size_t)
+	{
+		for (size_t idx = begin; idx < end; idx++)
+			this->FillMeshChunk(fileData.data() + tilesOffsets[idx], tiles[idx].vertices, tiles[idx].texCoords, tiles[idx].indices);
+	});
+
+	std::ofstream dataOut(dataFilename, std::ios::out | std::ios::binary);
+
+	if (dataOut.fail())
+		return false;
+
+	dataOut.write(reinterpret_cast<const char*>(fileData.data()), fileData.size());
+
+	if (dataOut.fail())
+		return false;
+
+	// describe the tiles in the index file
+	std::ofstream indexOut(indexFilename, std::ios::out);
+
+	if (indexOut.fail())
+		return false;
+
+	indexOut << "Tiling Mode: " << TILING_MODE_NAMES_[options_.tilingMode] << "\n";
+
+	if (options_.tilingMode == TILING_MODE_GRID)
+	{
+		indexOut << "Tiling Grid Cells: "
+			<< options_.tileGridCells[0] << ' '
+			<< options_.tileGridCells[1] << ' '
+			<< options_.tileGridCells[2] << "\n";
+	}
+	else
+	{
+		indexOut << "Tiling Max Triangles: " << options_.tileMaxTriangles << "\n";
+		indexOut << "Tiling Max Depth: " << options_.tileMaxDepth << "\n";
+	}
+
+	indexOut << "Tiles Data File: " << GetFilenameWithoutDirectory(dataFilename) << "\n";
+	indexOut << "Tiles Count: " << tiles.size() << "\n\n";
+	indexOut << "Tiles Data:" << "\n\n";
+
+	for (size_t idx = 0; idx < tiles.size(); idx++)
+	{
+		const MESH_TILE & tile = tiles[idx];
+		std::string line;
+
+		AppendUInt(line, tile.level);
+		for (size_t axis = 0; axis < 3; axis++)
+		{
+			line += ' ';
+			AppendUInt(line, tile.coords[axis]);
+		}
+
+		for (const VERTEX3D & bound : { tile.aabbMin, tile.aabbMax })
+		{
+			line += ' ';  AppendFloat(line, bound.x);
+			line += ' ';  AppendFloat(line, bound.y);
+			line += ' ';  AppendFloat(line, bound.z);
+		}
+
+		line += ' ';  AppendUInt(line, tilesOffsets[idx]);
+		line += ' ';  AppendUInt(line, tile.vertices.size());
+		line += ' ';  AppendUInt(line, tile.indices.size());
+		line += ' ';  line += (tile.vertices.size() <= MAX_16BIT_INDICES_RANGE_) ? "uint16" : "uint32";
+		line += ' ';  AppendUInt(line, tile.submeshes.size());
+
+		for (const TILE_SUBMESH & submesh : tile.submeshes)
+		{
+			line += ' ';  AppendUInt(line, submesh.materialIndex);
+			line += ' ';  AppendUInt(line, submesh.indexOffset);
+			line += ' ';  AppendUInt(line, submesh.indexCount);
+		}
+
+		line += '\n';
+		indexOut << line;
+	}
+
+	return !indexOut.fail();
+}
+
+
+// the instances data file has a mesh chunk of each prototype (in its canonical frame);
+// the instances index file describes the prototypes (one line per prototype):
+//   data_offset vertex_count index_count index_format instances_count
+//   submeshes_count [material_index index_offset index_count]...
+// and the instances (one line per group/object of the mesh which has faces):
+//   prototype_index group_name  r00 r01 r02 tx  r10 r11 r12 ty  r20 r21 r22 tz
+bool ModelWriterClass::WriteInstancesFiles(const MeshData & mesh, const std::string & indexFilename, const std::string & dataFilename)
+{
+	TRACE_SCOPE("WriteInstancesFiles");
+	TRACE_ARG("file", dataFilename);
+
+	MeshInstancingClass instancing;
+	std::vector<INSTANCE_PROTOTYPE> prototypes;
+	std::vector<MESH_INSTANCE> instances;
+
+	if (!instancing.Run(mesh, options_, prototypes, instances))
+		return false;
+
+	// calculate offsets of the prototypes inside of the data file
+	std::vector<size_t> prototypesOffsets;
+	size_t fileSize = 0;
+
+	for (const INSTANCE_PROTOTYPE & prototype : prototypes)
+	{
+		prototypesOffsets.push_back(fileSize);
+		fileSize += this->GetMeshChunkSize(prototype.vertices.size(), prototype.indices.size());
+	}
+
+	std::vector<uint8_t> fileData(fileSize, 0);
+
+	ParallelFor(prototypes.size(), 1, [&](size_t begin, size_t end, size_t)
+	{
+		for (size_t idx = begin; idx < end; idx++)
+			this->FillMeshChunk(fileData.data() + prototypesOffsets[idx], prototypes[idx].vertices, prototypes[idx].texCoords, prototypes[idx].indices);
+	});
+
+	std::ofstream dataOut(dataFilename, std::ios::out | std::ios::binary);
+
+	if (dataOut.fail())
+		return false;
+
+	dataOut.write(reinterpret_cast<const char*>(fileData.data()), fileData.size());
+
+	if (dataOut.fail())
+		return false;
+
+	// describe the prototypes and the instances in the index file
+	std::ofstream indexOut(indexFilename, std::ios::out);
+
+	if (indexOut.fail())
+		return false;
+
+	const size_t flattenedSize = instancing.GetFlattenedSize();
+	const size_t instancedSize = instancing.GetInstancedSize();
+
+	indexOut << "Instances Data File: " << GetFilenameWithoutDirectory(dataFilename) << "\n";
+	indexOut << "Instancing Tolerance: " << options_.instanceTolerance << "\n";
+	indexOut << "Flattened Size: " << flattenedSize << "\n";
+	indexOut << "Instanced Size: " << instancedSize << "\n";
+	indexOut << "Memory Saved: " << ((flattenedSize > instancedSize) ? flattenedSize - instancedSize : 0) << "\n";
+	indexOut << "Prototypes Count: " << prototypes.size() << "\n";
+	indexOut << "Instances Count: " << instances.size() << "\n\n";
+	indexOut << "Prototypes Data:" << "\n\n";
+
+	for (size_t idx = 0; idx < prototypes.size(); idx++)
+	{
+		const INSTANCE_PROTOTYPE & prototype = prototypes[idx];
+		std::string line;
+
+		AppendUInt(line, prototypesOffsets[idx]);
+		line += ' ';  AppendUInt(line, prototype.vertices.size());
+		line += ' ';  AppendUInt(line, prototype.indices.size());
+		line += ' ';  line += (prototype.vertices.size() <= MAX_16BIT_INDICES_RANGE_) ? "uint16" : "uint32";
+		line += ' ';  AppendUInt(line, prototype.instancesCount);
+		line += ' ';  AppendUInt(line, prototype.submeshes.size());
+
+		for (const PROTOTYPE_SUBMESH & submesh : prototype.submeshes)
+		{
+			line += ' ';  AppendUInt(line, submesh.materialIndex);
+			line += ' ';  AppendUInt(line, submesh.indexOffset);
+			line += ' ';  AppendUInt(line, submesh.indexCount);
+		}
+
+		line += '\n';
+		indexOut << line;
+	}
+
+	indexOut << "\nInstances Data:" << "\n\n";
+
+	for (const MESH_INSTANCE & instance : instances)
+	{
+		std::string line;
+
+		AppendUInt(line, instance.prototypeIndex);
+		line += ' ';
+		line += instance.groupName;
+
+		for (size_t row = 0; row < 3; row++)
+		{
+			for (size_t col = 0; col < 4; col++)
+			{
+				line += ' ';
+				AppendFloat(line, instance.transform[row][col]);
+			}
+		}
+
+		line += '\n';
+		indexOut << line;
+	}
+
+	return !indexOut.fail();
+}
+
+
+size_t ModelWriterClass::GetMeshChunkSize(const size_t verticesCount, const size_t indicesCount) const
+{
+	const size_t indexSize = (verticesCount <= MAX_16BIT_INDICES_RANGE_) ? sizeof(uint16_t) : sizeof(uint32_t);
+	auto Align = [this](const size_t size) { return (size + VERTEX_BUFFERS_ALIGNMENT_ - 1) & ~(VERTEX_BUFFERS_ALIGNMENT_ - 1); };
+
+	return Align(verticesCount * sizeof(VERTEX3D)) +
+		Align(verticesCount * sizeof(TEXTURE_COORDS)) +
+		Align(indicesCount * indexSize);
+}
+
+
+void ModelWriterClass::FillMeshChunk(uint8_t* pChunk,
+	const std::vector<VERTEX3D> & vertices,
+	const std::vector<TEXTURE_COORDS> & texCoords,
+	const std::vector<UINT> & indices) const
+{
+	const bool use16BitIndices = (vertices.size() <= MAX_16BIT_INDICES_RANGE_);
+	auto Align = [this](const size_t size) { return (size + VERTEX_BUFFERS_ALIGNMENT_ - 1) & ~(VERTEX_BUFFERS_ALIGNMENT_ - 1); };
+
+	uint8_t* ptr = pChunk;
+
+	// the empty arrays have no data to copy (their data() can be nullptr)
+	if (!vertices.empty())
+		memcpy(ptr, vertices.data(), vertices.size() * sizeof(VERTEX3D));
+
+	ptr += Align(vertices.size() * sizeof(VERTEX3D));
+
+	if (!texCoords.empty())
+		memcpy(ptr, texCoords.data(), texCoords.size() * sizeof(TEXTURE_COORDS));
+
+	ptr += Align(texCoords.size() * sizeof(TEXTURE_COORDS));
+
+	// reverse the winding order of each face (as for the output file)
+	for (size_t it = 0; it + 2 < indices.size(); it += 3)
+	{
+		const UINT faceIndices[3] = { indices[it + 2], indices[it + 1], indices[it] };
+
+		for (size_t vertex = 0; vertex < 3; vertex++)
+		{
+			if (use16BitIndices)
+			{
+				const uint16_t index = (uint16_t)faceIndices[vertex];
+				memcpy(ptr + (it + vertex) * sizeof(uint16_t), &index, sizeof(uint16_t));
+			}
+			else
+			{
+				memcpy(ptr + (it + vertex) * sizeof(uint32_t), &faceIndices[vertex], sizeof(uint32_t));
+			}
+		}
+	}
+
+	return;
+}
+
+
+// returns a name of the file which is placed next to the output file (without the directory)
+std::string ModelWriterClass::GetFilenameWithoutDirectory(const std::string & filename)
+{
+	const size_t nameOffset = filename.find_last_of("/\\");
+	return filename.substr((nameOffset == std::string::npos) ? 0 : nameOffset + 1);
+}
+
+
+// format elements of the range [0, count) on several threads and write the text into the file
+// in the order of the elements; formatRange(begin, end, out) appends the text of the elements
+// [begin, end) into the out string; the elements are handled by blocks so the memory for
+// the text doesn't depend on the size of the mesh;
+// the exact offset of each formatted range in the file is a prefix sum of the sizes of the
+// previous ranges so the file is extended to the end of the block and each thread writes its
+// range right at its offset; the stream is moved to the end of the section afterwards (if the
+// file can't be written at offsets the ranges are written through the stream one by one)
+template<typename Func>
+bool ModelWriterClass::WriteInParallel(std::ofstream & fout, const size_t count, Func formatRange)
+{
+	std::vector<std::string> chunks(GetWorkerThreadsCount());
+	std::vector<size_t> chunksOffsets(chunks.size() + 1);
+
+	// everything before the section has to be in the file before the section is written at its offset
+	const std::streamoff sectionOffset = (outputFile_.IsOpen() && fout.flush()) ? (std::streamoff)fout.tellp() : -1;
+	const bool isPositional = (sectionOffset >= 0);
+	size_t fileOffset = isPositional ? (size_t)sectionOffset : 0;
+
+	for (size_t blockBegin = 0; blockBegin < count; blockBegin += ELEMENTS_PER_BLOCK_)
+	{
+		const size_t blockSize = (std::min)(ELEMENTS_PER_BLOCK_, count - blockBegin);
+		size_t usedChunksCount = 0;
+
+		for (std::string & chunk : chunks)
+			chunk.clear();
+
+		// each thread formats a contiguous part of the block; the parts go in the order of the threads
+		ParallelFor(blockSize, MIN_ELEMENTS_PER_THREAD_, [&](size_t begin, size_t end, size_t threadIdx)
+		{
+			TRACE_SCOPE("FormatRange");
+			TRACE_ARG("begin", blockBegin + begin);
+			TRACE_ARG("end", blockBegin + end);
+
+			formatRange(blockBegin + begin, blockBegin + end, chunks[threadIdx]);
+		});
+
+		// the parts of the block start at these offsets in the file
+		chunksOffsets[0] = fileOffset;
+
+		for (size_t idx = 0; idx < chunks.size(); idx++)
+		{
+			chunksOffsets[idx + 1] = chunksOffsets[idx] + chunks[idx].size();
+			usedChunksCount = chunks[idx].empty() ? usedChunksCount : idx + 1;
+		}
+
+		TRACE_SCOPE("WriteBlock");
+		TRACE_ARG("bytes", chunksOffsets.back() - fileOffset);
+
+		if (!isPositional)
+		{
+			for (const std::string & chunk : chunks)
+				fout.write(chunk.data(), chunk.size());
+
+			continue;
+		}
+
+		if (!outputFile_.SetSize(chunksOffsets.back()))
+		{
+			fout.setstate(std::ios::badbit);
+			return false;
+		}
+
+		std::atomic<bool> isFailed{ false };
+
+		ParallelFor(usedChunksCount, 1, [&](size_t begin, size_t end, size_t)
+		{
+			TRACE_SCOPE("WriteRange");
+
+			for (size_t idx = begin; idx < end; idx++)
+			{
+				if (!outputFile_.WriteAt(chunks[idx].data(), chunks[idx].size(), chunksOffsets[idx]))
+					isFailed = true;
+			}
+		});
+
+		if (isFailed)
+		{
+			fout.setstate(std::ios::badbit);
+			return false;
+		}
+
+		fileOffset = chunksOffsets.back();
+	}
+
+	// the following text goes right after the section
+	if (isPositional)
+		fout.seekp((std::streamoff)fileOffset);
+
+	return !fout.fail();
+}
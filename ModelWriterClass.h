@@ -0,0 +1,91 @@
+/////////////////////////////////////////////////////////////////////
+// Filename:     ModelWriterClass.h
+// Description:  writes the model's data (which was read in by some
+//               input format converter) into the internal model format
+//
+// Created:      19.10.26
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////////////////////////
+// INCLUDES
+//////////////////////////////////
+#include "MeshData.h"
+#include "ConversionOptions.h"
+#include "Log.h"       // for using the log system
+#include "Platform.h"
+
+#include <fstream>
+#include <string>
+
+
+//////////////////////////////////
+// Class name: ModelWriterClass
+//////////////////////////////////
+class ModelWriterClass
+{
+public:
+	ModelWriterClass(const ConversionOptions & options);
+
+	// write all the mesh data into the output data file (and into the additional
+	// files which are placed next to the output file if the options require them)
+	bool WriteIntoOutputFile(const MeshData & mesh, std::ofstream & fout, const char* outputFilename);
+
+private:
+	void WriteCountsIntoOutputFile(const MeshData & mesh, std::ofstream & fout);
+	bool WriteVerticesIntoOutputFile(const MeshData & mesh, std::ofstream & fout);
+	bool WriteTexturesIntoOutputFile(const MeshData & mesh, std::ofstream & fout);
+	bool WriteIndicesIntoOutputFile(const MeshData & mesh, std::ofstream & fout);
+	bool WriteSubmeshesIntoOutputFile(const MeshData & mesh, std::ofstream & fout);
+	bool WriteAdjacencyIntoOutputFile(const MeshData & mesh, std::ofstream & fout);
+	bool WriteEdgesIntoOutputFile(const MeshData & mesh, std::ofstream & fout);
+	bool WriteAmbientOcclusionIntoOutputFile(const MeshData & mesh, std::ofstream & fout);
+
+	// write the vertex/index buffers into the binary file as compressed streams
+	bool WriteCompressedStreamsFile(const MeshData & mesh, const std::string & filename);
+
+	// write the vertex streams (with the layout from the options) and the index buffer into
+	// the binary file and describe the layout in the output data file
+	bool WriteVertexBuffersFile(const MeshData & mesh, const std::string & filename, std::ofstream & fout);
+
+	// partition the mesh into spatial tiles and write their buffers into the binary data
+	// file and their bounds/offsets into the text index file
+	bool WriteTilesFiles(const MeshData & mesh, const std::string & indexFilename, const std::string & dataFilename);
+
+	// write each unique group/object once into the binary data file and describe
+	// the prototypes and the transforms of their instances in the text index file
+	bool WriteInstancesFiles(const MeshData & mesh, const std::string & indexFilename, const std::string & dataFilename);
+
+	// a chunk of the tiles/instances data file: positions (float3), texture coords (float2), indices
+	// (uint16 if there are no more than 65536 vertices, otherwise uint32; in the left handed winding order)
+	size_t GetMeshChunkSize(const size_t verticesCount, const size_t indicesCount) const;
+	void FillMeshChunk(uint8_t* pChunk,
+		const std::vector<VERTEX3D> & vertices,
+		const std::vector<TEXTURE_COORDS> & texCoords,
+		const std::vector<UINT> & indices) const;
+
+	// returns a name of the file which is placed next to the output file (without the directory)
+	static std::string GetFilenameWithoutDirectory(const std::string & filename);
+
+	// format elements of the range [0, count) on several threads and write them at their offsets in the file
+	template<typename Func>
+	bool WriteInParallel(std::ofstream & fout, const size_t count, Func formatRange);
+
+private:
+	ConversionOptions options_;
+	Platform::PositionalFileClass outputFile_;                      // the output data file (for the positional writes)
+
+	// constants
+	const char* COMPRESSED_FILE_EXTENSION_ = ".mcmp";
+	const char* VERTEX_BUFFERS_FILE_EXTENSION_ = ".vbuf";
+	const char* TILES_INDEX_FILE_EXTENSION_ = ".tiles";
+	const char* TILES_DATA_FILE_EXTENSION_ = ".tiledata";
+	const char* INSTANCES_INDEX_FILE_EXTENSION_ = ".instances";
+	const char* INSTANCES_DATA_FILE_EXTENSION_ = ".instdata";
+	const size_t VERTEX_BUFFERS_ALIGNMENT_ = 16;                   // each buffer in the vertex buffers (tiles, instances) file starts at such aligned offset
+	static constexpr size_t MAX_16BIT_INDICES_RANGE_ = 0x10000;     // 16-bit indices address up to 65536 elements
+	static constexpr size_t ELEMENTS_PER_BLOCK_ = 1 << 20;          // how many lines are formatted before they are written into the file
+	static constexpr size_t MIN_ELEMENTS_PER_THREAD_ = 1 << 14;     // smaller sections are formatted on a single thread
+	const char* TILING_MODE_NAMES_[3] = { "none", "grid", "octree" };                     // by TILING_MODE
+	const char* INDEX_FORMAT_NAMES_[3] = { "uint32", "uint16", "uint16_base_vertex" };   // by INDEX_FORMAT
+};
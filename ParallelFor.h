@@ -0,0 +1,135 @@
+/////////////////////////////////////////////////////////////////////
+// Filename:     ParallelFor.h
+// Description:  a helper for splitting of some work over a range
+//               of elements between several threads
+//
+// Created:      19.10.26
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "ThreadPoolClass.h"
+
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+
+// returns the number of threads which we can use for the work
+inline size_t GetWorkerThreadsCount()
+{
+	const size_t hardwareThreadsCount = (size_t)std::thread::hardware_concurrency();
+	return (hardwareThreadsCount > 0) ? hardwareThreadsCount : 1;
+}
+
+
+// split the range [0, count) into contiguous chunks and execute func(begin, end, threadIdx)
+// over each chunk on its own thread; if there are less than minCountPerThread elements
+// for each thread the work is executed on the calling thread only; if there is a shared
+// thread pool the chunks are executed by its workers (threadIdx is the index of the chunk)
+template<typename Func>
+inline void ParallelFor(const size_t count, const size_t minCountPerThread, Func func)
+{
+	const size_t maxThreadsCount = (minCountPerThread > 0) ? count / minCountPerThread : count;
+	const size_t threadsCount = (std::min)(GetWorkerThreadsCount(), maxThreadsCount);
+
+	if (threadsCount <= 1)
+	{
+		func((size_t)0, count, (size_t)0);
+		return;
+	}
+
+	const size_t chunkSize = (count + threadsCount - 1) / threadsCount;
+	const std::shared_ptr<ThreadPoolClass> pool = ThreadPoolClass::GetSharedPool();
+
+	if (pool)
+	{
+		pool->Run(threadsCount, [&func, count, chunkSize](size_t chunkIdx)
+		{
+			const size_t begin = chunkIdx * chunkSize;
+			const size_t end = (std::min)(count, begin + chunkSize);
+
+			if (begin < end)
+				func(begin, end, chunkIdx);
+		});
+
+		return;
+	}
+
+	std::vector<std::thread> threads;
+
+	threads.reserve(threadsCount - 1);
+
+	// the first chunk is executed on the calling thread
+	for (size_t threadIdx = 1; threadIdx < threadsCount; threadIdx++)
+	{
+		const size_t begin = threadIdx * chunkSize;
+		const size_t end = (std::min)(count, begin + chunkSize);
+
+		if (begin < end)
+			threads.emplace_back(func, begin, end, threadIdx);
+	}
+
+	func((size_t)0, (std::min)(count, chunkSize), (size_t)0);
+
+	for (std::thread & thread : threads)
+		thread.join();
+}
+
+
+// sort the data: chunks of the data are sorted on separate threads
+// and then sorted chunks are merged by pairs (also in parallel)
+template<typename T>
+inline void ParallelSort(std::vector<T> & data, const size_t minCountPerThread)
+{
+	const size_t count = data.size();
+	const size_t maxThreadsCount = (minCountPerThread > 0) ? count / minCountPerThread : count;
+	const size_t threadsCount = (std::min)(GetWorkerThreadsCount(), maxThreadsCount);
+
+	if (threadsCount <= 1)
+	{
+		std::sort(data.begin(), data.end());
+		return;
+	}
+
+	// boundaries of the sorted chunks
+	const size_t chunkSize = (count + threadsCount - 1) / threadsCount;
+	std::vector<size_t> bounds;
+
+	for (size_t begin = 0; begin < count; begin += chunkSize)
+		bounds.push_back(begin);
+	bounds.push_back(count);
+
+	ParallelFor(bounds.size() - 1, 1, [&data, &bounds](size_t beginChunk, size_t endChunk, size_t)
+	{
+		for (size_t chunk = beginChunk; chunk < endChunk; chunk++)
+			std::sort(data.begin() + bounds[chunk], data.begin() + bounds[chunk + 1]);
+	});
+
+	// merge neighbouring chunks until there is only one chunk
+	while (bounds.size() > 2)
+	{
+		const size_t pairsCount = (bounds.size() - 1) / 2;
+
+		ParallelFor(pairsCount, 1, [&data, &bounds](size_t beginPair, size_t endPair, size_t)
+		{
+			for (size_t pair = beginPair; pair < endPair; pair++)
+			{
+				std::inplace_merge(
+					data.begin() + bounds[pair * 2],
+					data.begin() + bounds[pair * 2 + 1],
+					data.begin() + bounds[pair * 2 + 2]);
+			}
+		});
+
+		// remove the boundaries between merged chunks
+		std::vector<size_t> mergedBounds;
+
+		for (size_t i = 0; i < bounds.size(); i += 2)
+			mergedBounds.push_back(bounds[i]);
+
+		if (mergedBounds.back() != count)
+			mergedBounds.push_back(count);
+
+		bounds = std::move(mergedBounds);
+	}
+}
@@ -0,0 +1,261 @@
+#include "Platform.h"
+
+#include <ctime>
+#include <fstream>
+#include <algorithm>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstdint>
+#elif !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+
+#ifdef __linux__
+static constexpr size_t READ_BLOCK_SIZE = 16 << 20;        // the input files are read by such blocks
+static constexpr size_t HUGE_PAGE_SIZE = 2 << 20;          // buffers of this size and bigger are backed by the huge pages (if it is possible)
+
+
+// reserve the memory for the file; a new big buffer is asked to be backed by the huge
+// pages before it is touched so filling it in causes much less page faults
+static void ReserveBuffer(std::vector<char> & buffer, const size_t size)
+{
+	if (buffer.capacity() >= size)
+		return;
+
+	std::vector<char>().swap(buffer);
+	buffer.reserve(size);
+
+	const uintptr_t begin = ((uintptr_t)buffer.data() + HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1);
+	const uintptr_t end = ((uintptr_t)buffer.data() + size) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1);
+
+#ifdef MADV_HUGEPAGE
+	if (begin < end)
+		madvise((void*)begin, end - begin, MADV_HUGEPAGE);
+#endif
+}
+#endif
+
+
+
+// ----------------------------------------------------------------------------------- //
+//
+//                          PUBLIC FUNCTIONS
+//
+// ----------------------------------------------------------------------------------- //
+
+void Platform::SetConsoleColor(const CONSOLE_COLOR color)
+{
+#ifdef _WIN32
+	const WORD attributes[3] = { 0x0007, 0x000A, 0x0004 };   // by CONSOLE_COLOR
+	SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), attributes[color]);
+#else
+	// the escape sequences would be garbage in a redirected output
+	static const bool isTerminal = (isatty(STDOUT_FILENO) != 0);
+	const char* sequences[3] = { "\033[0m", "\033[32m", "\033[31m" };   // by CONSOLE_COLOR
+
+	if (isTerminal)
+		fputs(sequences[color], stdout);
+#endif
+}
+
+
+void Platform::GetTimeString(char* buffer, const size_t bufferSize)
+{
+#ifdef _WIN32
+	_strtime_s(buffer, bufferSize);
+#else
+	const time_t now = time(nullptr);
+	tm localTime;
+
+	localtime_r(&now, &localTime);
+	strftime(buffer, bufferSize, "%H:%M:%S", &localTime);
+#endif
+}
+
+void Platform::GetDateString(char* buffer, const size_t bufferSize)
+{
+#ifdef _WIN32
+	_strdate_s(buffer, bufferSize);
+#else
+	const time_t now = time(nullptr);
+	tm localTime;
+
+	localtime_r(&now, &localTime);
+	strftime(buffer, bufferSize, "%m/%d/%y", &localTime);
+#endif
+}
+
+
+FILE* Platform::OpenFile(const char* filename, const char* mode)
+{
+#ifdef _WIN32
+	FILE* pFile = nullptr;
+	return (fopen_s(&pFile, filename, mode) == 0) ? pFile : nullptr;
+#else
+	return fopen(filename, mode);
+#endif
+}
+
+
+// read the whole file into the buffer
+bool Platform::ReadWholeFile(const char* filename, std::vector<char> & buffer)
+{
+#ifdef __linux__
+	const int fd = open(filename, O_RDONLY | O_CLOEXEC);
+
+	if (fd < 0)
+		return false;
+
+	struct stat fileStat;
+
+	if ((fstat(fd, &fileStat) != 0) || !S_ISREG(fileStat.st_mode))
+	{
+		close(fd);
+		return false;
+	}
+
+	const size_t fileSize = (size_t)fileStat.st_size;
+
+	// the file is read once from the beginning to the end (the kernel reads ahead more aggressively)
+	posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+	// a spare byte for the terminating null which the text parsers add
+	ReserveBuffer(buffer, fileSize + 1);
+	buffer.resize(fileSize);
+
+	size_t offset = 0;
+
+	while (offset < fileSize)
+	{
+		const ssize_t bytesCount = read(fd, buffer.data() + offset, (std::min)(fileSize - offset, READ_BLOCK_SIZE));
+
+		if ((bytesCount < 0) && (errno == EINTR))
+			continue;
+
+		if (bytesCount <= 0)
+			break;
+
+		offset += (size_t)bytesCount;
+	}
+
+	close(fd);
+
+	return (offset == fileSize);
+#else
+	// read the whole file with a single read operation
+	std::ifstream fin(filename, std::ios::in | std::ios::binary | std::ios::ate);
+
+	if (fin.fail())
+		return false;
+
+	const std::streamoff fileSize = fin.tellg();
+	fin.seekg(0, std::ios::beg);
+
+	buffer.reserve((size_t)fileSize + 1);
+	buffer.resize((size_t)fileSize);
+
+	if (fileSize > 0)
+		fin.read(buffer.data(), fileSize);
+
+	return !fin.fail();
+#endif
+}
+
+
+void Platform::AdviseSequentialRead(const char* filename)
+{
+#ifdef __linux__
+	const int fd = open(filename, O_RDONLY | O_CLOEXEC);
+
+	if (fd < 0)
+		return;
+
+	// the page cache is shared so the read ahead is used by the streams which open the file later
+	posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+	close(fd);
+#else
+	(void)filename;
+#endif
+}
+
+
+///////////////////////////////////////////////////////////
+
+Platform::PositionalFileClass::~PositionalFileClass()
+{
+	Close();
+}
+
+
+bool Platform::PositionalFileClass::Open(const char* filename)
+{
+	Close();
+
+#ifdef _WIN32
+	(void)filename;
+	return false;
+#else
+	fd_ = open(filename, O_WRONLY | O_CLOEXEC);
+	return (fd_ >= 0);
+#endif
+}
+
+
+void Platform::PositionalFileClass::Close()
+{
+#ifndef _WIN32
+	if (fd_ >= 0)
+		close(fd_);
+#endif
+
+	fd_ = -1;
+}
+
+
+bool Platform::PositionalFileClass::SetSize(const size_t size)
+{
+#ifdef _WIN32
+	(void)size;
+	return false;
+#else
+	return (fd_ >= 0) && (ftruncate(fd_, (off_t)size) == 0);
+#endif
+}
+
+
+bool Platform::PositionalFileClass::WriteAt(const void* pData, const size_t size, const size_t offset)
+{
+#ifdef _WIN32
+	(void)pData;
+	(void)size;
+	(void)offset;
+	return false;
+#else
+	const char* pBytes = static_cast<const char*>(pData);
+	size_t writtenSize = 0;
+
+	// pwrite() may write only a part of the data (or be interrupted by a signal)
+	while (writtenSize < size)
+	{
+		const ssize_t bytesCount = pwrite(fd_, pBytes + writtenSize, size - writtenSize, (off_t)(offset + writtenSize));
+
+		if ((bytesCount < 0) && (errno == EINTR))
+			continue;
+
+		if (bytesCount <= 0)
+			return false;
+
+		writtenSize += (size_t)bytesCount;
+	}
+
+	return true;
+#endif
+}
@@ -0,0 +1,97 @@
+/////////////////////////////////////////////////////////////////////
+// Filename:     Platform.h
+// Description:  a thin layer over the things which differ between
+//               Windows and Linux (the basic types, the export of the
+//               library's functions, the console colours, the time
+//               strings and the reading of the input files) so the
+//               same converter builds as a Windows DLL and as a Linux
+//               shared library; the rest of the code doesn't include
+//               any platform headers
+//
+// Created:      19.10.26
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+#ifdef _WIN32
+	#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+#else
+	typedef unsigned int UINT;
+#endif
+
+#include <cstdio>
+#include <cstddef>
+#include <vector>
+
+
+// the library's functions are exported from the DLL (or are visible in the shared library
+// which is built with the hidden visibility by default)
+#ifdef _WIN32
+	#define MODEL_CONVERTER_EXPORT __declspec(dllexport)
+	#define MODEL_CONVERTER_IMPORT __declspec(dllimport)
+#else
+	#define MODEL_CONVERTER_EXPORT __attribute__((visibility("default")))
+	#define MODEL_CONVERTER_IMPORT
+#endif
+
+
+namespace Platform
+{
+	enum CONSOLE_COLOR
+	{
+		CONSOLE_COLOR_DEFAULT,
+		CONSOLE_COLOR_GREEN,
+		CONSOLE_COLOR_RED,
+	};
+
+	// change the colour of the following text in the console (nothing happens if the output isn't a console)
+	void SetConsoleColor(const CONSOLE_COLOR color);
+
+	// the current local time as "hh:mm:ss" and date as "mm/dd/yy" (the buffers must have at least 9 chars)
+	void GetTimeString(char* buffer, const size_t bufferSize);
+	void GetDateString(char* buffer, const size_t bufferSize);
+
+	// returns nullptr if the file can't be opened
+	FILE* OpenFile(const char* filename, const char* mode);
+
+	// read the whole file into the buffer; on Linux the kernel is told that the file is read
+	// sequentially and the file is read by large blocks (instead of the buffered stream reads);
+	// the buffer has a spare byte of capacity so a terminating null can be added without a reallocation
+	bool ReadWholeFile(const char* filename, std::vector<char> & buffer);
+
+	// tell the kernel that the file will be read soon from the beginning to the end (it starts
+	// the read ahead of the file into the page cache); it does nothing on other platforms
+	void AdviseSequentialRead(const char* filename);
+
+
+	// a file which is written at explicit offsets so several threads can write their parts
+	// of it at once; it is available on POSIX systems only (on Windows Open() returns false
+	// because the output files are text streams there and their newlines are translated)
+	class PositionalFileClass
+	{
+	public:
+		PositionalFileClass() {}
+		PositionalFileClass(const PositionalFileClass&) = delete;
+		PositionalFileClass & operator=(const PositionalFileClass&) = delete;
+		~PositionalFileClass();
+
+		// open an existing file for writing (it isn't truncated)
+		bool Open(const char* filename);
+		void Close();
+		bool IsOpen() const { return fd_ >= 0; }
+
+		// set the size of the file (the new space is filled with zeros)
+		bool SetSize(const size_t size);
+
+		// write the whole data at the offset; it can be called from several threads at once
+		bool WriteAt(const void* pData, const size_t size, const size_t offset);
+
+	private:
+		int fd_ = -1;
+	};
+}
@@ -0,0 +1,132 @@
+#include "ThreadPoolClass.h"
+
+#include <algorithm>
+
+
+// the pool which is used by ParallelFor() (is set by the owner of the pool)
+static std::mutex sharedPoolMutex;
+static std::shared_ptr<ThreadPoolClass> sharedPool;
+
+
+ThreadPoolClass::ThreadPoolClass(const size_t threadsCount)
+{
+	threads_.reserve(threadsCount);
+
+	for (size_t i = 0; i < threadsCount; i++)
+		threads_.emplace_back(&ThreadPoolClass::WorkerThreadFunc, this);
+}
+
+ThreadPoolClass::~ThreadPoolClass(void)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		isStopping_ = true;
+	}
+
+	jobsCondition_.notify_all();
+
+	for (std::thread & thread : threads_)
+		thread.join();
+}
+
+
+
+// ----------------------------------------------------------------------------------- //
+//
+//                          PUBLIC METHODS
+//
+// ----------------------------------------------------------------------------------- //
+
+// execute func(taskIdx) for each task of the range [0, tasksCount) and wait until all of them are done;
+// the calling thread takes the tasks as well as the workers so the call never waits for a free worker
+void ThreadPoolClass::Run(const size_t tasksCount, const std::function<void(size_t)> & func)
+{
+	if (tasksCount == 0)
+		return;
+
+	JOB job;
+	job.pFunc = &func;
+	job.tasksCount = tasksCount;
+
+	std::unique_lock<std::mutex> lock(mutex_);
+
+	if (tasksCount > 1)
+	{
+		jobs_.push_back(&job);
+		jobsCondition_.notify_all();
+	}
+
+	while (this->ExecuteNextTask(lock, job))
+	{
+	}
+
+	// the tasks which are taken by the workers can still be executed
+	doneCondition_.wait(lock, [&job]() { return job.doneTasksCount == job.tasksCount; });
+
+	return;
+}
+
+
+std::shared_ptr<ThreadPoolClass> ThreadPoolClass::GetSharedPool()
+{
+	std::lock_guard<std::mutex> lock(sharedPoolMutex);
+	return sharedPool;
+}
+
+void ThreadPoolClass::SetSharedPool(const std::shared_ptr<ThreadPoolClass> & pool)
+{
+	std::lock_guard<std::mutex> lock(sharedPoolMutex);
+	sharedPool = pool;
+}
+
+
+
+// ----------------------------------------------------------------------------------- //
+//
+//                          PRIVATE METHODS / HELPERS
+//
+// ----------------------------------------------------------------------------------- //
+
+void ThreadPoolClass::WorkerThreadFunc()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+
+	while (true)
+	{
+		jobsCondition_.wait(lock, [this]() { return isStopping_ || !jobs_.empty(); });
+
+		if (isStopping_)
+			return;
+
+		this->ExecuteNextTask(lock, *jobs_.front());
+	}
+}
+
+
+// take the next task of the job and execute it (without the lock); returns false if all the tasks
+// are taken; a job is referred only under the lock and until its last task is done
+bool ThreadPoolClass::ExecuteNextTask(std::unique_lock<std::mutex> & lock, JOB & job)
+{
+	if (job.nextTask == job.tasksCount)
+		return false;
+
+	const size_t taskIdx = job.nextTask++;
+
+	// the last task is taken so nobody else has to look at the job
+	if (job.nextTask == job.tasksCount)
+	{
+		const std::deque<JOB*>::iterator it = std::find(jobs_.begin(), jobs_.end(), &job);
+
+		if (it != jobs_.end())
+			jobs_.erase(it);
+	}
+
+	lock.unlock();
+	(*job.pFunc)(taskIdx);
+	lock.lock();
+
+	if (++job.doneTasksCount == job.tasksCount)
+		doneCondition_.notify_all();
+
+	return true;
+}
@@ -0,0 +1,70 @@
+/////////////////////////////////////////////////////////////////////
+// Filename:     ThreadPoolClass.h
+// Description:  a pool of persistent worker threads which execute the
+//               chunks of ParallelFor() (and ParallelSort()) instead of
+//               the threads which are created for each call; when some
+//               pool is set as the shared one (the resident conversion
+//               service does it) all the processing stages use it;
+//               the calling thread executes chunks of its own call too
+//               so a call never waits for a free worker (and nested
+//               calls don't deadlock)
+//
+// Created:      19.10.26
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////////////////////////
+// INCLUDES
+//////////////////////////////////
+#include <thread>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <functional>
+#include <condition_variable>
+
+
+//////////////////////////////////
+// Class name: ThreadPoolClass
+//////////////////////////////////
+class ThreadPoolClass
+{
+public:
+	ThreadPoolClass(const size_t threadsCount);
+	~ThreadPoolClass(void);
+
+	ThreadPoolClass(const ThreadPoolClass&) = delete;
+	ThreadPoolClass & operator=(const ThreadPoolClass&) = delete;
+
+	// execute func(taskIdx) for each task of the range [0, tasksCount) and wait until all of them are done
+	void Run(const size_t tasksCount, const std::function<void(size_t)> & func);
+
+	// the pool which is used by ParallelFor() (nullptr -- each call creates its own threads)
+	static std::shared_ptr<ThreadPoolClass> GetSharedPool();
+	static void SetSharedPool(const std::shared_ptr<ThreadPoolClass> & pool);
+
+private:
+	// the tasks of a single Run() call
+	struct JOB
+	{
+		const std::function<void(size_t)>* pFunc = nullptr;
+		size_t tasksCount = 0;
+		size_t nextTask = 0;                             // the first task which isn't taken yet
+		size_t doneTasksCount = 0;
+	};
+
+	void WorkerThreadFunc();
+
+	// take the next task of the job and execute it; returns false if all the tasks are taken
+	bool ExecuteNextTask(std::unique_lock<std::mutex> & lock, JOB & job);
+
+private:
+	std::vector<std::thread> threads_;
+
+	std::mutex mutex_;                                   // guards the jobs and their counters
+	std::condition_variable jobsCondition_;              // a new job is added (or the pool is stopped)
+	std::condition_variable doneCondition_;              // some job is done
+	std::deque<JOB*> jobs_;                              // jobs which have tasks that aren't taken yet
+	bool isStopping_ = false;
+};
@@ -0,0 +1,260 @@
+#include "TraceRecorderClass.h"
+
+#include <fstream>
+#include <cstdio>
+
+
+std::atomic<bool> TraceRecorderClass::isRecording_{ false };
+std::atomic<int64_t> TraceRecorderClass::startTimeNs_{ 0 };
+std::mutex TraceRecorderClass::buffersMutex_;
+std::vector<std::unique_ptr<TraceRecorderClass::THREAD_BUFFER>> TraceRecorderClass::buffers_;
+
+
+// gives the buffer back to the recorder when its thread exits (the worker threads
+// are created for each parallel stage so their buffers are reused by the next ones)
+struct THREAD_BUFFER_HOLDER
+{
+	TraceRecorderClass::THREAD_BUFFER* pBuffer = nullptr;
+
+	~THREAD_BUFFER_HOLDER()
+	{
+		if (pBuffer)
+			TraceRecorderClass::ReleaseThreadBuffer(pBuffer);
+	}
+};
+
+static thread_local THREAD_BUFFER_HOLDER threadBufferHolder;
+
+
+
+// ----------------------------------------------------------------------------------- //
+//
+//                          PUBLIC METHODS
+//
+// ----------------------------------------------------------------------------------- //
+
+// start recording (the events of the previous recording are removed)
+bool TraceRecorderClass::Start()
+{
+#ifndef MODEL_CONVERTER_TRACE_ENABLED
+	Log::Error(LOG_MACRO, "the trace events are compiled out (define MODEL_CONVERTER_TRACE to enable them)");
+	return false;
+#else
+	std::lock_guard<std::mutex> lock(buffersMutex_);
+
+	for (std::unique_ptr<THREAD_BUFFER> & pBuffer : buffers_)
+	{
+		std::lock_guard<std::mutex> bufferLock(pBuffer->mutex);
+		pBuffer->events.clear();
+	}
+
+	startTimeNs_ = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	isRecording_ = true;
+
+	return true;
+#endif
+}
+
+
+// stop recording and write the recorded events into the Chrome trace JSON file
+bool TraceRecorderClass::Stop(const char* traceFilename)
+{
+	isRecording_ = false;
+
+	if (!WriteChromeTrace(traceFilename))
+	{
+		Log::Error(LOG_MACRO, (std::string("can't write the trace file: ") + traceFilename).c_str());
+		return false;
+	}
+
+	return true;
+}
+
+
+bool TraceRecorderClass::BeginEvent(const char* name)
+{
+	if (!IsRecording())
+		return false;
+
+	THREAD_BUFFER* pBuffer = GetThreadBuffer();
+
+	TRACE_EVENT event;
+	event.name = name;
+	event.beginNs = GetTimeNs();
+	pBuffer->openEvents.push_back(std::move(event));
+
+	return true;
+}
+
+
+void TraceRecorderClass::EndEvent()
+{
+	THREAD_BUFFER* pBuffer = GetThreadBuffer();
+
+	if (pBuffer->openEvents.empty())
+		return;
+
+	TRACE_EVENT & event = pBuffer->openEvents.back();
+	event.durationNs = GetTimeNs() - event.beginNs;
+
+	std::lock_guard<std::mutex> lock(pBuffer->mutex);
+	pBuffer->events.push_back(std::move(event));
+	pBuffer->openEvents.pop_back();
+}
+
+
+void TraceRecorderClass::AddArg(const char* key, const char* value)
+{
+	if (IsRecording())
+		AddRawArg(key, EscapeJsonString(value));
+}
+
+void TraceRecorderClass::AddArg(const char* key, const std::string & value)
+{
+	if (IsRecording())
+		AddRawArg(key, EscapeJsonString(value.c_str()));
+}
+
+
+
+// ----------------------------------------------------------------------------------- //
+//
+//                          PRIVATE METHODS / HELPERS
+//
+// ----------------------------------------------------------------------------------- //
+
+// returns the buffer of the current thread (a new thread takes a released buffer or creates a new one)
+TraceRecorderClass::THREAD_BUFFER* TraceRecorderClass::GetThreadBuffer()
+{
+	if (threadBufferHolder.pBuffer)
+		return threadBufferHolder.pBuffer;
+
+	std::lock_guard<std::mutex> lock(buffersMutex_);
+
+	for (std::unique_ptr<THREAD_BUFFER> & pBuffer : buffers_)
+	{
+		if (!pBuffer->isUsed)
+		{
+			pBuffer->isUsed = true;
+			threadBufferHolder.pBuffer = pBuffer.get();
+			return threadBufferHolder.pBuffer;
+		}
+	}
+
+	buffers_.push_back(std::make_unique<THREAD_BUFFER>());
+	buffers_.back()->threadId = (unsigned int)buffers_.size();
+	buffers_.back()->isUsed = true;
+	threadBufferHolder.pBuffer = buffers_.back().get();
+
+	return threadBufferHolder.pBuffer;
+}
+
+
+void TraceRecorderClass::ReleaseThreadBuffer(THREAD_BUFFER* pBuffer)
+{
+	std::lock_guard<std::mutex> lock(buffersMutex_);
+
+	pBuffer->openEvents.clear();
+	pBuffer->isUsed = false;
+}
+
+
+// add an argument to the innermost event of the current thread
+void TraceRecorderClass::AddRawArg(const char* key, const std::string & jsonValue)
+{
+	THREAD_BUFFER* pBuffer = GetThreadBuffer();
+
+	if (pBuffer->openEvents.empty())
+		return;
+
+	std::string & args = pBuffer->openEvents.back().args;
+
+	if (!args.empty())
+		args += ',';
+
+	args += EscapeJsonString(key);
+	args += ':';
+	args += jsonValue;
+}
+
+
+int64_t TraceRecorderClass::GetTimeNs()
+{
+	const int64_t nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	return nowNs - startTimeNs_.load(std::memory_order_relaxed);
+}
+
+
+// write the events as complete ("X") events of a single process; each thread buffer is a track
+bool TraceRecorderClass::WriteChromeTrace(const char* traceFilename)
+{
+	std::ofstream fout(traceFilename, std::ios::out);
+
+	if (fout.fail())
+		return false;
+
+	fout << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	fout << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"ModelConverter\"}}";
+
+	std::lock_guard<std::mutex> lock(buffersMutex_);
+	char buffer[128];
+
+	for (std::unique_ptr<THREAD_BUFFER> & pBuffer : buffers_)
+	{
+		std::lock_guard<std::mutex> bufferLock(pBuffer->mutex);
+
+		if (pBuffer->events.empty())
+			continue;
+
+		fout << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << pBuffer->threadId
+			 << ",\"args\":{\"name\":\"thread " << pBuffer->threadId << "\"}}";
+
+		for (const TRACE_EVENT & event : pBuffer->events)
+		{
+			// the timestamps are in microseconds
+			snprintf(buffer, sizeof(buffer), "\"ts\":%.3f,\"dur\":%.3f",
+				(double)event.beginNs / 1000.0,
+				(double)event.durationNs / 1000.0);
+
+			fout << ",\n{\"name\":" << EscapeJsonString(event.name)
+				 << ",\"cat\":\"converter\",\"ph\":\"X\",\"pid\":1,\"tid\":" << pBuffer->threadId
+				 << ',' << buffer
+				 << ",\"args\":{" << event.args << "}}";
+		}
+	}
+
+	fout << "\n]}\n";
+
+	return !fout.fail();
+}
+
+
+// returns the string in quotes with escaped special characters
+std::string TraceRecorderClass::EscapeJsonString(const char* str)
+{
+	std::string result{ "\"" };
+
+	for (const char* ptr = str; *ptr != '\0'; ptr++)
+	{
+		const unsigned char c = (unsigned char)*ptr;
+
+		if ((c == '"') || (c == '\\'))
+		{
+			result += '\\';
+			result += (char)c;
+		}
+		else if (c < 0x20)
+		{
+			char escaped[8];
+			snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+			result += escaped;
+		}
+		else
+		{
+			result += (char)c;
+		}
+	}
+
+	result += '"';
+	return result;
+}
@@ -0,0 +1,129 @@
+/////////////////////////////////////////////////////////////////////
+// Filename:     TraceRecorderClass.h
+// Description:  scoped trace events of the conversion stages which
+//               are exported as a Chrome trace JSON file (it can be
+//               opened offline in chrome://tracing or in Perfetto);
+//               each thread records its events into its own buffer
+//               so there is no contention between the threads;
+//
+//               the events are compiled in only in the debug build or
+//               when MODEL_CONVERTER_TRACE is defined, and they are
+//               recorded only between Start() and Stop()
+//
+// Created:      19.10.26
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////////////////////////
+// INCLUDES
+//////////////////////////////////
+#include "Log.h"       // for using the log system
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <type_traits>
+
+
+#if defined(_DEBUG) || defined(MODEL_CONVERTER_TRACE)
+	#define MODEL_CONVERTER_TRACE_ENABLED
+#endif
+
+#ifdef MODEL_CONVERTER_TRACE_ENABLED
+	#define TRACE_CONCAT_HELPER(a, b) a##b
+	#define TRACE_CONCAT(a, b) TRACE_CONCAT_HELPER(a, b)
+
+	// record an event from here to the end of the scope (the name must be a string literal)
+	#define TRACE_SCOPE(name) TraceScopeClass TRACE_CONCAT(traceScope_, __LINE__)(name)
+
+	// add an argument to the innermost event of the current thread
+	#define TRACE_ARG(key, value) TraceRecorderClass::AddArg(key, value)
+#else
+	#define TRACE_SCOPE(name) ((void)0)
+	#define TRACE_ARG(key, value) ((void)0)
+#endif
+
+
+//////////////////////////////////
+// Class name: TraceRecorderClass
+//////////////////////////////////
+class TraceRecorderClass
+{
+public:
+	// start recording (the events of the previous recording are removed)
+	static bool Start();
+
+	// stop recording and write the recorded events into the Chrome trace JSON file
+	static bool Stop(const char* traceFilename);
+
+	static bool IsRecording() { return isRecording_.load(std::memory_order_relaxed); }
+
+	// returns false if the event isn't recorded (so it mustn't be ended)
+	static bool BeginEvent(const char* name);
+	static void EndEvent();
+
+	static void AddArg(const char* key, const char* value);
+	static void AddArg(const char* key, const std::string & value);
+
+	template<typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+	static void AddArg(const char* key, const T value)
+	{
+		if (IsRecording())
+			AddRawArg(key, std::to_string(value));
+	}
+
+private:
+	struct TRACE_EVENT
+	{
+		const char* name = nullptr;
+		int64_t beginNs = 0;                 // since the start of the recording
+		int64_t durationNs = 0;
+		std::string args;                    // "key":value pairs of the JSON object
+	};
+
+	// the events of a thread; the buffer is given to another thread when its thread exits
+	struct THREAD_BUFFER
+	{
+		unsigned int threadId = 0;           // the thread's id in the trace
+		bool isUsed = false;                 // is guarded by the buffersMutex_
+		std::mutex mutex;                    // guards the events (is locked only by this thread and by the export)
+		std::vector<TRACE_EVENT> events;
+		std::vector<TRACE_EVENT> openEvents; // the events of the current scopes (are used only by the owner thread)
+	};
+
+	friend struct THREAD_BUFFER_HOLDER;
+
+	static THREAD_BUFFER* GetThreadBuffer();
+	static void ReleaseThreadBuffer(THREAD_BUFFER* pBuffer);
+	static void AddRawArg(const char* key, const std::string & jsonValue);
+	static int64_t GetTimeNs();
+
+	static bool WriteChromeTrace(const char* traceFilename);
+	static std::string EscapeJsonString(const char* str);
+
+private:
+	static std::atomic<bool> isRecording_;
+	static std::atomic<int64_t> startTimeNs_;
+	static std::mutex buffersMutex_;
+	static std::vector<std::unique_ptr<THREAD_BUFFER>> buffers_;
+};
+
+
+//////////////////////////////////
+// Class name: TraceScopeClass
+//////////////////////////////////
+class TraceScopeClass
+{
+public:
+	explicit TraceScopeClass(const char* name) : isRecorded_(TraceRecorderClass::BeginEvent(name)) {}
+	~TraceScopeClass() { if (isRecorded_) TraceRecorderClass::EndEvent(); }
+
+	TraceScopeClass(const TraceScopeClass &) = delete;
+	TraceScopeClass & operator=(const TraceScopeClass &) = delete;
+
+private:
+	const bool isRecorded_;
+};
@@ -0,0 +1,255 @@
+#include "VertexLayoutClass.h"
+#include "ParallelFor.h"
+#include "TraceRecorderClass.h"
+
+#include <cstring>
+
+
+// ----------------------------------------------------------------------------------- //
+//
+//                          PUBLIC METHODS
+//
+// ----------------------------------------------------------------------------------- //
+
+// build the vertex streams by the final (sorted) faces of the mesh
+bool VertexLayoutClass::Build(const MeshData & mesh, const ConversionOptions & options)
+{
+	TRACE_SCOPE("BuildVertexLayout");
+
+	const size_t alignment = options.vertexAttributeAlignment;
+
+	streams_.clear();
+
+	if ((alignment == 0) || ((alignment & (alignment - 1)) != 0))
+	{
+		Log::Error(LOG_MACRO, ("the vertex attribute alignment must be a power of 2: " + std::to_string(alignment)).c_str());
+		return false;
+	}
+
+	// the baked ambient occlusion goes together with the texture coords (or into its own stream in the soa layout)
+	const bool hasAmbientOcclusion = !mesh.ambientOcclusion.empty();
+	std::vector<VERTEX_ATTRIBUTE_TYPE> otherAttributes = { VERTEX_ATTRIBUTE_TEXCOORD };
+
+	if (hasAmbientOcclusion)
+		otherAttributes.push_back(VERTEX_ATTRIBUTE_AMBIENT_OCCLUSION);
+
+	bool result = true;
+
+	switch (options.vertexLayout)
+	{
+		case VERTEX_LAYOUT_INTERLEAVED:
+			otherAttributes.insert(otherAttributes.begin(), VERTEX_ATTRIBUTE_POSITION);
+			result = this->AddStream(otherAttributes, alignment, options.vertexStride);
+			break;
+
+		case VERTEX_LAYOUT_SOA:
+			result = this->AddStream({ VERTEX_ATTRIBUTE_POSITION }, alignment, 0) &&
+				this->AddStream({ VERTEX_ATTRIBUTE_TEXCOORD }, alignment, 0) &&
+				(!hasAmbientOcclusion || this->AddStream({ VERTEX_ATTRIBUTE_AMBIENT_OCCLUSION }, alignment, 0));
+			break;
+
+		// the positions stream is tightly packed (for the depth/shadow passes)
+		// and the stride option is applied to the stream of the other attributes
+		case VERTEX_LAYOUT_POSITION_STREAM:
+			result = this->AddStream({ VERTEX_ATTRIBUTE_POSITION }, alignment, 0) &&
+				this->AddStream(otherAttributes, alignment, options.vertexStride);
+			break;
+
+		default:
+			Log::Error(LOG_MACRO, ("unknown vertex layout: " + std::to_string(options.vertexLayout)).c_str());
+			return false;
+	}
+
+	if (!result)
+		return false;
+
+	this->UnifyVertices(mesh);
+
+	for (VERTEX_STREAM & stream : streams_)
+		this->FillStream(mesh, stream);
+
+	Log::Print("vertex layout: %s; unique vertices: %u; streams: %u",
+		GetLayoutName(options.vertexLayout),
+		(UINT)this->GetVerticesCount(),
+		(UINT)streams_.size());
+
+	return true;
+}
+
+
+const char* VertexLayoutClass::GetLayoutName(const VERTEX_LAYOUT layout)
+{
+	switch (layout)
+	{
+		case VERTEX_LAYOUT_INTERLEAVED:      return "interleaved";
+		case VERTEX_LAYOUT_SOA:              return "soa";
+		case VERTEX_LAYOUT_POSITION_STREAM:  return "position_stream";
+		default:                             return "none";
+	}
+}
+
+const char* VertexLayoutClass::GetAttributeName(const VERTEX_ATTRIBUTE_TYPE type)
+{
+	switch (type)
+	{
+		case VERTEX_ATTRIBUTE_POSITION:           return "position";
+		case VERTEX_ATTRIBUTE_TEXCOORD:           return "texcoord";
+		case VERTEX_ATTRIBUTE_AMBIENT_OCCLUSION:  return "ambient_occlusion";
+		default:                                  return "unknown";
+	}
+}
+
+const char* VertexLayoutClass::GetAttributeFormat(const VERTEX_ATTRIBUTE_TYPE type)
+{
+	switch (type)
+	{
+		case VERTEX_ATTRIBUTE_POSITION:           return "float3";
+		case VERTEX_ATTRIBUTE_TEXCOORD:           return "float2";
+		case VERTEX_ATTRIBUTE_AMBIENT_OCCLUSION:  return "float";
+		default:                                  return "unknown";
+	}
+}
+
+size_t VertexLayoutClass::GetAttributeSize(const VERTEX_ATTRIBUTE_TYPE type)
+{
+	switch (type)
+	{
+		case VERTEX_ATTRIBUTE_POSITION:           return sizeof(VERTEX3D);
+		case VERTEX_ATTRIBUTE_TEXCOORD:           return sizeof(TEXTURE_COORDS);
+		case VERTEX_ATTRIBUTE_AMBIENT_OCCLUSION:  return sizeof(float);
+		default:                                  return 0;
+	}
+}
+
+
+
+// ----------------------------------------------------------------------------------- //
+//
+//                          PRIVATE METHODS / HELPERS
+//
+// ----------------------------------------------------------------------------------- //
+
+// make unique vertices of the (position, texture coords) pairs; the vertices are
+// numbered in the order of their first usage so the vertex buffers are read in
+// the same order as the index buffer
+void VertexLayoutClass::UnifyVertices(const MeshData & mesh)
+{
+	const size_t cornersCount = mesh.vertexIndices.size();
+
+	// sort the corners by their (position, texture coords) pairs
+	std::vector<std::pair<uint64_t, UINT>> corners(cornersCount);
+
+	ParallelFor(cornersCount, MIN_ELEMENTS_PER_THREAD_, [&](size_t begin, size_t end, size_t)
+	{
+		for (size_t i = begin; i < end; i++)
+			corners[i] = { ((uint64_t)mesh.vertexIndices[i] << 32) | mesh.textureIndices[i], (UINT)i };
+	});
+
+	ParallelSort(corners, MIN_ELEMENTS_PER_THREAD_);
+
+	// for each corner: the first corner which has the same pair
+	std::vector<UINT> firstCorners(cornersCount);
+
+	for (size_t i = 0; i < cornersCount; i++)
+	{
+		const bool isNewPair = (i == 0) || (corners[i].first != corners[i - 1].first);
+		firstCorners[corners[i].second] = isNewPair ? corners[i].second : firstCorners[corners[i - 1].second];
+	}
+
+	// number the unique vertices by their first corners
+	indices_.resize(cornersCount);
+	verticesPositions_.clear();
+	verticesTexCoords_.clear();
+
+	for (size_t i = 0; i < cornersCount; i++)
+	{
+		if (firstCorners[i] == i)
+		{
+			indices_[i] = (UINT)verticesPositions_.size();
+			verticesPositions_.push_back(mesh.vertexIndices[i]);
+			verticesTexCoords_.push_back(mesh.textureIndices[i]);
+		}
+		else
+		{
+			indices_[i] = indices_[firstCorners[i]];
+		}
+	}
+
+	return;
+}
+
+
+// add a stream with such attributes; the attributes are placed at the aligned offsets
+// and the stride is aligned as well (or it is the requested one if it is big enough)
+bool VertexLayoutClass::AddStream(const std::vector<VERTEX_ATTRIBUTE_TYPE> & types, const size_t alignment, const size_t requestedStride)
+{
+	VERTEX_STREAM stream;
+	size_t offset = 0;
+
+	for (const VERTEX_ATTRIBUTE_TYPE type : types)
+	{
+		VERTEX_ATTRIBUTE attribute;
+		attribute.type = type;
+		attribute.offset = (offset + alignment - 1) & ~(alignment - 1);
+
+		offset = attribute.offset + GetAttributeSize(type);
+		stream.attributes.push_back(attribute);
+	}
+
+	stream.stride = (offset + alignment - 1) & ~(alignment - 1);
+
+	if (requestedStride != 0)
+	{
+		if (requestedStride < stream.stride)
+		{
+			Log::Error(LOG_MACRO, ("the vertex stride is too small: " + std::to_string(requestedStride) +
+				" (min: " + std::to_string(stream.stride) + ")").c_str());
+			return false;
+		}
+
+		stream.stride = requestedStride;
+	}
+
+	streams_.push_back(stream);
+
+	return true;
+}
+
+
+// copy the attributes of the unique vertices into the stream (the padding bytes
+// and the attributes which have invalid indices are zeros)
+void VertexLayoutClass::FillStream(const MeshData & mesh, VERTEX_STREAM & stream) const
+{
+	const size_t verticesCount = this->GetVerticesCount();
+
+	stream.data.assign(verticesCount * stream.stride, 0);
+
+	ParallelFor(verticesCount, MIN_ELEMENTS_PER_THREAD_, [&](size_t begin, size_t end, size_t)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			uint8_t* pVertex = stream.data.data() + i * stream.stride;
+
+			for (const VERTEX_ATTRIBUTE & attribute : stream.attributes)
+			{
+				if (attribute.type == VERTEX_ATTRIBUTE_POSITION)
+				{
+					if (verticesPositions_[i] < mesh.vertices.size())
+						memcpy(pVertex + attribute.offset, &mesh.vertices[verticesPositions_[i]], sizeof(VERTEX3D));
+				}
+				else if (attribute.type == VERTEX_ATTRIBUTE_AMBIENT_OCCLUSION)
+				{
+					// the ambient occlusion is baked per position
+					if (verticesPositions_[i] < mesh.ambientOcclusion.size())
+						memcpy(pVertex + attribute.offset, &mesh.ambientOcclusion[verticesPositions_[i]], sizeof(float));
+				}
+				else if (verticesTexCoords_[i] < mesh.texCoords.size())
+				{
+					memcpy(pVertex + attribute.offset, &mesh.texCoords[verticesTexCoords_[i]], sizeof(TEXTURE_COORDS));
+				}
+			}
+		}
+	});
+
+	return;
+}
@@ -0,0 +1,76 @@
+/////////////////////////////////////////////////////////////////////
+// Filename:     VertexLayoutClass.h
+// Description:  builds vertex buffers of the mesh with the layout
+//               which is chosen in the conversion options (interleaved,
+//               a stream per attribute or a separate positions stream);
+//               positions and texture coords have separate indices in
+//               the mesh data so here we make unique vertices of their
+//               pairs with a single index buffer
+//
+// Created:      19.10.26
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////////////////////////
+// INCLUDES
+//////////////////////////////////
+#include "MeshData.h"
+#include "ConversionOptions.h"
+#include "Log.h"       // for using the log system
+
+#include <cstdint>
+
+
+//////////////////////////////////
+// Class name: VertexLayoutClass
+//////////////////////////////////
+class VertexLayoutClass
+{
+public:
+	enum VERTEX_ATTRIBUTE_TYPE
+	{
+		VERTEX_ATTRIBUTE_POSITION,
+		VERTEX_ATTRIBUTE_TEXCOORD,
+		VERTEX_ATTRIBUTE_AMBIENT_OCCLUSION,  // is added only if it was baked
+	};
+
+	struct VERTEX_ATTRIBUTE
+	{
+		VERTEX_ATTRIBUTE_TYPE type = VERTEX_ATTRIBUTE_POSITION;
+		size_t offset = 0;                   // an offset (in bytes) inside of the vertex of the stream
+	};
+
+	struct VERTEX_STREAM
+	{
+		std::vector<VERTEX_ATTRIBUTE> attributes;
+		size_t stride = 0;
+		std::vector<uint8_t> data;           // verticesCount * stride bytes
+	};
+
+public:
+	// build the vertex streams by the final (sorted) faces of the mesh
+	bool Build(const MeshData & mesh, const ConversionOptions & options);
+
+	size_t GetVerticesCount() const { return verticesPositions_.size(); }
+	const std::vector<UINT> & GetIndices() const { return indices_; }           // an index per face corner (in the order of the mesh indices)
+	const std::vector<VERTEX_STREAM> & GetStreams() const { return streams_; }
+
+	static const char* GetLayoutName(const VERTEX_LAYOUT layout);
+	static const char* GetAttributeName(const VERTEX_ATTRIBUTE_TYPE type);
+	static const char* GetAttributeFormat(const VERTEX_ATTRIBUTE_TYPE type);
+	static size_t GetAttributeSize(const VERTEX_ATTRIBUTE_TYPE type);
+
+private:
+	void UnifyVertices(const MeshData & mesh);
+	bool AddStream(const std::vector<VERTEX_ATTRIBUTE_TYPE> & types, const size_t alignment, const size_t requestedStride);
+	void FillStream(const MeshData & mesh, VERTEX_STREAM & stream) const;
+
+private:
+	std::vector<UINT> indices_;
+	std::vector<UINT> verticesPositions_;    // a position index of each unique vertex
+	std::vector<UINT> verticesTexCoords_;    // a texture coords index of each unique vertex
+	std::vector<VERTEX_STREAM> streams_;
+
+	// constants
+	static const size_t MIN_ELEMENTS_PER_THREAD_ = 1 << 16;   // smaller meshes are handled on a single thread
+};